@@ -0,0 +1,64 @@
+# Generates a C++ source holding every file under ASSET_DIR as a byte array,
+# plus a lookup table keyed by path relative to ASSET_DIR.
+#
+# Run in script mode:
+#   cmake -DASSET_DIR=<dir> -DOUTPUT=<file.cpp> -P EmbedAssets.cmake
+
+file(GLOB_RECURSE ASSET_FILES RELATIVE "${ASSET_DIR}" "${ASSET_DIR}/*")
+list(SORT ASSET_FILES)
+
+# CMake regexes have no {n} repetition, so spell out sixteen bytes
+set(LINE_PATTERN "")
+foreach(I RANGE 15)
+    string(APPEND LINE_PATTERN "0x[0-9a-f][0-9a-f],")
+endforeach()
+
+set(ARRAYS "")
+set(ENTRIES "")
+set(INDEX 0)
+
+foreach(ASSET ${ASSET_FILES})
+    file(READ "${ASSET_DIR}/${ASSET}" HEX HEX)
+    file(SIZE "${ASSET_DIR}/${ASSET}" SIZE)
+    
+    # Sixteen bytes per line
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX}")
+    string(REGEX REPLACE "(${LINE_PATTERN})" "\\1\n    " BYTES "${BYTES}")
+    
+    string(APPEND ARRAYS "// ${ASSET}\nalignas(16) const unsigned char kAsset${INDEX}[] = {\n    ${BYTES}0x00\n};\n\n")
+    string(APPEND ENTRIES "    {\"${ASSET}\", kAsset${INDEX}, ${SIZE}},\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+file(WRITE "${OUTPUT}.tmp"
+"// Generated by cmake/EmbedAssets.cmake from ${ASSET_DIR}; do not edit.
+
+#include \"EmbeddedAssets.hpp\"
+
+namespace tempest {
+
+namespace {
+
+// Each array ends in a zero byte that is not counted in its size, so text
+// assets can be used as C strings
+
+${ARRAYS}const EmbeddedAsset kAssets[] = {
+${ENTRIES}    {nullptr, nullptr, 0}
+};
+
+} // namespace
+
+const EmbeddedAsset* getEmbeddedAssets() {
+    return kAssets;
+}
+
+std::size_t getEmbeddedAssetCount() {
+    return ${INDEX};
+}
+
+} // namespace tempest
+")
+
+# Only touch the output when it changed, to avoid needless rebuilds
+configure_file("${OUTPUT}.tmp" "${OUTPUT}" COPYONLY)
+file(REMOVE "${OUTPUT}.tmp")
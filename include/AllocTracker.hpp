@@ -0,0 +1,98 @@
+#ifndef TEMPEST_ALLOC_TRACKER_HPP
+#define TEMPEST_ALLOC_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tempest {
+
+// Parts of the game that allocations are charged to, set by AllocScope
+enum class AllocSubsystem : std::uint8_t {
+    OTHER,
+    SIMULATION,
+    PLAYER,
+    ENEMIES,
+    EVENTS,
+    PARTICLES,
+    RENDER,
+    UI,
+    AUDIO
+};
+
+// Heap allocation counters for instrumented builds.
+//
+// Configuring with -DTEMPEST_ALLOC_TRACKING=ON replaces the global operator
+// new and delete with versions that count every allocation, its size and
+// the call stack it came from, charged to the subsystem of the innermost
+// AllocScope on that thread. Counters are kept for the whole run and for the
+// current frame, which beginFrame() starts. The hooks themselves never
+// allocate: call sites go into a fixed table.
+//
+// In normal builds nothing is hooked, AllocScope is empty and every counter
+// reads zero.
+class AllocTracker {
+public:
+    static const int kSubsystemCount = 9;
+    static const int kSiteDepth = 6;     // Return addresses kept per call site
+    static const std::size_t kMaxSites = 4096;
+    
+    struct Counts {
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+        std::uint64_t frees;
+    };
+    
+    struct Site {
+        const void* stack[kSiteDepth]; // Innermost caller first
+        AllocSubsystem subsystem;      // Of the first allocation seen here
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+        std::uint64_t frameAllocations;
+    };
+    
+    static bool isEnabled(); // Built with the hooks
+    
+    // Starts a new frame's counters; call from the thread that owns frames
+    static void beginFrame();
+    
+    static Counts getTotal();
+    static Counts getTotal(AllocSubsystem subsystem);
+    static Counts getFrame();
+    static Counts getFrame(AllocSubsystem subsystem);
+    
+    // Copies up to maxSites call sites, busiest first; with frameOnly, only
+    // those that allocated in the current frame, by their frame counts
+    static std::size_t getSites(Site* sites, std::size_t maxSites, bool frameOnly);
+    static std::uint64_t getLostSites(); // Allocations from sites past the table
+    
+    static const char* getSubsystemName(AllocSubsystem subsystem);
+    
+    // Readable stack of a site: "function+0x12 <- caller+0x40 ..."; allocates
+    static std::string describe(const Site& site);
+    
+    // Whole-run and per-subsystem totals plus the top sites; allocates
+    static std::string getReport(std::size_t siteCount = 10);
+};
+
+// Charges allocations on this thread to a subsystem until it goes out of
+// scope; scopes nest
+class AllocScope {
+public:
+#ifdef TEMPEST_ALLOC_TRACKING
+    explicit AllocScope(AllocSubsystem subsystem);
+    ~AllocScope();
+    
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+    
+private:
+    AllocSubsystem m_previous;
+#else
+    explicit AllocScope(AllocSubsystem) {}
+#endif
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_ALLOC_TRACKER_HPP
@@ -0,0 +1,128 @@
+#ifndef TEMPEST_AUDIO_MIXER_HPP
+#define TEMPEST_AUDIO_MIXER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SoundBank.hpp"
+#include "SpscRing.hpp"
+
+namespace tempest {
+
+// Software mixer for the sound bank's PCM, producing interleaved 16-bit
+// stereo at SoundBank::kSampleRate.
+//
+// The game thread never touches the voices. play() and stop() only push a
+// command into a single-producer/single-consumer ring, which is wait-free,
+// and mix() applies the queued commands at the start of each block on
+// whichever thread pulls audio: the device's callback or, offline, the
+// caller itself. mix() works on a fixed voice pool and fixed buffers, so it
+// never allocates, locks or waits.
+//
+// When every voice is busy, a new sound takes the voice of the lowest
+// priority sound playing, preferring the one closest to its end, unless all
+// of them outrank it; then the new sound is dropped.
+class AudioMixer {
+public:
+    typedef std::uint32_t VoiceHandle;
+    static const VoiceHandle kNoVoice = 0;
+    
+    static const int kChannels = 2;
+    static const int kDefaultVoices = 16;
+    static const int kMaxVoices = 64;
+    
+    struct Stats {
+        std::uint64_t framesMixed;
+        std::uint64_t played;
+        std::uint64_t stolen;         // Voices taken over from a lower priority sound
+        std::uint64_t dropped;        // Sounds that found no voice they could take
+        std::uint64_t commandsLost;   // Commands lost to a full queue
+        int peakVoices;
+    };
+    
+    explicit AudioMixer(const SoundBank& bank, int voiceCount = kDefaultVoices);
+    
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+    
+    // Game thread. Volume scales the sound's own level; pan runs from -1
+    // (left) to 1 (right). The handle stays valid until the sound ends.
+    VoiceHandle play(SoundId id, float volume = 1.0f, float pan = 0.0f);
+    void stop(VoiceHandle handle);
+    void stopAll();
+    void setMasterVolume(float volume);
+    
+    // Audio thread: fills frameCount stereo frames
+    void mix(std::int16_t* output, std::size_t frameCount);
+    
+    // Offline: mixes frameCount frames onto the end of output
+    void render(std::size_t frameCount, std::vector<std::int16_t>& output);
+    
+    int getVoiceCount() const;
+    int getActiveVoices() const; // As of the last mix
+    Stats getStats() const;
+    
+private:
+    struct Command {
+        enum class Type : std::uint8_t {
+            PLAY,
+            STOP,
+            STOP_ALL,
+            MASTER_VOLUME
+        };
+    
+        Type type;
+        SoundId sound;
+        VoiceHandle handle;
+        float gainLeft;  // PLAY; MASTER_VOLUME uses gainLeft only
+        float gainRight;
+    };
+    
+    struct Voice {
+        const std::int16_t* samples; // Null when the voice is free
+        std::size_t length;
+        std::size_t position;
+        VoiceHandle handle;
+        int priority;
+        float gainLeft;
+        float gainRight;
+    };
+    
+    // Frames mixed per pass through the accumulator
+    static const std::size_t kBlockFrames = 256;
+    
+    void send(const Command& command);
+    void applyCommands();
+    void start(const Command& command);
+    
+    const SoundBank& m_bank;
+    SpscRing<Command, 256> m_commands;
+    
+    // Game thread only
+    VoiceHandle m_nextHandle;
+    
+    // Mixing thread only
+    Voice m_voices[kMaxVoices];
+    int m_voiceCount;
+    float m_masterVolume;
+    float m_accumulator[kBlockFrames * kChannels];
+    
+    // Written by the mixing thread (commandsLost by the game thread), read
+    // from anywhere
+    std::atomic<std::uint64_t> m_framesMixed;
+    std::atomic<std::uint64_t> m_played;
+    std::atomic<std::uint64_t> m_stolen;
+    std::atomic<std::uint64_t> m_dropped;
+    std::atomic<std::uint64_t> m_commandsLost;
+    std::atomic<int> m_activeVoices;
+    std::atomic<int> m_peakVoices;
+};
+
+// A complete RIFF/WAVE file of 16-bit PCM
+std::vector<std::uint8_t> encodeWav(const std::vector<std::int16_t>& samples, unsigned channels,
+                                    unsigned sampleRate);
+
+} // namespace tempest
+
+#endif // TEMPEST_AUDIO_MIXER_HPP
@@ -0,0 +1,34 @@
+#ifndef TEMPEST_AUDIO_OUTPUT_HPP
+#define TEMPEST_AUDIO_OUTPUT_HPP
+
+#include <SFML/Audio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "AudioMixer.hpp"
+
+namespace tempest {
+
+// Feeds an AudioMixer to the sound device. SFML pulls each chunk on its own
+// streaming thread, which is the mixer's only consumer; the chunk buffer is
+// sized once, so the callback allocates nothing. Short chunks keep the delay
+// between a command and its sound at a few milliseconds.
+class AudioOutput : public sf::SoundStream {
+public:
+    static const std::size_t kDefaultChunkFrames = 512;
+
+    explicit AudioOutput(AudioMixer& mixer, std::size_t chunkFrames = kDefaultChunkFrames);
+    ~AudioOutput();
+
+protected:
+    bool onGetData(Chunk& data) override;
+    void onSeek(sf::Time timeOffset) override;
+
+private:
+    AudioMixer& m_mixer;
+    std::vector<std::int16_t> m_buffer;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_AUDIO_OUTPUT_HPP
@@ -0,0 +1,20 @@
+#ifndef TEMPEST_AUTOPILOT_HPP
+#define TEMPEST_AUTOPILOT_HPP
+
+#include <cstdint>
+#include "Simulation.hpp"
+
+namespace tempest {
+
+// Scripted player for the headless tools. It fires constantly and sweeps
+// back and forth around the rim, but turns toward the nearest empty lane
+// when an enemy is about to reach its own, and goes after enemies parked on
+// the rim so that levels end. Outside play it confirms, so it
+// starts games, continues after levels and restarts after game over on its
+// own. The input depends only on the simulation and the tick, so a seed
+// gives the same session every run.
+PlayerInput getAutopilotInput(const Simulation& simulation, std::uint64_t tick);
+
+} // namespace tempest
+
+#endif // TEMPEST_AUTOPILOT_HPP
@@ -0,0 +1,25 @@
+#ifndef TEMPEST_EMBEDDED_ASSETS_HPP
+#define TEMPEST_EMBEDDED_ASSETS_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace tempest {
+
+// A file from assets/ compiled into the executable as read-only data
+struct EmbeddedAsset {
+    const char* name; // Path relative to assets/, e.g. "fonts/arcade.ttf"
+    const unsigned char* data;
+    std::size_t size;
+};
+
+// The table is generated at build time by cmake/EmbedAssets.cmake
+const EmbeddedAsset* getEmbeddedAssets();
+std::size_t getEmbeddedAssetCount();
+
+// nullptr if no asset of that name was embedded
+const EmbeddedAsset* findEmbeddedAsset(const std::string& name);
+
+} // namespace tempest
+
+#endif // TEMPEST_EMBEDDED_ASSETS_HPP
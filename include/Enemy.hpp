@@ -2,12 +2,18 @@
 #define TEMPEST_ENEMY_HPP
 
 #include <SFML/Graphics.hpp>
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include "LevelArena.hpp"
 #include "Playfield.hpp"
 
 namespace tempest {
 
+class SoftwareRasterizer;
+class StateReader;
+class StateWriter;
+
 class Enemy {
 public:
     enum class Type {
@@ -18,20 +24,46 @@ public:
         PULSAR
     };
     
-    Enemy(Type type, int lane, Playfield& playfield);
+    static const int kTypeCount = 5;
+    
+    // New enemies start at the far end of the tube
+    Enemy(Type type, int lane, Playfield& playfield, LevelArena* arena = nullptr,
+          float depth = 1.0f);
     
-    void update(float deltaTime);
-    void draw(sf::RenderWindow& window);
+    void draw(sf::RenderTarget& target);
+    void draw(SoftwareRasterizer& rasterizer) const;
+    
+    static const float kEdgeDepth; // At or above the rim from here
     
     bool isAtEdge() const;
     bool isDestroyed() const;
     const sf::Vector2f& getPosition() const;
-    float getRadius() const;
+    float getRadius() const; // Collision radius at the current depth
+    float getDepth() const;
+    float getSpeed() const;
+    float getRotation() const; // Degrees, wrapped to [0, 360)
     int getLane() const;
     Type getType() const;
     void destroy();
+    void setColor(const sf::Color& color);
+    
+    // This enemy's term in its pool's state hash (see StateHash.hpp): its
+    // type, lane, depth step and liveness. rehash() brings the term up to
+    // date and returns what to add to the pool's hash, 0 if none of those
+    // changed; getHashTerm() is the term as of the last rehash.
+    std::uint64_t rehash();
+    std::uint64_t getHashTerm() const;
+    
+    // Snapshot support (Simulation::saveState). The type is not included:
+    // the enemy is rebuilt with its type before loading into it.
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
     
 private:
+    // Per-type behavior lives in the trait table and the per-type systems
+    template <Type> friend struct EnemyTraits;
+    template <Type> friend class EnemySystem;
+    
     // Enemy properties
     Type m_type;
     int m_lane;
@@ -39,19 +71,28 @@ private:
     float m_speed;
     Playfield* m_playfield;
     sf::Vector2f m_position;
-    float m_radius;
+    float m_radius;   // At the rim
+    float m_scale;    // Perspective size at the current depth, 1 at the rim
     bool m_destroyed;
     
-    // Vector graphics shapes
-    std::vector<std::unique_ptr<sf::Shape>> m_shapes;
+    // Vector graphics shapes, pooled in the level arena when one is given
+    typedef std::vector<ArenaPtr<sf::Shape>, ArenaAllocator<ArenaPtr<sf::Shape>>> ShapeList;
+    LevelArena* m_arena;
+    ShapeList m_shapes;
     
     // Animation properties
     float m_rotationAngle;
-    float m_pulseTimer;
-    bool m_pulseState;
+    
+    // Behavior
+    std::uint64_t m_nextLaneChange; // Manager tick; 0 until first scheduled
+    
+    // State hash, not saved: rehashed on load
+    std::uint64_t m_hashKey;  // Hashed fields, packed
+    std::uint64_t m_hashTerm; // 0 until first rehashed
     
     // Helper methods
     void updatePosition();
+    void updateShapes(bool rotate);
     void createFlipperShape();
     void createTankerShape();
     void createSpikerShape();
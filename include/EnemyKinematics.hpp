@@ -0,0 +1,64 @@
+#ifndef TEMPEST_ENEMY_KINEMATICS_HPP
+#define TEMPEST_ENEMY_KINEMATICS_HPP
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FixedPoint.hpp"
+#include "LevelArena.hpp"
+#include "Playfield.hpp"
+
+namespace tempest {
+
+// Structure-of-arrays store for enemy depth and screen position.
+//
+// Every enemy moves the same way (depth -= speed * dt, clamp to [0, 1], then
+// lerp between the two nearest depth buckets of its lane in the playfield's
+// projection table), so the work is done in one vectorized pass instead of
+// one enemy at a time. The kernel processes 16, 8 or 4 enemies per step with
+// AVX-512, AVX2 or SSE2, picked at runtime, and falls back to scalar code
+// elsewhere. All paths use the same operations in
+// the same order, so they produce identical results.
+//
+// In fixed-point mode depth and speed are kept as Fixed and advanced with
+// integer arithmetic; the float depth and position follow from them.
+class EnemyKinematics {
+public:
+    EnemyKinematics();
+    explicit EnemyKinematics(LevelArena& arena, Arithmetic arithmetic = Arithmetic::FLOAT);
+
+    std::size_t add(int lane, float depth, float speed);
+    void removeSwap(std::size_t index); // Moves the last entry into index
+    void clear();
+    void reserve(std::size_t capacity);
+    std::size_t size() const;
+
+    void setLane(std::size_t index, int lane);
+    float getDepth(std::size_t index) const;
+    sf::Vector2f getPosition(std::size_t index) const;
+
+    // Advance every entry by deltaTime and recompute its position
+    void advance(float deltaTime, const Playfield::LaneTable& lanes);
+
+    // Name of the kernel selected for this CPU ("avx512", "avx2", "sse2" or "scalar")
+    static const char* getKernelName();
+
+private:
+    typedef std::vector<float, ArenaAllocator<float>> FloatArray;
+    typedef std::vector<std::int32_t, ArenaAllocator<std::int32_t>> LaneArray;
+    typedef std::vector<Fixed, ArenaAllocator<Fixed>> FixedArray;
+
+    Arithmetic m_arithmetic;
+    FloatArray m_depth;
+    FloatArray m_speed;
+    LaneArray m_lane;
+    FloatArray m_x;
+    FloatArray m_y;
+    FixedArray m_fixedDepth; // Authoritative in fixed-point mode
+    FixedArray m_fixedSpeed; // Depth per second
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_ENEMY_KINEMATICS_HPP
@@ -1,34 +1,148 @@
 #ifndef TEMPEST_ENEMY_MANAGER_HPP
 #define TEMPEST_ENEMY_MANAGER_HPP
 
+#include <cstdint>
 #include <vector>
 #include "Enemy.hpp"
+#include "EnemySystem.hpp"
+#include "FixedPoint.hpp"
+#include "LaneIndex.hpp"
+#include "LevelArena.hpp"
 #include "Playfield.hpp"
+#include "Random.hpp"
+#include "Shot.hpp"
 
 namespace tempest {
 
+class StateReader;
+class StateWriter;
+
 class EnemyManager {
 public:
+    // Enemies destroyed by one call, by type
+    struct KillTally {
+        int kills[Enemy::kTypeCount];
+        int total;
+    };
+    
     EnemyManager();
     EnemyManager(Playfield& playfield);
+    EnemyManager(Playfield& playfield, LevelArena& arena, std::uint64_t seed,
+                 Arithmetic arithmetic = Arithmetic::FLOAT);
     
-    void update(float deltaTime);
-    void draw(sf::RenderWindow& window);
+    // Flippers steer by the player's lane
+    void update(float deltaTime, int playerLane);
+    void draw(sf::RenderTarget& target);
+    void draw(SoftwareRasterizer& rasterizer) const;
     
-    void spawnEnemy(Enemy::Type type, int lane);
+    void spawnEnemy(Enemy::Type type, int lane, float depth = 1.0f);
+    // A random type in a random lane
+    void spawnRandomEnemy();
     void clearAllEnemies();
+    
+    // Flips the color of every enemy of a pulsing type, and of new ones
+    void pulse(Enemy::Type type);
+    
+    // Use these rather than Enemy::destroy so the live counts stay right
+    void destroyEnemy(Enemy& enemy);
+    
+    // Destroys an enemy hit by a shot; types that split leave their
+    // children to appear at the start of the next update
+    void shootEnemy(Enemy& enemy);
+    
+    // Kills every live enemy in constant time by advancing the generation;
+    // the pools are emptied on the next update or spawn
+    KillTally destroyAllEnemies();
+    
+    // Kills one live enemy picked at random; null when there are none
+    const Enemy* destroyRandomEnemy();
     bool areEnemiesCleared() const;
+    std::size_t getEnemyCount() const;
+    
+    // Spikes stand from the far end of a lane, height 0 to 1. A shot that
+    // reaches the tip wears it down and is used up; returns whether it did.
+    float getSpikeHeight(int lane) const;
+    bool erodeSpike(const Shot& shot);
     
-    const std::vector<Enemy>& getEnemies() const;
+    // Lanes lit by a pulsing enemy close enough to the rim, as of the last
+    // update; one bit per lane
+    std::uint64_t getElectrifiedLanes() const;
+    bool isLaneElectrified(int lane) const;
+    
+    // Visit every enemy, pool by pool, skipping pools killed off in bulk
+    template <typename Function>
+    void forEachEnemy(Function function) {
+        for (auto& pool : m_pools) {
+            if (pool.generation != m_generation) {
+                continue;
+            }
+            for (auto& enemy : pool.enemies) {
+                function(enemy);
+            }
+        }
+    }
+    
+    template <typename Function>
+    void forEachEnemy(Function function) const {
+        for (const auto& pool : m_pools) {
+            if (pool.generation != m_generation) {
+                continue;
+            }
+            for (const auto& enemy : pool.enemies) {
+                function(enemy);
+            }
+        }
+    }
+    
+    // Enemies by lane and depth, the depths as of the last update; getEnemy
+    // looks up the handles it gives
+    const LaneIndex& getLaneIndex() const;
+    Enemy& getEnemy(EnemyHandle handle);
+    const Enemy& getEnemy(EnemyHandle handle) const;
+    
+    // The enemies' and the manager's random generator's part of the
+    // simulation's state hash, kept up to date as enemies change
+    std::uint64_t getStateHash() const;
     
-    void setSpawnRate(float spawnRate);
     void setEnemySpeed(float speed);
     
+    // Snapshot support (Simulation::saveState). Loading needs a manager
+    // built on the right playfield; the lane index and lane effects are
+    // rebuilt from the enemies.
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
 private:
-    std::vector<Enemy> m_enemies;
+    struct PendingSpawn {
+        Enemy::Type type;
+        int lane;
+        float depth;
+    };
+    
+    typedef std::vector<PendingSpawn, ArenaAllocator<PendingSpawn>> SpawnList;
+    typedef std::vector<float, ArenaAllocator<float>> HeightArray;
+    typedef std::vector<sf::Vertex, ArenaAllocator<sf::Vertex>> VertexArray;
+    
+    // The enemy's type and its slot in that type's pool
+    EnemyHandle getHandle(const Enemy& enemy) const;
+    void removeDestroyedEnemies(EnemyPool& pool);
+    void retireStalePool(EnemyPool& pool);
+    void refreshLaneIndex();
+    void refreshLaneEffects();
+    
     Playfield* m_playfield;
-    float m_spawnTimer;
-    float m_spawnRate;
+    LevelArena* m_arena;
+    Arithmetic m_arithmetic;
+    EnemyPool m_pools[Enemy::kTypeCount]; // One homogeneous pool per type
+    std::uint32_t m_generation;           // Pools behind this are dead
+    LaneIndex m_laneIndex;
+    Random m_random;
+    std::uint64_t m_tick;                  // Updates so far; schedules behavior
+    bool m_pulseStates[Enemy::kTypeCount]; // Current color of pulsing types
+    SpawnList m_pendingSpawns;             // Children of enemies shot this tick
+    HeightArray m_spikeHeights;            // Per lane
+    std::uint64_t m_electrifiedLanes;
+    VertexArray m_laneEffects;             // Spikes and lit lanes, as lines
     float m_enemySpeed;
 };
 
@@ -0,0 +1,148 @@
+#ifndef TEMPEST_ENEMY_SYSTEM_HPP
+#define TEMPEST_ENEMY_SYSTEM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Enemy.hpp"
+#include "EnemyKinematics.hpp"
+#include "EnemyTraits.hpp"
+#include "FixedPoint.hpp"
+#include "LevelArena.hpp"
+#include "Playfield.hpp"
+#include "Random.hpp"
+
+namespace tempest {
+
+// Enemies of a single type, with their kinematics indexed in step.
+//
+// The pool's generation is compared with its manager's: once the manager
+// moves on, every enemy in the pool counts as dead without being touched,
+// and the storage is emptied lazily. So does the pool's part of the state
+// hash.
+struct EnemyPool {
+    typedef std::vector<Enemy, ArenaAllocator<Enemy>> EnemyList;
+
+    EnemyPool()
+        : generation(0)
+        , liveCount(0)
+        , hash(0)
+    {
+    }
+
+    EnemyPool(LevelArena& arena, Arithmetic arithmetic)
+        : enemies(ArenaAllocator<Enemy>(&arena))
+        , kinematics(arena, arithmetic)
+        , generation(0)
+        , liveCount(0)
+        , hash(0)
+    {
+    }
+
+    EnemyList enemies;
+    EnemyKinematics kinematics;
+    std::uint32_t generation;
+    std::size_t liveCount; // Enemies not yet destroyed
+    std::uint64_t hash;    // Sum of the enemies' hash terms
+};
+
+// Everything the per-type systems read or write outside their own pool
+struct EnemyContext {
+    const Playfield& playfield;
+    Random& random;
+    float deltaTime;
+    std::uint64_t tick;   // The manager's tick count, from 1
+    int playerLane;
+    float* spikeHeights;  // One per lane, grown by spike-laying types
+    Arithmetic arithmetic;
+};
+
+// Ticks until the next event of a Poisson process with the given mean rate.
+// One draw per event, so the cost does not depend on how often it is polled.
+inline std::uint64_t drawPoissonWait(Random& random, float ratePerSecond, float tickDuration) {
+    float seconds = -std::log(1.0f - random.nextFloat()) / ratePerSecond;
+    return std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(seconds / tickDuration)));
+}
+
+// The same draw in fixed point, with an integer logarithm in place of libm's
+inline std::uint64_t drawPoissonWaitFixed(Random& random, float ratePerSecond, float tickDuration) {
+    Fixed remaining = fixed::kOne - static_cast<Fixed>(random.next() >> 8); // 1 - u, in (0, 1]
+    std::int64_t ticks = -static_cast<std::int64_t>(fixed::log(remaining));
+    Fixed ratePerTick = fixed::mul(fixed::fromFloat(ratePerSecond), fixed::fromFloat(tickDuration));
+    return std::max<std::uint64_t>(1, static_cast<std::uint64_t>((ticks + ratePerTick - 1) / ratePerTick));
+}
+
+// Per-type update system. Each instantiation runs over a homogeneous pool with
+// the type's traits baked in, so there is no per-enemy switch on the type.
+template <Enemy::Type T>
+class EnemySystem {
+public:
+    typedef EnemyTraits<T> Traits;
+
+    static void update(EnemyPool& pool, const EnemyContext& context) {
+        // Advance depth and position of the whole pool in one batch
+        pool.kinematics.advance(context.deltaTime, context.playfield.getLaneTable());
+
+        const int numSegments = context.playfield.getNumSegments();
+
+        for (std::size_t i = 0; i < pool.enemies.size(); ++i) {
+            Enemy& enemy = pool.enemies[i];
+            enemy.m_depth = pool.kinematics.getDepth(i);
+            enemy.m_position = pool.kinematics.getPosition(i);
+            enemy.m_scale = context.playfield.getDepthScale(enemy.m_depth);
+
+            if (Traits::kRotationRate > 0.0f) {
+                enemy.m_rotationAngle += Traits::kRotationRate * context.deltaTime;
+                if (enemy.m_rotationAngle >= 360.0f) {
+                    enemy.m_rotationAngle -= 360.0f;
+                }
+            }
+
+            // Lane changes are scheduled ahead by tick; they take effect on
+            // the next batch
+            if (Traits::kLaneChangeRate > 0.0f) {
+                if (enemy.m_nextLaneChange != 0 && context.tick >= enemy.m_nextLaneChange) {
+                    int step = Traits::laneStep(context.random, enemy.m_lane, context.playerLane, numSegments);
+                    enemy.m_lane = (enemy.m_lane + step + numSegments) % numSegments;
+                    pool.kinematics.setLane(i, enemy.m_lane);
+                    enemy.m_nextLaneChange = 0;
+                }
+                if (enemy.m_nextLaneChange == 0) {
+                    enemy.m_nextLaneChange = context.tick +
+                        (context.arithmetic == Arithmetic::FIXED_POINT
+                             ? drawPoissonWaitFixed(context.random, Traits::kLaneChangeRate, context.deltaTime)
+                             : drawPoissonWait(context.random, Traits::kLaneChangeRate, context.deltaTime));
+                }
+            }
+
+            // The spike grows up the lane behind the enemy, to a limit. With a
+            // fixed-point depth every step here is exact.
+            if (Traits::kSpikeHeight > 0.0f && !enemy.m_destroyed) {
+                const float tallest = Traits::kSpikeHeight; // Not odr-used by std::min
+                float& height = context.spikeHeights[enemy.m_lane];
+                height = std::max(height, std::min(tallest, 1.0f - enemy.m_depth));
+            }
+
+            enemy.updateShapes(Traits::kRotationRate > 0.0f);
+            pool.hash += enemy.rehash();
+        }
+    }
+};
+
+// Runs EnemySystem<T> for every type over pools indexed by type
+template <std::size_t... Types>
+void updateEnemySystems(EnemyPool* pools, const EnemyContext& context, std::index_sequence<Types...>) {
+    using expand = int[];
+    (void)expand{0, (EnemySystem<static_cast<Enemy::Type>(Types)>::update(pools[Types], context), 0)...};
+}
+
+inline void updateEnemySystems(EnemyPool* pools, const EnemyContext& context) {
+    updateEnemySystems(pools, context, std::make_index_sequence<Enemy::kTypeCount>());
+}
+
+} // namespace tempest
+
+#endif // TEMPEST_ENEMY_SYSTEM_HPP
@@ -0,0 +1,156 @@
+#ifndef TEMPEST_ENEMY_TRAITS_HPP
+#define TEMPEST_ENEMY_TRAITS_HPP
+
+#include <SFML/Graphics.hpp>
+#include "Enemy.hpp"
+#include "Random.hpp"
+
+namespace tempest {
+
+// Compile-time description of each enemy type. Adding a type means adding an
+// Enemy::Type value and one specialization here; the runtime table, the
+// per-type pools in EnemyManager and scoring all pick it up from there.
+//
+// Every specialization defines every member, so the behavior code in
+// EnemySystem can test them with plain constant conditions that the compiler
+// folds away. Radii are in design pixels (see Layout.hpp), at the rim.
+//
+// Lane changes come at kLaneChangeRate per second on average, as a Poisson
+// process; laneStep() picks the direction given the lane, the player's lane
+// and the lane count. Depths and heights run from 0 at the rim to 1 at the
+// far end.
+template <Enemy::Type T>
+struct EnemyTraits;
+
+template <>
+struct EnemyTraits<Enemy::Type::FLIPPER> {
+    static constexpr float kSpeed = 0.15f;         // Depth per second
+    static constexpr float kRadius = 10.0f;
+    static constexpr float kRotationRate = 180.0f; // Degrees per second
+    static constexpr float kLaneChangeRate = 0.6f; // Mean changes per second
+    static constexpr float kPulsePeriod = 0.0f;    // Seconds, 0 for none
+    static constexpr float kElectrifyReach = 0.0f; // Depth within which a lit pulse kills
+    static constexpr float kSpikeHeight = 0.0f;    // Tallest spike left behind
+    static constexpr int kSplitCount = 0;          // Children when shot
+    static constexpr Enemy::Type kSplitType = Enemy::Type::FLIPPER;
+    static constexpr int kScore = 150;
+    static constexpr int kExplosionParticles = 24;
+    static constexpr float kExplosionSpeed = 180.0f; // Design pixels per second
+
+    // Flips the short way round toward the player
+    static int laneStep(Random&, int lane, int playerLane, int numLanes) {
+        int ahead = (playerLane - lane + numLanes) % numLanes;
+        if (ahead == 0) {
+            return 0;
+        }
+        return ahead <= numLanes / 2 ? 1 : -1;
+    }
+    static sf::Color pulseColor(bool) { return sf::Color::Red; }
+    static void createShape(Enemy& enemy) { enemy.createFlipperShape(); }
+};
+
+template <>
+struct EnemyTraits<Enemy::Type::TANKER> {
+    static constexpr float kSpeed = 0.1f;
+    static constexpr float kRadius = 12.0f;
+    static constexpr float kRotationRate = 0.0f;
+    static constexpr float kLaneChangeRate = 0.0f;
+    static constexpr float kPulsePeriod = 0.0f;
+    static constexpr float kElectrifyReach = 0.0f;
+    static constexpr float kSpikeHeight = 0.0f;
+    static constexpr int kSplitCount = 2;          // Into flippers either side
+    static constexpr Enemy::Type kSplitType = Enemy::Type::FLIPPER;
+    static constexpr int kScore = 200;
+    static constexpr int kExplosionParticles = 32;
+    static constexpr float kExplosionSpeed = 150.0f;
+
+    static int laneStep(Random&, int, int, int) { return 0; }
+    static sf::Color pulseColor(bool) { return sf::Color::Magenta; }
+    static void createShape(Enemy& enemy) { enemy.createTankerShape(); }
+};
+
+template <>
+struct EnemyTraits<Enemy::Type::SPIKER> {
+    static constexpr float kSpeed = 0.12f;
+    static constexpr float kRadius = 10.0f;
+    static constexpr float kRotationRate = 0.0f;
+    static constexpr float kLaneChangeRate = 0.0f;
+    static constexpr float kPulsePeriod = 0.0f;
+    static constexpr float kElectrifyReach = 0.0f;
+    static constexpr float kSpikeHeight = 0.75f;
+    static constexpr int kSplitCount = 0;
+    static constexpr Enemy::Type kSplitType = Enemy::Type::SPIKER;
+    static constexpr int kScore = 250;
+    static constexpr int kExplosionParticles = 24;
+    static constexpr float kExplosionSpeed = 160.0f;
+
+    static int laneStep(Random&, int, int, int) { return 0; }
+    static sf::Color pulseColor(bool) { return sf::Color::Cyan; }
+    static void createShape(Enemy& enemy) { enemy.createSpikerShape(); }
+};
+
+template <>
+struct EnemyTraits<Enemy::Type::FUSEBALL> {
+    static constexpr float kSpeed = 0.2f;
+    static constexpr float kRadius = 8.0f;
+    static constexpr float kRotationRate = 360.0f;
+    static constexpr float kLaneChangeRate = 3.0f;
+    static constexpr float kPulsePeriod = 0.0f;
+    static constexpr float kElectrifyReach = 0.0f;
+    static constexpr float kSpikeHeight = 0.0f;
+    static constexpr int kSplitCount = 0;
+    static constexpr Enemy::Type kSplitType = Enemy::Type::FUSEBALL;
+    static constexpr int kScore = 300;
+    static constexpr int kExplosionParticles = 40;
+    static constexpr float kExplosionSpeed = 220.0f;
+
+    // Bounces either way, or stays put
+    static int laneStep(Random& random, int, int, int) { return random.nextInt(3) - 1; }
+    static sf::Color pulseColor(bool) { return sf::Color(255, 165, 0); }
+    static void createShape(Enemy& enemy) { enemy.createFuseballShape(); }
+};
+
+template <>
+struct EnemyTraits<Enemy::Type::PULSAR> {
+    static constexpr float kSpeed = 0.08f;
+    static constexpr float kRadius = 10.0f;
+    static constexpr float kRotationRate = 0.0f;
+    static constexpr float kLaneChangeRate = 0.0f;
+    static constexpr float kPulsePeriod = 0.5f;
+    static constexpr float kElectrifyReach = 0.5f; // The front half of its lane
+    static constexpr float kSpikeHeight = 0.0f;
+    static constexpr int kSplitCount = 0;
+    static constexpr Enemy::Type kSplitType = Enemy::Type::PULSAR;
+    static constexpr int kScore = 350;
+    static constexpr int kExplosionParticles = 32;
+    static constexpr float kExplosionSpeed = 200.0f;
+
+    static int laneStep(Random&, int, int, int) { return 0; }
+    static sf::Color pulseColor(bool pulseState) {
+        return pulseState ? sf::Color::Yellow : sf::Color::Green;
+    }
+    static void createShape(Enemy& enemy) { enemy.createPulsarShape(); }
+};
+
+// Runtime view of the trait table, for code that only knows the type at
+// runtime (spawning, scoring, explosions, pulse timers)
+struct EnemyTypeInfo {
+    float speed;
+    float radius;
+    float rotationRate;
+    int score;
+    int explosionParticles;
+    float explosionSpeed;
+    float pulsePeriod;
+    float electrifyReach;
+    int splitCount;
+    Enemy::Type splitType;
+    void (*createShape)(Enemy&);
+    sf::Color (*pulseColor)(bool);
+};
+
+const EnemyTypeInfo& getEnemyTypeInfo(Enemy::Type type);
+
+} // namespace tempest
+
+#endif // TEMPEST_ENEMY_TRAITS_HPP
@@ -0,0 +1,32 @@
+#ifndef TEMPEST_EVENT_TELEMETRY_HPP
+#define TEMPEST_EVENT_TELEMETRY_HPP
+
+#include <cstdint>
+#include <string>
+#include "Enemy.hpp"
+#include "GameEvents.hpp"
+
+namespace tempest {
+
+// Session counters built purely from gameplay events
+class EventTelemetry : public GameEventListener {
+public:
+    EventTelemetry();
+    
+    void onEvents(const GameEventQueue& events) override;
+    
+    // One-line summary for the log
+    std::string getSummary() const;
+    
+private:
+    std::uint64_t m_kills[Enemy::kTypeCount];
+    std::uint64_t m_superzapperKills;
+    std::uint64_t m_shotsFired;
+    std::uint64_t m_playerHits;
+    std::uint64_t m_levelsCleared;
+    std::uint64_t m_superzappersFired;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_EVENT_TELEMETRY_HPP
@@ -0,0 +1,79 @@
+#ifndef TEMPEST_FIXED_POINT_HPP
+#define TEMPEST_FIXED_POINT_HPP
+
+#include <cstdint>
+
+namespace tempest {
+
+// How the simulation does its arithmetic. FLOAT is the original model.
+// FIXED_POINT advances depths, speeds and spikes as fixed-point integers and
+// resolves hits along the lanes rather than in screen space, so no float
+// rounding or math library result ever reaches the game state: the same
+// replay plays out bit for bit whatever the compiler, flags or platform.
+// Replays record which one they were played in.
+enum class Arithmetic {
+    FLOAT,
+    FIXED_POINT
+};
+
+// Signed 8.24 fixed point. Depths run from 0 to kOne, and any value up to
+// kOne converts to float and back exactly, so a fixed-point depth can sit in
+// the float fields the renderer and lane index read.
+typedef std::int32_t Fixed;
+
+namespace fixed {
+
+const int kFractionBits = 24;
+const Fixed kOne = 1 << kFractionBits;
+const Fixed kLn2 = 11629080; // ln 2
+
+// Nearest value, for constants. Done in double, where scaling a float is
+// exact, so the result is the same on any IEEE machine.
+inline Fixed fromFloat(float value) {
+    double scaled = static_cast<double>(value) * kOne;
+    return static_cast<Fixed>(scaled < 0.0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+inline float toFloat(Fixed value) {
+    return static_cast<float>(value) * (1.0f / kOne);
+}
+
+inline Fixed mul(Fixed a, Fixed b) {
+    return static_cast<Fixed>((static_cast<std::int64_t>(a) * b) >> kFractionBits);
+}
+
+// Base-2 logarithm of a positive value, one fraction bit per squaring
+inline Fixed log2(Fixed value) {
+    Fixed result = 0;
+    std::uint64_t x = static_cast<std::uint64_t>(value);
+    const std::uint64_t one = static_cast<std::uint64_t>(kOne);
+    while (x >= 2 * one) {
+        x >>= 1;
+        result += kOne;
+    }
+    while (x < one) {
+        x <<= 1;
+        result -= kOne;
+    }
+    
+    // x is in [1, 2): squaring it doubles the logarithm, and each time that
+    // reaches 2 the next bit is set
+    for (Fixed bit = kOne >> 1; bit > 0; bit >>= 1) {
+        x = (x * x) >> kFractionBits;
+        if (x >= 2 * one) {
+            x >>= 1;
+            result += bit;
+        }
+    }
+    return result;
+}
+
+inline Fixed log(Fixed value) {
+    return mul(log2(value), kLn2);
+}
+
+} // namespace fixed
+
+} // namespace tempest
+
+#endif // TEMPEST_FIXED_POINT_HPP
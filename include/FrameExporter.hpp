@@ -0,0 +1,98 @@
+#ifndef TEMPEST_FRAME_EXPORTER_HPP
+#define TEMPEST_FRAME_EXPORTER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SoftwareRasterizer.hpp"
+
+namespace tempest {
+
+// Encodes rendered frames to disk on worker threads.
+//
+// submit() copies the rasterizer's framebuffer into one of a fixed set of
+// frame buffers and queues it, so the caller can render the next frame while
+// earlier ones are encoded. When every buffer is in flight submit() blocks,
+// which bounds memory and applies back-pressure to the renderer. PNG frames
+// are written independently; Y4M frames are converted in parallel and
+// appended to the stream strictly in submission order.
+class FrameExporter {
+public:
+    enum class Format {
+        PNG_SEQUENCE, // <path>/frame_000000.png, ...
+        Y4M           // Single YUV4MPEG2 stream, 4:2:0, BT.601 video range
+    };
+    
+    struct Stats {
+        std::uint64_t framesWritten;
+        double submitWaitSeconds; // Renderer blocked on a full queue
+        double encodeSeconds;     // Summed over all workers
+    };
+    
+    FrameExporter(Format format, const std::string& path, unsigned width, unsigned height,
+                  unsigned fps, unsigned workerCount, unsigned queueDepth);
+    ~FrameExporter();
+    
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+    
+    // Opens the output and starts the workers
+    bool start();
+    
+    // Queues the rasterizer's current RGBA framebuffer as the next frame
+    bool submit(const SoftwareRasterizer& rasterizer);
+    
+    // Waits for every queued frame and stops the workers; false if any
+    // frame failed to write
+    bool finish();
+    
+    Stats getStats() const;
+    
+private:
+    struct Frame {
+        std::uint64_t index;
+        std::vector<std::uint8_t> pixels;  // RGBA
+        std::vector<std::uint8_t> encoded; // Y4M planes
+    };
+    
+    void workerLoop();
+    bool encode(Frame& frame);
+    bool writePng(const Frame& frame) const;
+    void convertToYuv(Frame& frame) const;
+    bool appendInOrder(const Frame& frame);
+    
+    Format m_format;
+    std::string m_path;
+    unsigned m_width;
+    unsigned m_height;
+    unsigned m_fps;
+    unsigned m_workerCount;
+    std::ofstream m_stream;
+    
+    std::vector<Frame> m_frames;
+    std::vector<Frame*> m_free;
+    std::deque<Frame*> m_pending;
+    std::vector<std::thread> m_workers;
+    
+    mutable std::mutex m_mutex;
+    std::condition_variable m_freeCondition;
+    std::condition_variable m_pendingCondition;
+    
+    // Y4M stream order, kept apart so disk writes don't stall the queue
+    std::mutex m_writeMutex;
+    std::condition_variable m_writeCondition;
+    std::uint64_t m_nextSubmit;
+    std::uint64_t m_nextWrite;
+    bool m_stopping;
+    bool m_failed;
+    Stats m_stats;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_FRAME_EXPORTER_HPP
@@ -0,0 +1,37 @@
+#ifndef TEMPEST_FRAME_PACER_HPP
+#define TEMPEST_FRAME_PACER_HPP
+
+#include <chrono>
+
+namespace tempest {
+
+// Holds frames to a fixed rate more tightly than sf::Window's framerate limit.
+//
+// The OS sleep is only trusted to get close: the pacer sleeps until a margin
+// before the deadline, then spins for the rest. The margin follows the
+// oversleep actually observed, so on a quiet system it settles well under a
+// millisecond and little CPU is spent spinning.
+class FramePacer {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    explicit FramePacer(double framesPerSecond);
+    
+    // Blocks until the next frame should start
+    void waitForNextFrame();
+    
+    // Forget the schedule, e.g. after a stall, so frames don't burst to catch up
+    void resync();
+    
+    Clock::duration getPeriod() const;
+    Clock::duration getSpinMargin() const;
+    
+private:
+    Clock::duration m_period;
+    Clock::time_point m_nextFrame;
+    Clock::duration m_spinMargin;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_FRAME_PACER_HPP
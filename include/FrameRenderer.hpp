@@ -0,0 +1,37 @@
+#ifndef TEMPEST_FRAME_RENDERER_HPP
+#define TEMPEST_FRAME_RENDERER_HPP
+
+#include <SFML/Graphics.hpp>
+#include "ParticleSystem.hpp"
+#include "Simulation.hpp"
+#include "SoftwareRasterizer.hpp"
+
+namespace tempest {
+
+// Headless counterpart of Game::render: draws a Simulation into a
+// SoftwareRasterizer using the same logical layout as the window. Set the
+// rasterizer's view to kGameArea; any output size then shows the whole frame.
+class FrameRenderer {
+public:
+    static const sf::FloatRect kGameArea;
+    
+    FrameRenderer();
+    
+    // Records and rasterizes one frame, with the particles if given
+    void render(Simulation& simulation, SoftwareRasterizer& rasterizer,
+                const ParticleSystem* particles = nullptr);
+    
+private:
+    void renderMenu(Simulation& simulation, SoftwareRasterizer& rasterizer);
+    void renderGame(Simulation& simulation, SoftwareRasterizer& rasterizer,
+                    const ParticleSystem* particles);
+    void renderGameOver(Simulation& simulation, SoftwareRasterizer& rasterizer);
+    void renderLevelComplete(Simulation& simulation, SoftwareRasterizer& rasterizer);
+    void drawTempestLogo(SoftwareRasterizer& rasterizer);
+    void drawCentered(SoftwareRasterizer& rasterizer, const char* text, float y,
+                      unsigned characterSize, const sf::Color& color);
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_FRAME_RENDERER_HPP
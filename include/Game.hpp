@@ -2,67 +2,137 @@
 #define TEMPEST_GAME_HPP
 
 #include <SFML/Graphics.hpp>
-#include "Playfield.hpp"
-#include "Player.hpp"
-#include "EnemyManager.hpp"
-#include "LevelManager.hpp"
+#include <memory>
+#include <string>
+#include "AudioMixer.hpp"
+#include "AudioOutput.hpp"
+#include "EventTelemetry.hpp"
+#include "FramePacer.hpp"
+#include "GameEvents.hpp"
+#include "InputSampler.hpp"
+#include "LatencyMonitor.hpp"
+#include "ParticleSystem.hpp"
+#include "RenderScaler.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include "SoundBank.hpp"
+#include "SoundEffects.hpp"
+#include "SpectatorFeed.hpp"
+#include "StartupProfile.hpp"
+#include "TimerWheel.hpp"
+#include "WindowWaiter.hpp"
 
 namespace tempest {
 
-enum class GameState {
-    MENU,
-    PLAYING,
-    GAME_OVER,
-    LEVEL_COMPLETE
+struct GameOptions {
+    GameOptions()
+        : width(800)
+        , height(600)
+        , fullscreen(false)
+        , verticalSync(false)
+        , dynamicResolution(false)
+        , sound(true)
+        , arithmetic(Arithmetic::FLOAT)
+    {
+    }
+    
+    unsigned width;          // Window size; ignored in fullscreen
+    unsigned height;
+    bool fullscreen;         // Desktop resolution
+    bool verticalSync;       // Let the display pace frames instead of FramePacer
+    bool dynamicResolution;  // Render the scene below native size when frames run long
+    bool sound;              // Open the audio device and play sound effects
+    Arithmetic arithmetic;   // Simulation arithmetic, recorded in the replay
+    InputOptions input;      // Devices sampled on the input thread
+    std::string spectatorFeed; // Shared-memory feed name to publish ticks to; empty for none
 };
 
-class Game {
+class Game : public GameEventListener {
 public:
-    Game();
+    explicit Game(const GameOptions& options = GameOptions());
     ~Game();
     
     void run();
     
+    // Marks the HUD for an update when score, lives or level change
+    void onEvents(const GameEventQueue& events) override;
+    
 private:
+    void waitWhileIdle();
     void processInput();
+    bool pollEvents(); // Handles the window's pending events; whether there were any
+    void handleEvent(const sf::Event& event);
     void update(float deltaTime);
     void render();
-    void checkCollisions();
+    
+    // View transform from the logical area to the window
+    void updateView();
+    void layoutText();
+    void placeText(sf::Text& text, unsigned designSize, float designX, float designY);
+    void placeCentered(sf::Text& text, unsigned designSize, float designY);
+    
+    // Scene target: the window itself, or a scaled texture upscaled onto it
+    void updateSceneTarget();
+    sf::RenderTarget& beginScene();
+    void endScene();
     
     // Menu and UI methods
+    void renderScene(sf::RenderTarget& target);
     void renderMenu();
     void renderGame();
     void renderGameOver();
     void renderLevelComplete();
     void updateScoreText();
-    void drawTempestLogo();
-    
-    // Game state management
-    void startGame();
-    void startNextLevel();
-    void playerHit();
+    void buildTempestLogo();
+    void drawTempestLogo(sf::RenderTarget& target);
     
     // High score management
     void loadHighScore();
     void saveHighScore();
     
+    // The game just played, to replay.dat
+    void saveReplay();
+    
+    // First member, so its clock covers all of construction
+    StartupProfile m_startup;
+    
     // Window and rendering
     sf::RenderWindow m_window;
+    WindowWaiter m_windowWaiter; // Static screens sleep on it
     sf::Clock m_clock;
+    bool m_verticalSync;
+    FramePacer m_pacer;
+    LatencyMonitor m_latency;
     sf::Font m_font;
+    sf::View m_view;
+    float m_pixelsPerUnit;     // Window pixels per logical unit
+    bool m_dynamicResolution;
+    RenderScaler m_renderScaler;
+    sf::RenderTexture m_sceneTexture;
+    bool m_sceneScaled;        // The scene goes through m_sceneTexture
+    
+    // Game state and objects
+    Simulation m_simulation;
+    InputSampler m_inputSampler;
+    PlayerInput m_input;       // Input for the next tick
+    float m_tickAccumulator;   // Real time not yet simulated
+    Replay m_replay;           // The current or last game, tick by tick
+    bool m_recording;          // A game is in progress
+    SpectatorFeed m_spectatorFeed; // Open only if asked for
+    EventTelemetry m_telemetry;
+    ParticleSystem m_particles;
     
-    // Game state
-    GameState m_state;
-    int m_score;
-    int m_highScore;
-    int m_level;
-    int m_lives;
+    // Sound: the output stream is declared last so its thread stops first
+    SoundBank m_soundBank;
+    AudioMixer m_mixer;
+    SoundEffects m_soundEffects;
+    std::unique_ptr<AudioOutput> m_audioOutput; // Null with sound off
     
-    // Game objects
-    Playfield m_playfield;
-    Player m_player;
-    EnemyManager m_enemyManager;
-    LevelManager m_levelManager;
+    bool m_hudDirty;
+    std::uint64_t m_allocatingFrames; // Gameplay frames that hit the heap
+    bool m_needsRedraw;        // Something on a static screen changed
+    TimerWheel m_uiTimers;     // Presentation timers, on simulation ticks
+    TimerWheel::TimerId m_blinkTimer;
     
     // UI elements
     sf::Text m_titleText;
@@ -73,6 +143,10 @@ private:
     sf::Text m_levelText;
     sf::Text m_livesText;
     sf::Text m_gameOverText;
+    sf::Text m_levelCompleteText;
+    sf::Text m_continueText;
+    sf::VertexArray m_logoHexagon;
+    sf::VertexArray m_logoSpokes;
 };
 
 } // namespace tempest
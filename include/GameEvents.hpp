@@ -0,0 +1,89 @@
+#ifndef TEMPEST_GAME_EVENTS_HPP
+#define TEMPEST_GAME_EVENTS_HPP
+
+#include <SFML/System.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include "Enemy.hpp"
+#include "LaneIndex.hpp"
+
+namespace tempest {
+
+// Gameplay events raised during a tick. They carry what happened, not what
+// to do about it; scoring, lives, HUD and telemetry each react to them.
+struct EnemyKilledEvent {
+    Enemy::Type type;
+    int lane;
+    sf::Vector2f position;
+    bool bySuperzapper;
+};
+
+struct PlayerHitEvent {
+    Enemy::Type by;
+    int lane;
+    sf::Vector2f position; // Of the player
+};
+
+struct ShotFiredEvent {
+    int lane;
+};
+
+struct LevelClearedEvent {
+    int level;
+};
+
+// Carries the whole zap's kills and score, so they are credited in one go.
+// Clearing the tube raises no EnemyKilledEvent per enemy; the lanes it
+// cleared are in the mask, each with its enemy nearest the rim, for effects.
+// An enemy picked off by a later zap is reported as an EnemyKilledEvent
+// (bySuperzapper set) instead, and not scored again.
+struct SuperzapperFiredEvent {
+    int chargesLeft;
+    int kills[Enemy::kTypeCount];
+    int totalKills;
+    int score;
+    std::uint64_t lanes;                          // Bit per lane cleared
+    sf::Vector2f nearest[LaneIndex::kMaxLanes];   // By lane, where its bit is set
+};
+
+// Per-tick event buffers, one typed array per event kind. Capacity is
+// reserved up front so raising an event in the middle of a tick is just a
+// store; the arrays are cleared, not freed, once the tick's events have been
+// handled.
+class GameEventQueue {
+public:
+    GameEventQueue();
+    
+    template <typename Event>
+    void push(const Event& event) {
+        std::get<std::vector<Event>>(m_buffers).push_back(event);
+    }
+    
+    template <typename Event>
+    const std::vector<Event>& get() const {
+        return std::get<std::vector<Event>>(m_buffers);
+    }
+    
+    bool empty() const;
+    void clear();
+    
+private:
+    std::tuple<std::vector<EnemyKilledEvent>,
+               std::vector<PlayerHitEvent>,
+               std::vector<ShotFiredEvent>,
+               std::vector<LevelClearedEvent>,
+               std::vector<SuperzapperFiredEvent>> m_buffers;
+};
+
+// Receives all of a tick's events in one call, after the tick has finished
+class GameEventListener {
+public:
+    virtual ~GameEventListener() {}
+    virtual void onEvents(const GameEventQueue& events) = 0;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_GAME_EVENTS_HPP
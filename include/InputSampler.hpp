@@ -0,0 +1,135 @@
+#ifndef TEMPEST_INPUT_SAMPLER_HPP
+#define TEMPEST_INPUT_SAMPLER_HPP
+
+#include <SFML/Window.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "Simulation.hpp"
+#include "SpscRing.hpp"
+
+namespace tempest {
+
+// Controls that can be held down; the window's own events still handle
+// Enter, Escape and closing
+enum class InputButton : std::uint8_t {
+    LEFT,
+    RIGHT,
+    FIRE,
+    SUPERZAPPER
+};
+
+struct InputEvent {
+    enum class Type : std::uint8_t {
+        BUTTON,
+        SPIN
+    };
+
+    enum class Source : std::uint8_t {
+        KEYBOARD,
+        JOYSTICK,
+        SPINNER
+    };
+
+    static const int kSourceCount = 3;
+
+    std::int64_t time;  // Clock nanoseconds
+    Type type;
+    Source source;
+    InputButton button; // BUTTON only
+    bool pressed;       // BUTTON only
+    std::int32_t spin;  // SPIN only: Player::kSpinUnitsPerLane per lane, positive to the right
+};
+
+struct InputOptions {
+    InputOptions()
+        : spinnerCountsPerLane(4)
+        , stickLanesPerSecond(12.0f)
+    {
+    }
+
+    std::string spinnerDevice; // evdev node of a rotary spinner (Linux), or empty
+    int spinnerCountsPerLane;  // Spinner counts that make one lane
+    float stickLanesPerSecond; // Turn rate at full joystick deflection
+};
+
+// Turns the keyboard, the first joystick and an optional evdev spinner into
+// timestamped events. The game thread collects them tick by tick up to each
+// tick's end time, so input lands in the tick it happened in however long
+// frames take, and a press shorter than a tick is still seen.
+//
+// SFML updates the keyboard and joysticks only on the thread that polls the
+// window, so the game thread feeds in the window's key events and reads the
+// joystick once a frame. The spinner has a thread of its own, asleep until
+// the device has counts, which go out through a lock-free ring stamped with
+// the kernel's time.
+//
+// Analog devices produce spin: sub-lane motion that Player accumulates, so
+// turning speed is a property of the device rather than of the frame rate.
+class InputSampler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit InputSampler(const InputOptions& options = InputOptions());
+    ~InputSampler();
+
+    InputSampler(const InputSampler&) = delete;
+    InputSampler& operator=(const InputSampler&) = delete;
+
+    // Opens the spinner if there is one and starts its thread
+    void start();
+    void stop();
+
+    // Game thread: every window event, then the joystick once per frame,
+    // after the window's events have updated it
+    void handleEvent(const sf::Event& event);
+    void sampleJoystick();
+
+    // Game thread: applies the events stamped up to the given time and fills
+    // the held controls and spin of one tick; confirm is left alone
+    void collect(Clock::time_point until, PlayerInput& input);
+
+    bool hasSpinner() const;
+    std::uint64_t getDroppedCount() const; // Events lost to a full ring
+
+private:
+    typedef InputEvent::Source Source;
+    typedef SpscRing<InputEvent, 1024> EventRing;
+
+    static const int kButtonCount = 4;
+
+    void run();
+    void readSpinner();
+    void setButtons(Source source, std::uint8_t held, std::int64_t now);
+    void emit(EventRing& ring, const InputEvent& event);
+    void apply(EventRing& ring, std::int64_t limit, std::int64_t& spin);
+
+    static std::int64_t toNanoseconds(Clock::time_point time);
+
+    InputOptions m_options;
+    EventRing m_spinnerEvents; // Spinner thread to game thread
+    EventRing m_windowEvents;  // Game thread to itself, in time order
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<std::uint64_t> m_dropped;
+
+    // Spinner thread only
+    int m_spinnerCarry;   // Spinner counts short of one unit
+    int m_spinnerFd;
+    int m_stopPipe[2];    // Written by stop() to wake the thread
+
+    // Game thread only
+    std::uint8_t m_keysHeld;
+    std::uint8_t m_reportedHeld[InputEvent::kSourceCount]; // One bit per button, as last queued
+    float m_stickCarry;   // Spin below one unit, kept for the next frame
+    Clock::time_point m_lastJoystickSample;
+    std::uint8_t m_held[InputEvent::kSourceCount];         // As collected
+    std::uint8_t m_pressedSinceCollect;
+    std::int64_t m_pendingSpin; // Beyond the per-tick limit, for later ticks
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_INPUT_SAMPLER_HPP
@@ -0,0 +1,134 @@
+#ifndef TEMPEST_LANE_INDEX_HPP
+#define TEMPEST_LANE_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Enemy.hpp"
+#include "LevelArena.hpp"
+
+namespace tempest {
+
+// An enemy by its type's pool and its slot in it. Unlike a pointer it
+// survives the pool regrowing; EnemyManager::getEnemy resolves it.
+struct EnemyHandle {
+    std::uint16_t type;
+    std::uint16_t slot;
+};
+
+// Answers "what is in lane L near depth D" without scanning every enemy.
+//
+// Entries are grouped by lane in one flat array and sorted by depth within
+// each lane, rim first; ties go by pool and slot, the order the enemies are
+// visited in. EnemyManager keeps the index up to date as it goes: an enemy
+// is added when it spawns, removed when it dies, and follows its pool slot
+// when the pool compacts. Every enemy moves every tick, so update() takes
+// each entry's depth again, moves the few that changed lane and re-sorts
+// lanes that are already nearly sorted, all in one pass. Removal patches the
+// live counts and the occupancy mask in O(1) and leaves the entry in place,
+// dead, until that pass; queries skip it.
+class LaneIndex {
+public:
+    static const int kMaxLanes = 64; // One bit each in the occupancy mask
+    
+    struct Entry {
+        float depth;
+        EnemyHandle enemy;
+    };
+    
+    explicit LaneIndex(int numLanes = 0, LevelArena* arena = nullptr);
+    
+    // A new live enemy; not while a forEachInRange is running
+    void add(EnemyHandle enemy, int lane, float depth);
+    
+    // An enemy was destroyed; one not in the index is ignored. Safe from
+    // within forEachInRange.
+    void remove(EnemyHandle enemy);
+    
+    // The enemy's pool moved it to another slot
+    void relocate(EnemyHandle enemy, std::uint16_t slot);
+    
+    bool contains(EnemyHandle enemy) const;
+    
+    // After the enemies move: locate(handle, depth) stores the enemy's depth
+    // and returns its lane
+    template <typename Function>
+    void update(Function locate) {
+        for (int lane = 0; lane < m_numLanes; ++lane) {
+            for (int i = m_laneStart[lane]; i < m_laneStart[lane + 1]; ++i) {
+                Entry& entry = m_entries[i];
+                if (entry.enemy.slot != kNoSlot) {
+                    int newLane = locate(entry.enemy, entry.depth);
+                    if (newLane != lane) {
+                        leaveLane(i, lane, newLane);
+                    }
+                }
+            }
+        }
+        settle();
+    }
+    
+    // Everything was destroyed
+    void clear();
+    
+    int getNumLanes() const;
+    
+    // Bit L is set while lane L holds a live enemy; O(1)
+    std::uint64_t getOccupancy() const;
+    bool isOccupied(int lane) const;
+    
+    // Closest live enemy to the rim at or beyond fromDepth, or null; O(log n).
+    // Good until the index next changes.
+    const Entry* findNearest(int lane, float fromDepth = 0.0f) const;
+    
+    // Live enemies of a lane with depth in [minDepth, maxDepth], rim first;
+    // O(log n) to find the first
+    template <typename Function>
+    void forEachInRange(int lane, float minDepth, float maxDepth, Function function) const {
+        if (lane < 0 || lane >= m_numLanes) {
+            return;
+        }
+        const Entry* end = m_entries.data() + m_laneStart[lane + 1];
+        for (const Entry* entry = lowerBound(lane, minDepth); entry != end && entry->depth <= maxDepth; ++entry) {
+            if (entry->enemy.slot != kNoSlot) {
+                function(entry->enemy);
+            }
+        }
+    }
+    
+    // Number of live enemies in a lane; O(1)
+    int getCount(int lane) const;
+    
+    // Empty lane closest to the given one (either way round the tube), or -1
+    // when every lane is taken; a few bit operations
+    int findNearestEmpty(int lane) const;
+    
+private:
+    typedef std::vector<Entry, ArenaAllocator<Entry>> EntryList;
+    typedef std::vector<int, ArenaAllocator<int>> IntList;
+    
+    static const std::uint16_t kNoSlot = 0xFFFF; // Marks a dead entry
+    
+    const Entry* lowerBound(int lane, float depth) const;
+    int* findSlotLane(EnemyHandle enemy);
+    int findEntry(EnemyHandle enemy, int lane) const;
+    void insert(const Entry& entry, int lane);
+    void leaveLane(int index, int lane, int newLane);
+    void settle();
+    
+    int m_numLanes;
+    std::uint64_t m_laneMask;  // Bits of lanes that exist
+    std::uint64_t m_occupancy;
+    
+    EntryList m_entries;       // Grouped by lane, depth-sorted within each
+    IntList m_laneStart;       // Lane L is [m_laneStart[L], m_laneStart[L + 1])
+    IntList m_liveCount;
+    IntList m_slotLanes[Enemy::kTypeCount]; // Lane of each indexed slot, or -1
+    EntryList m_moving;        // Changing lane during update()
+    IntList m_movingLanes;     // Where each is going
+    bool m_dirty;              // Dead entries to drop
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_LANE_INDEX_HPP
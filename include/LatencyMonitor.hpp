@@ -0,0 +1,70 @@
+#ifndef TEMPEST_LATENCY_MONITOR_HPP
+#define TEMPEST_LATENCY_MONITOR_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace tempest {
+
+// Measures input-to-present latency and frame pacing.
+//
+// Input events are stamped when the game receives them; when the frame that
+// first reflects them is presented, each contributes one latency sample.
+// Present-to-present intervals give the frame times, and their distance from
+// the target period gives the jitter. Samples go into fixed-size rings (the
+// most recent ones win), so monitoring allocates nothing while running.
+class LatencyMonitor {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    struct Percentiles {
+        std::size_t samples;
+        double p50, p95, p99, max; // Milliseconds
+    };
+    
+    LatencyMonitor(Clock::duration targetPeriod, std::size_t capacity = 4096);
+    
+    void inputReceived(Clock::time_point time);
+    void framePresented(Clock::time_point time);
+    
+    // A present after an idle wait: counts for input latency, but adds no
+    // frame time and starts a new frame-time baseline
+    void idleFramePresented(Clock::time_point time);
+    
+    Percentiles getInputLatency() const;
+    Percentiles getFrameTime() const;
+    Percentiles getJitter() const;
+    
+    // Multi-line summary for the log
+    std::string getReport() const;
+    
+private:
+    class SampleRing {
+    public:
+        explicit SampleRing(std::size_t capacity);
+        void add(double value);
+        Percentiles getPercentiles() const;
+        
+    private:
+        std::vector<double> m_values;
+        std::size_t m_next;
+        std::size_t m_count;
+    };
+    
+    void attributeInputs(Clock::time_point time); // One latency sample each
+    
+    double m_targetMilliseconds;
+    std::vector<Clock::time_point> m_pendingInputs; // Capped, never regrown
+    Clock::time_point m_lastPresent;
+    bool m_hasPresented;
+    
+    SampleRing m_inputLatency;
+    SampleRing m_frameTime;
+    SampleRing m_jitter;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_LATENCY_MONITOR_HPP
@@ -0,0 +1,38 @@
+#ifndef TEMPEST_LAYOUT_HPP
+#define TEMPEST_LAYOUT_HPP
+
+#include <SFML/Graphics.hpp>
+
+namespace tempest {
+
+// Resolution-independent coordinate space shared by the simulation, the HUD
+// and both renderers. The logical area is one unit high with the original
+// 4:3 aspect and is centered on the tube axis, so x spans [-2/3, 2/3] and y
+// spans [-1/2, 1/2]. Each renderer maps it onto its output with a view.
+//
+// Sizes and positions of the original 800x600 layout are still written in
+// design pixels and converted here, so the numbers read the way they were
+// authored.
+namespace layout {
+
+const float kAspect = 4.0f / 3.0f;
+const float kHeight = 1.0f;
+const float kWidth = kHeight * kAspect;
+
+// One pixel of the 800x600 design
+const float kPixel = kHeight / 600.0f;
+
+sf::FloatRect getArea();
+
+// Position of a point of the 800x600 design layout
+sf::Vector2f fromDesign(float x, float y);
+
+// Largest part of a width x height output that shows the logical area
+// undistorted, centered, as fractions of the output (an sf::View viewport)
+sf::FloatRect getLetterbox(unsigned width, unsigned height);
+
+} // namespace layout
+
+} // namespace tempest
+
+#endif // TEMPEST_LAYOUT_HPP
@@ -14,6 +14,7 @@ public:
     int getNumSegments() const;
     float getEnemySpawnRate() const;
     float getEnemySpeed() const;
+    int getEnemyQuota() const; // Enemies spawned before the level can be cleared
     
 private:
     int m_levelNumber;
@@ -21,6 +22,7 @@ private:
     int m_numSegments;
     float m_enemySpawnRate;
     float m_enemySpeed;
+    int m_enemyQuota;
 };
 
 } // namespace tempest
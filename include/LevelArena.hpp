@@ -0,0 +1,224 @@
+#ifndef TEMPEST_LEVEL_ARENA_HPP
+#define TEMPEST_LEVEL_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace tempest {
+
+// Level-scoped memory arena.
+//
+// Everything that lives for the duration of a single level (enemies, their
+// shapes, shots and playfield geometry) is carved out of a few large chunks
+// with a bump pointer. Blocks that die mid-level are returned to
+// power-of-two size-class pools and handed out again, so a long level does
+// not keep growing, even as containers regrow into ever larger blocks. When the level ends, reset() rewinds the arena in O(1) and keeps
+// the chunks for the next level, so steady-state play never goes back to the
+// global heap.
+class LevelArena {
+public:
+    struct Stats {
+        std::size_t bytesUsed;        // Bytes bumped since the last reset
+        std::size_t peakBytesUsed;    // Highest bytesUsed seen over any level
+        std::size_t bytesReserved;    // Total capacity of all chunks
+        std::size_t liveBlocks;       // Pool blocks currently handed out
+        std::size_t peakLiveBlocks;   // Highest liveBlocks seen over any level
+        std::size_t blocksRecycled;   // Pool allocations served from a free list
+        std::size_t unpooledBytes;    // Blocks too big to pool, held until the reset
+        std::size_t chunkCount;
+        std::size_t resetCount;
+    };
+
+    static const std::size_t kDefaultChunkSize = 64 * 1024;
+    static const std::size_t kBlockAlignment = 16;
+
+    explicit LevelArena(std::size_t chunkSize = kDefaultChunkSize);
+
+    LevelArena(const LevelArena&) = delete;
+    LevelArena& operator=(const LevelArena&) = delete;
+
+    // Raw bump allocation; the memory is only reclaimed by reset().
+    void* allocate(std::size_t size, std::size_t alignment = kBlockAlignment);
+
+    // Pooled allocation for blocks that may be released before the level ends.
+    void* acquireBlock(std::size_t size);
+    void releaseBlock(void* block, std::size_t size);
+
+    // Forget every allocation made since the previous reset. All objects
+    // living in the arena must have been destroyed by the caller first.
+    void reset();
+
+    const Stats& getStats() const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t size;
+    };
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static const std::size_t kMinBlockSize = 16;
+    static const std::size_t kSizeClassCount = 21; // 16 bytes .. 16 MiB
+
+    static std::size_t sizeClassFor(std::size_t size);
+
+    void addChunk(std::size_t minSize);
+
+    std::vector<Chunk> m_chunks;
+    std::size_t m_chunkSize;
+    std::size_t m_currentChunk;
+    std::size_t m_offset;
+    FreeBlock* m_freeLists[kSizeClassCount];
+    Stats m_stats;
+};
+
+// Deleter for objects created with makeInArena(). It remembers the size of the
+// most-derived type, so an ArenaPtr<Derived> can be converted to an
+// ArenaPtr<Base> and still hand the right block back to the arena.
+class ArenaDeleter {
+public:
+    ArenaDeleter()
+        : m_arena(nullptr)
+        , m_blockSize(0)
+    {
+    }
+
+    ArenaDeleter(LevelArena* arena, std::size_t blockSize)
+        : m_arena(arena)
+        , m_blockSize(blockSize)
+    {
+    }
+
+    template <typename T>
+    void operator()(T* object) const {
+        if (!object) {
+            return;
+        }
+
+        void* block = mostDerived(object, std::is_polymorphic<T>());
+        object->~T();
+
+        if (m_arena) {
+            m_arena->releaseBlock(block, m_blockSize);
+        } else {
+            ::operator delete(block);
+        }
+    }
+
+private:
+    template <typename T>
+    static void* mostDerived(T* object, std::true_type) {
+        return dynamic_cast<void*>(object);
+    }
+
+    template <typename T>
+    static void* mostDerived(T* object, std::false_type) {
+        return static_cast<void*>(object);
+    }
+
+    LevelArena* m_arena;
+    std::size_t m_blockSize;
+};
+
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+// Construct a T in the arena's pools, or on the global heap when no arena is
+// given (default-constructed game objects have none).
+template <typename T, typename... Args>
+ArenaPtr<T> makeInArena(LevelArena* arena, Args&&... args) {
+    static_assert(alignof(T) <= LevelArena::kBlockAlignment,
+                  "type is over-aligned for the level arena");
+
+    void* block = arena ? arena->acquireBlock(sizeof(T)) : ::operator new(sizeof(T));
+    try {
+        T* object = new (block) T(std::forward<Args>(args)...);
+        return ArenaPtr<T>(object, ArenaDeleter(arena, sizeof(T)));
+    } catch (...) {
+        if (arena) {
+            arena->releaseBlock(block, sizeof(T));
+        } else {
+            ::operator delete(block);
+        }
+        throw;
+    }
+}
+
+// Standard allocator adaptor so per-level containers draw from the arena.
+// Without an arena it falls back to the global heap.
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind {
+        typedef ArenaAllocator<U> other;
+    };
+
+    ArenaAllocator()
+        : m_arena(nullptr)
+    {
+    }
+
+    explicit ArenaAllocator(LevelArena* arena)
+        : m_arena(arena)
+    {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : m_arena(other.getArena())
+    {
+    }
+
+    T* allocate(std::size_t count) {
+        static_assert(alignof(T) <= LevelArena::kBlockAlignment,
+                      "type is over-aligned for the level arena");
+
+        std::size_t bytes = count * sizeof(T);
+        if (m_arena) {
+            return static_cast<T*>(m_arena->acquireBlock(bytes));
+        }
+        return static_cast<T*>(::operator new(bytes));
+    }
+
+    void deallocate(T* pointer, std::size_t count) {
+        if (m_arena) {
+            m_arena->releaseBlock(pointer, count * sizeof(T));
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+    LevelArena* getArena() const {
+        return m_arena;
+    }
+
+private:
+    LevelArena* m_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+    return lhs.getArena() == rhs.getArena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+    return !(lhs == rhs);
+}
+
+} // namespace tempest
+
+#endif // TEMPEST_LEVEL_ARENA_HPP
@@ -7,6 +7,9 @@
 
 namespace tempest {
 
+class StateReader;
+class StateWriter;
+
 class LevelManager {
 public:
     LevelManager();
@@ -18,8 +21,13 @@ public:
     int getCurrentLevelNumber() const;
     float getEnemySpawnRate() const;
     float getEnemySpeed() const;
+    int getEnemyQuota() const;
     int getNumSegments() const;
     
+    // Snapshot support (Simulation::saveState)
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
 private:
     void initializeLevels();
     
@@ -0,0 +1,39 @@
+#ifndef TEMPEST_MAPPED_FILE_HPP
+#define TEMPEST_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tempest {
+
+// A whole file mapped read-only into memory. Reads go straight to the page
+// cache, so only the pages actually touched are ever loaded.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // Fails on a missing or empty file; any previous mapping is closed first
+    bool open(const std::string& path);
+    void close();
+    
+    bool isOpen() const;
+    const std::uint8_t* getData() const;
+    std::size_t getSize() const;
+    
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_file;    // HANDLE, kept out of the header with windows.h
+    void* m_mapping;
+#endif
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_MAPPED_FILE_HPP
@@ -0,0 +1,83 @@
+#ifndef TEMPEST_PARTICLE_SYSTEM_HPP
+#define TEMPEST_PARTICLE_SYSTEM_HPP
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Enemy.hpp"
+#include "GameEvents.hpp"
+#include "Random.hpp"
+
+namespace tempest {
+
+class SoftwareRasterizer;
+
+// Vector-style explosions, emitted from destruction events.
+//
+// Particles live in a fixed-capacity structure-of-arrays pool: one array per
+// field, all sized once in the constructor. The update is a branch-free pass
+// over plain float arrays that the compiler can vectorize, followed by a
+// swap-with-last sweep that retires expired particles. Each live particle is
+// drawn as a short fading streak, and all of them go out in a single
+// sf::Lines draw from a vertex buffer that is also preallocated. When the
+// pool is full, new particles are dropped rather than allocated.
+//
+// Particles are cosmetic: they have their own generator and never feed back
+// into the simulation.
+class ParticleSystem : public GameEventListener {
+public:
+    static const std::size_t kDefaultCapacity = 8192;
+    
+    explicit ParticleSystem(std::uint64_t seed = 1, std::size_t capacity = kDefaultCapacity);
+    
+    // Explodes killed enemies, the lanes a superzapper cleared and the player
+    // when hit
+    void onEvents(const GameEventQueue& events) override;
+    
+    // Burst of count particles flying out in random directions; speed is in
+    // logical units per second
+    void emit(const sf::Vector2f& position, const sf::Color& color, int count,
+              float speed, float lifetime);
+    void emitExplosion(Enemy::Type type, const sf::Vector2f& position);
+    void emitPlayerDeath(const sf::Vector2f& position);
+    void emitSuperzap(const sf::Vector2f& position);
+    
+    void update(float deltaTime);
+    void clear();
+    
+    // One draw call for every live particle
+    void draw(sf::RenderTarget& target) const;
+    void draw(SoftwareRasterizer& rasterizer) const;
+    
+    std::size_t getCount() const;
+    std::size_t getCapacity() const;
+    std::size_t getDropped() const; // Particles lost to a full pool
+    
+private:
+    void retireExpired();
+    void buildVertices();
+    
+    std::size_t m_capacity;
+    std::size_t m_count;
+    std::size_t m_dropped;
+    
+    // Structure of arrays, indexed by particle
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_velocityX;
+    std::vector<float> m_velocityY;
+    std::vector<float> m_age;
+    std::vector<float> m_lifetime;
+    std::vector<sf::Color> m_color;
+    
+    // Two vertices per particle, rebuilt by update()
+    std::vector<sf::Vertex> m_vertices;
+    std::size_t m_vertexCount;
+    
+    Random m_random;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_PARTICLE_SYSTEM_HPP
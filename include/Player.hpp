@@ -3,37 +3,70 @@
 
 #include <SFML/Graphics.hpp>
 #include <vector>
+#include "LevelArena.hpp"
 #include "Playfield.hpp"
 #include "Shot.hpp"
 
 namespace tempest {
 
+class SoftwareRasterizer;
+class StateReader;
+class StateWriter;
+
 class Player {
 public:
+    typedef std::vector<Shot, ArenaAllocator<Shot>> ShotList;
+    
+    // Superzapper uses per level: the first clears the tube, the second
+    // takes out one enemy
+    static const int kSuperzapperCharges = 2;
+    static const float kShotCooldown; // Seconds between shots
+    static const int kSpinUnitsPerLane = 256; // Resolution of analog motion
+    
     Player();
     Player(Playfield& playfield);
+    // Shots follow the simulation's arithmetic (see Shot)
+    Player(Playfield& playfield, LevelArena& arena, Arithmetic arithmetic = Arithmetic::FLOAT);
     
     void moveLeft();
     void moveRight();
-    void shoot();
-    void useSuperzapper();
+    // Accumulates sub-lane motion and moves a lane each time it passes
+    // halfway to the next
+    void spin(int units);
+    // Both return whether anything happened (cooldown, charges left)
+    bool shoot();
+    bool useSuperzapper();
+    // Ends the cooldown; the simulation calls it kShotCooldown after a shot
+    void reload();
     
     void update(float deltaTime);
-    void draw(sf::RenderWindow& window);
+    void draw(sf::RenderTarget& target);
+    void draw(SoftwareRasterizer& rasterizer) const;
     
     int getPosition() const;
     int getLives() const;
     int getScore() const;
-    const std::vector<Shot>& getShots() const;
+    int getSuperzapperCharges() const;
+    bool isShotReady() const;
+    const ShotList& getShots() const;
+    
+    // Snapshot support (Simulation::saveState); the playfield is rebuilt
+    // by the simulation first
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
     
 private:
+    void updateShape();
+    
     Playfield* m_playfield;
+    Arithmetic m_arithmetic;
     int m_position;
+    int m_spinOffset; // From the lane's center, in spin units
     int m_lives;
     int m_score;
     int m_superzapperCharges;
-    float m_shootCooldown;
-    std::vector<Shot> m_shots;
+    bool m_shotReady;
+    ShotList m_shots;
     sf::ConvexShape m_shape;
 };
 
@@ -3,9 +3,13 @@
 
 #include <SFML/Graphics.hpp>
 #include <vector>
+#include "FixedPoint.hpp"
+#include "LevelArena.hpp"
 
 namespace tempest {
 
+class SoftwareRasterizer;
+
 class Playfield {
 public:
     enum class Type {
@@ -18,23 +22,79 @@ public:
         TRIANGLE
     };
     
+    // The tube in 3D: the rim is at z = 0, the far end at z = tubeLength, and
+    // the camera sits cameraDistance in front of the rim looking down the
+    // tube. The defaults put the rim and far end exactly where the old flat
+    // playfield drew them.
+    struct Projection {
+        float tubeRadius;
+        float tubeLength;
+        float cameraDistance;
+        float fieldOfView;    // Vertical, in degrees
+        float viewportHeight; // Logical units covered by the field of view
+    };
+    
+    // Projected positions of each lane sampled at kDepthBuckets + 1 evenly
+    // spaced depths, so that a point at any depth costs a lookup and a lerp
+    // instead of a projection. Lane i, bucket b is at index i * kStride + b in
+    // x and y; one padding entry at the end lets b = kDepthBuckets read its
+    // right-hand neighbour safely. scale[b] is the size of an object at that
+    // depth relative to the rim.
+    struct LaneTable {
+        typedef std::vector<float, ArenaAllocator<float>> FloatArray;
+        
+        static const int kDepthBuckets = 64;
+        static const int kStride = kDepthBuckets + 1;
+        
+        explicit LaneTable(LevelArena* arena = nullptr)
+            : x(ArenaAllocator<float>(arena))
+            , y(ArenaAllocator<float>(arena))
+            , scale(ArenaAllocator<float>(arena))
+        {
+        }
+        
+        FloatArray x;
+        FloatArray y;
+        FloatArray scale;
+    };
+    
+    static Projection getDefaultProjection();
+    
     Playfield();
     Playfield(Type type, int numSegments);
+    Playfield(Type type, int numSegments, LevelArena& arena,
+              const Projection& projection = getDefaultProjection());
+    
+    void draw(sf::RenderTarget& target);
+    void draw(SoftwareRasterizer& rasterizer) const;
     
-    void draw(sf::RenderWindow& window);
+    // Exact perspective projection of a point on a lane
     sf::Vector2f getPointPosition(int segment, float depth) const;
     sf::Vector2f getLaneDirection(int segment) const;
+    
+    // A point on a lane from the lane table, for a fixed-point depth
+    sf::Vector2f getTablePosition(int segment, Fixed depth) const;
+    
+    // Size at a depth relative to the rim, from the lane table
+    float getDepthScale(float depth) const;
+    
+    Type getType() const;
     int getNumSegments() const;
+    const Projection& getProjection() const;
+    const LaneTable& getLaneTable() const;
     
 private:
     void generateShape();
+    sf::Vector2f getRimOffset(int segment) const;
+    float getProjectedRadius(float depth) const;
     
     Type m_type;
     int m_numSegments;
     sf::Vector2f m_center;
-    std::vector<sf::VertexArray> m_lanes;
-    float m_outerRadius;
-    float m_innerRadius;
+    std::vector<sf::Vertex, ArenaAllocator<sf::Vertex>> m_lines; // Lanes and edges as sf::Lines
+    LaneTable m_laneTable;
+    Projection m_projection;
+    float m_focalLength; // Pixels per world unit at unit distance
 };
 
 } // namespace tempest
@@ -0,0 +1,57 @@
+#ifndef TEMPEST_RANDOM_HPP
+#define TEMPEST_RANDOM_HPP
+
+#include <cstdint>
+
+namespace tempest {
+
+// Small seeded generator (xorshift64*) for everything random in the
+// simulation. Unlike std::rand it is owned by the game, so a seed plus the
+// recorded inputs reproduce a session exactly on any platform.
+class Random {
+public:
+    explicit Random(std::uint64_t seed = 0) {
+        setSeed(seed);
+    }
+    
+    void setSeed(std::uint64_t seed) {
+        // splitmix64 finalizer, so nearby seeds give unrelated sequences
+        seed += 0x9E3779B97F4A7C15ULL;
+        seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+        seed ^= seed >> 31;
+        m_state = seed != 0 ? seed : 1;
+    }
+    
+    std::uint32_t next() {
+        m_state ^= m_state >> 12;
+        m_state ^= m_state << 25;
+        m_state ^= m_state >> 27;
+        return static_cast<std::uint32_t>((m_state * 0x2545F4914F6CDD1DULL) >> 32);
+    }
+    
+    // Uniform-enough integer in [0, bound)
+    int nextInt(int bound) {
+        return static_cast<int>(next() % static_cast<std::uint32_t>(bound));
+    }
+    
+    // Uniform in [0, 1)
+    float nextFloat() {
+        return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f);
+    }
+    
+    std::uint64_t getState() const {
+        return m_state;
+    }
+    
+    void setState(std::uint64_t state) {
+        m_state = state != 0 ? state : 1;
+    }
+    
+private:
+    std::uint64_t m_state;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_RANDOM_HPP
@@ -0,0 +1,44 @@
+#ifndef TEMPEST_RENDER_SCALER_HPP
+#define TEMPEST_RENDER_SCALER_HPP
+
+#include <chrono>
+
+namespace tempest {
+
+// Picks the resolution scale of the scene from measured frame cost.
+//
+// Frame times are averaged over a window of frames and the scale is only
+// revisited once per window, so the off-screen target isn't reallocated
+// every frame. Fill cost goes with the square of the scale, so a window over
+// budget shrinks it by the square root of the overshoot; sustained headroom
+// grows it back one step at a time. Scales are kept on a grid of kStep.
+class RenderScaler {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    static const float kStep;
+    
+    RenderScaler(Clock::duration budget, float minScale = 0.5f, float maxScale = 1.0f,
+                 unsigned windowFrames = 30);
+    
+    // Records the cost of one frame; true when the scale changed
+    bool frameFinished(Clock::duration workTime);
+    
+    // Drop the current window, e.g. after a resize or a stall
+    void resetWindow();
+    
+    float getScale() const;
+    
+private:
+    double m_budget; // Milliseconds
+    float m_minScale;
+    float m_maxScale;
+    float m_scale;
+    unsigned m_windowFrames;
+    unsigned m_frames;
+    double m_total;  // Milliseconds in the current window
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_RENDER_SCALER_HPP
@@ -0,0 +1,84 @@
+#ifndef TEMPEST_REPLAY_HPP
+#define TEMPEST_REPLAY_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Simulation.hpp"
+
+namespace tempest {
+
+// A recorded session: the simulation seed and arithmetic, the high score
+// shown at the start and the input of every tick. Replaying the inputs into
+// a Simulation built the same way reproduces the session tick for tick.
+// A recording that began mid-session, like each game the player starts,
+// also keeps a snapshot of the simulation it began from; restoreStart puts
+// a simulation there first.
+//
+// Alongside the inputs it keeps the score, level and lives as they changed,
+// which is what a re-simulation is checked against: the claimed result is
+// the last checkpoint, and the first checkpoint that doesn't match is the
+// tick where the two runs parted. It also keeps the state hash of every tick,
+// which finds that tick even when the score hasn't shown it yet.
+class Replay {
+public:
+    struct Checkpoint {
+        std::uint64_t tick; // Ticks simulated when it was taken
+        int score;
+        int level;
+        int lives;
+    };
+    
+    Replay();
+    Replay(std::uint64_t seed, int highScore, Arithmetic arithmetic = Arithmetic::FLOAT);
+    
+    // Drops what was recorded, keeping the buffers, and records on from the
+    // simulation as it is now
+    void start(const Simulation& simulation);
+    
+    void record(const PlayerInput& input);
+    
+    // After each tick: adds a checkpoint if the score, level or lives changed
+    void recordOutcome(const Simulation& simulation);
+    
+    std::uint64_t getSeed() const;
+    Arithmetic getArithmetic() const; // FLOAT before version 4
+    int getHighScore() const;
+    int getTickRate() const;
+    std::size_t getTickCount() const;
+    std::uint64_t getStartTick() const; // Simulation ticks before the first input
+    PlayerInput getInput(std::size_t tick) const;
+    const std::vector<Checkpoint>& getCheckpoints() const; // Empty before version 3
+    
+    // Simulation::getStateHash after each tick, for finding where two runs
+    // part (statehash::findFirstDifference); empty before version 5
+    const std::vector<std::uint64_t>& getStateHashes() const;
+    
+    // Puts a simulation built with getSeed() and getArithmetic() where the
+    // recording began; false if the start snapshot doesn't load
+    bool restoreStart(Simulation& simulation) const;
+    
+    // Binary format: header, the start snapshot, one byte of input flags per tick, the spin of
+    // each tick that has any, as 16 bits, the checkpoints, then the state
+    // hashes
+    bool saveToFile(const std::string& path) const;
+    bool loadFromFile(const std::string& path);
+    
+private:
+    void reserve();
+    
+    std::uint64_t m_seed;
+    Arithmetic m_arithmetic;
+    int m_highScore;
+    int m_tickRate;
+    std::uint64_t m_startTick;
+    std::vector<std::uint8_t> m_startState; // Empty when it began at tick 0
+    std::vector<std::uint8_t> m_inputs;
+    std::vector<std::int16_t> m_spins; // Per tick, alongside m_inputs
+    std::vector<Checkpoint> m_checkpoints;
+    std::vector<std::uint64_t> m_stateHashes; // Per tick
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_REPLAY_HPP
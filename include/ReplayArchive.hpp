@@ -0,0 +1,91 @@
+#ifndef TEMPEST_REPLAY_ARCHIVE_HPP
+#define TEMPEST_REPLAY_ARCHIVE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
+
+namespace tempest {
+
+// A replay laid out for random access: a snapshot of the whole simulation
+// every keyframeInterval ticks, each followed by the inputs up to the next
+// as runs of identical ticks, and an index of the keyframes at the end.
+//
+// Seeking to a tick restores the keyframe at or before it and simulates at
+// most one interval forward, so any point of an hours-long session is a few
+// milliseconds away. The file is memory-mapped and read in place.
+//
+// Keyframes are stored as the XOR of their snapshot with the previous one,
+// run-length coded; every kAnchorInterval-th is stored whole, which bounds
+// the chain a seek has to decode.
+class ReplayArchive {
+public:
+    static const std::uint32_t kDefaultKeyframeInterval = Simulation::kTickRate * 10;
+    static const std::uint32_t kAnchorInterval = 16;
+    
+    // Re-simulates the replay to take the keyframes, and writes the archive
+    static bool build(const Replay& replay, const std::string& path,
+                      std::uint32_t keyframeInterval = kDefaultKeyframeInterval);
+    
+    ReplayArchive();
+    
+    // Checks the header, footer and index; false if any of it is off
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    
+    std::uint64_t getSeed() const;
+    Arithmetic getArithmetic() const;
+    int getHighScore() const;
+    std::uint64_t getTickCount() const;
+    std::uint64_t getStartTick() const;
+    std::uint32_t getKeyframeInterval() const;
+    std::size_t getKeyframeCount() const;
+    std::size_t getFileSize() const;
+    
+    // Puts the simulation in its state after the given number of the
+    // replay's ticks. Listeners see only the ticks simulated past the keyframe.
+    bool seek(std::uint64_t tick, Simulation& simulation);
+    
+    // Ticks the simulation on from where it is to the given tick, with the
+    // recorded inputs; for scrubbing forward without a seek
+    bool advance(std::uint64_t tick, Simulation& simulation) const;
+    
+private:
+    struct Header {
+        std::uint32_t keyframeInterval;
+        std::uint64_t seed;
+        Arithmetic arithmetic;
+        int highScore;
+        std::uint64_t tickCount;
+        std::uint64_t startTick; // Simulation ticks before the replay's first
+    };
+    
+    // One index entry, decoded from the footer
+    struct Keyframe {
+        std::uint64_t tick;
+        std::uint64_t stateOffset;
+        std::uint32_t stateSize;
+        std::uint32_t rawSize;    // Snapshot size once decoded
+        std::uint32_t flags;
+        std::uint64_t inputOffset;
+        std::uint32_t inputSize;
+    };
+    
+    Keyframe getKeyframe(std::size_t index) const;
+    std::size_t findKeyframe(std::uint64_t tick) const; // Last one at or before the tick
+    
+    MappedFile m_file;
+    Header m_header;
+    std::uint64_t m_indexOffset;
+    std::size_t m_keyframeCount;
+    
+    std::vector<std::uint8_t> m_state; // Decoding space, kept between seeks
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_REPLAY_ARCHIVE_HPP
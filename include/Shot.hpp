@@ -2,27 +2,54 @@
 #define TEMPEST_SHOT_HPP
 
 #include <SFML/Graphics.hpp>
+#include "FixedPoint.hpp"
 
 namespace tempest {
 
+class Playfield;
+class SoftwareRasterizer;
+class StateReader;
+class StateWriter;
+
 class Shot {
 public:
-    Shot(const sf::Vector2f& startPos, const sf::Vector2f& direction);
+    static const Fixed kFixedSpeed; // Depth per second in fixed-point mode
+    
+    // A shot flying through screen space, for the float simulation
+    Shot(const sf::Vector2f& startPos, const sf::Vector2f& direction, int lane);
+    
+    // A shot moving down its lane in fixed-point depth from the rim; its
+    // screen position follows from the depth
+    Shot(int lane, const Playfield& playfield);
     
     void update(float deltaTime);
-    void draw(sf::RenderWindow& window);
+    void draw(sf::RenderTarget& target);
+    void draw(SoftwareRasterizer& rasterizer) const;
     
     bool isOutOfBounds() const;
     const sf::Vector2f& getPosition() const;
     float getRadius() const;
+    int getLane() const;        // Shots travel down a single lane
+    Fixed getDepth() const;     // Fixed-point mode only
     void destroy();
     bool isActive() const;
     
+    // Term in the state hash (see StateHash.hpp): lane, liveness and how far
+    // the shot has got. Shots move every tick, so it is computed on demand.
+    std::uint64_t getHashTerm() const;
+    
+    // Snapshot support (Simulation::saveState)
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
 private:
     sf::Vector2f m_position;
     sf::Vector2f m_velocity;
     float m_radius;
+    int m_lane;
     bool m_active;
+    const Playfield* m_playfield; // Set in fixed-point mode
+    Fixed m_depth;
     sf::CircleShape m_shape;
 };
 
@@ -0,0 +1,158 @@
+#ifndef TEMPEST_SIMULATION_HPP
+#define TEMPEST_SIMULATION_HPP
+
+#include <cstdint>
+#include <vector>
+#include "GameEvents.hpp"
+#include "LevelArena.hpp"
+#include "Playfield.hpp"
+#include "Player.hpp"
+#include "EnemyManager.hpp"
+#include "FixedPoint.hpp"
+#include "LevelManager.hpp"
+#include "Random.hpp"
+#include "TimerWheel.hpp"
+
+namespace tempest {
+
+enum class GameState {
+    MENU,
+    PLAYING,
+    GAME_OVER,
+    LEVEL_COMPLETE
+};
+
+// Controls for one tick: keys held down, plus Enter pressed since the last
+// tick, plus analog motion from a spinner or stick
+struct PlayerInput {
+    bool left;
+    bool right;
+    bool fire;
+    bool superzapper;
+    bool confirm;
+    int spin; // Player::kSpinUnitsPerLane per lane, positive to the right
+};
+
+// Game rules and world state, without a window. Game drives it from the
+// keyboard and draws it with SFML; headless tools drive it directly.
+//
+// The simulation only advances in fixed ticks and draws all randomness from
+// its seed, so the seed plus the input of every tick reproduce a session.
+// In fixed-point arithmetic they reproduce it on any build (see Arithmetic).
+class Simulation {
+public:
+    static const int kTickRate = 60; // Ticks per second
+    static const float kTickDuration;
+    static const int kKeySpin; // Spin per tick with Left or Right held
+    
+    explicit Simulation(std::uint64_t seed = 0, Arithmetic arithmetic = Arithmetic::FLOAT);
+    
+    // Game objects point into each other and the arena
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+    
+    // Advance one fixed tick with the given input. The tick's events are
+    // handed to the listeners in one batch at the end.
+    void tick(const PlayerInput& input);
+    
+    // Listeners are not owned and must outlive the simulation
+    void addListener(GameEventListener* listener);
+    
+    // Arena statistics printed at each level change; on by default
+    void setLogging(bool enabled);
+    
+    // The whole game state as bytes, and back. A loaded simulation ticks on
+    // exactly as the saved one would have; listeners and logging are kept.
+    // Loading fails, leaving the state unspecified, on a truncated or
+    // inconsistent snapshot.
+    void saveState(std::vector<std::uint8_t>& out) const;
+    bool loadState(const std::uint8_t* data, std::size_t size);
+    
+    std::uint64_t getSeed() const;
+    Arithmetic getArithmetic() const;
+    std::uint64_t getTickCount() const;
+    
+    // Rolling hash of the game state after every tick so far: the player's
+    // lane and lives, score, level, enemies still to spawn, each enemy's
+    // type, lane, depth step and liveness, the shots and the random
+    // generators (see StateHash.hpp).
+    // Two runs that ever differed have different hashes from then on.
+    std::uint64_t getStateHash() const;
+    
+    GameState getState() const;
+    int getScore() const;
+    int getHighScore() const;
+    void setHighScore(int highScore);
+    int getLevel() const;
+    int getLives() const;
+    
+    const Playfield& getPlayfield() const;
+    const Player& getPlayer() const;
+    const EnemyManager& getEnemyManager() const;
+    const LevelArena& getLevelArena() const;
+    const TimerWheel& getTimers() const;
+    
+    // Non-const access for drawing, which needs mutable SFML shapes
+    Playfield& getPlayfield();
+    Player& getPlayer();
+    EnemyManager& getEnemyManager();
+    
+private:
+    // What the simulation's timers do when they fire (TimerWheel::Timer::kind)
+    enum class TimerKind : std::uint32_t {
+        SPAWN_ENEMY,
+        SHOT_READY,
+        ENEMY_PULSE  // Payload: the enemy type
+    };
+    
+    // The Enter key: start, continue or go back to the menu depending on state
+    void confirm();
+    void applyInput(const PlayerInput& input);
+    void update(float deltaTime);
+    void checkCollisions();
+    std::uint64_t hashState() const; // This tick's state, unchained
+    void fireSuperzapper();
+    void onTimer(const TimerWheel::Timer& timer);
+    void scheduleSpawns();
+    void processEvents();
+    void startGame();
+    void startNextLevel();
+    void resetLevel(Playfield::Type playfieldType, int numSegments);
+    void buildLevel(Playfield::Type playfieldType, int numSegments);
+    
+    // Game state
+    std::uint64_t m_seed;
+    Arithmetic m_arithmetic;
+    std::uint64_t m_tickCount;
+    std::uint64_t m_stateHash;
+    Random m_random;
+    GameState m_state;
+    int m_score;
+    int m_highScore;
+    int m_level;
+    int m_lives;
+    int m_enemiesToSpawn; // Left of the level's quota
+    bool m_superzapperHeld; // Fires on the press, not while held
+    bool m_playerElectrified; // In a lit lane as of the last tick
+    bool m_logging;
+    
+    // Every timed effect, keyed on m_tickCount; plain data, so it is part of
+    // any copy of the game state
+    TimerWheel m_timers;
+    TimerWheel::TimerId m_spawnTimer;
+    TimerWheel::TimerId m_shotTimer;
+    
+    // Game objects (per-level memory comes from the arena, so it must outlive them)
+    LevelArena m_levelArena;
+    Playfield m_playfield;
+    Player m_player;
+    EnemyManager m_enemyManager;
+    LevelManager m_levelManager;
+    
+    GameEventQueue m_events;
+    std::vector<GameEventListener*> m_listeners;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_SIMULATION_HPP
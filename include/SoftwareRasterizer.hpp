@@ -0,0 +1,125 @@
+#ifndef TEMPEST_SOFTWARE_RASTERIZER_HPP
+#define TEMPEST_SOFTWARE_RASTERIZER_HPP
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tempest {
+
+// CPU-only vector rasterizer for headless frame capture.
+//
+// Draw calls are recorded into a command list in pixel space; display()
+// rasterizes them tile by tile, optionally spread over worker threads. Lines
+// are anti-aliased (Wu-style two-pixel coverage), convex polygons use exact
+// horizontal coverage with four sub-scanlines, and text uses a built-in
+// stroke font so no font file or GPU is needed. Each tile replays the
+// commands in order, so the output does not depend on the thread count.
+class SoftwareRasterizer {
+public:
+    enum class Format {
+        RGBA,
+        GRAYSCALE
+    };
+
+    SoftwareRasterizer(unsigned width, unsigned height, Format format = Format::RGBA,
+                       unsigned threadCount = 1, unsigned tileSize = 64);
+    ~SoftwareRasterizer();
+
+    SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+    SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+    // Area of game space mapped onto the whole framebuffer
+    void setView(const sf::FloatRect& area);
+
+    // Start a new frame; everything drawn until display() lands on it
+    void clear(const sf::Color& color = sf::Color::Black);
+
+    void draw(const sf::Shape& shape);
+    void draw(const sf::Vertex* vertices, std::size_t vertexCount, sf::PrimitiveType type);
+    void drawLine(const sf::Vector2f& from, const sf::Vector2f& to, const sf::Color& color);
+    void drawPolygon(const sf::Vector2f* points, std::size_t pointCount, const sf::Color& color);
+    // The character size is in game units, so text scales with the view.
+    // Text is taken as a C string so HUD numbers can be formatted into a
+    // stack buffer instead of a heap-allocated std::string.
+    void drawText(const char* text, const sf::Vector2f& position,
+                  float characterSize, const sf::Color& color);
+
+    // Width of a string in game units when drawn with drawText()
+    static float getTextWidth(const char* text, float characterSize);
+
+    // Rasterize all recorded commands into the framebuffer
+    void display();
+
+    unsigned getWidth() const;
+    unsigned getHeight() const;
+    Format getFormat() const;
+    unsigned getChannelCount() const;
+    const std::uint8_t* getPixels() const;
+
+    // Writes .png (via sf::Image), or binary .ppm/.pgm
+    bool saveToFile(const std::string& path) const;
+
+private:
+    enum class CommandType {
+        LINE,
+        POLYGON
+    };
+
+    struct Command {
+        CommandType type;
+        sf::Color color;
+        std::uint32_t firstPoint;
+        std::uint32_t pointCount;
+        float minX, minY, maxX, maxY;
+    };
+
+    struct Tile {
+        int x0, y0, x1, y1;
+    };
+
+    sf::Vector2f toPixels(const sf::Vector2f& point) const;
+    void addCommand(CommandType type, const sf::Color& color, std::size_t firstPoint);
+
+    void rasterizeTiles(std::vector<float>& coverage);
+    void rasterizeTile(const Tile& tile, std::vector<float>& coverage);
+    void rasterizeLine(const Command& command, const Tile& tile);
+    void rasterizePolygon(const Command& command, const Tile& tile, std::vector<float>& coverage);
+    void blend(int x, int y, const sf::Color& color, float coverage);
+
+    void workerLoop(unsigned index);
+
+    unsigned m_width;
+    unsigned m_height;
+    Format m_format;
+    unsigned m_channels;
+    std::vector<std::uint8_t> m_pixels;
+    sf::Color m_clearColor;
+
+    sf::FloatRect m_view;
+    sf::Vector2f m_scale;
+
+    std::vector<Command> m_commands;
+    std::vector<sf::Vector2f> m_points;
+    std::vector<Tile> m_tiles;
+    std::vector<std::vector<float>> m_coverage; // Polygon row buffer per rasterizing thread
+
+    // Worker pool; the calling thread also rasterizes tiles
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+    std::atomic<std::size_t> m_nextTile;
+    unsigned m_frameId;
+    unsigned m_workersBusy;
+    bool m_stopping;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_SOFTWARE_RASTERIZER_HPP
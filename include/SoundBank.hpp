@@ -0,0 +1,56 @@
+#ifndef TEMPEST_SOUND_BANK_HPP
+#define TEMPEST_SOUND_BANK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tempest {
+
+enum class SoundId : std::uint8_t {
+    SHOT,
+    EXPLOSION,
+    PLAYER_DEATH,
+    SUPERZAPPER,
+    LEVEL_CLEAR
+};
+
+// Every sound effect as mono 16-bit PCM at the mixer's sample rate, decoded
+// once at load so nothing is decoded or resampled while the game plays.
+//
+// A sound is taken from assets/sounds/<name>.wav (or .ogg/.flac) when one is
+// embedded, downmixed and resampled as needed; otherwise it is synthesized.
+// The bank is read-only after load(), so the mixer thread reads it without
+// any locking.
+class SoundBank {
+public:
+    static const int kSoundCount = 5;
+    static const unsigned kSampleRate = 44100;
+    
+    struct Sound {
+        std::vector<std::int16_t> samples;
+        int priority;     // Higher sounds steal voices from lower ones
+        float volume;     // Mix level before the caller's volume
+    };
+    
+    SoundBank();
+    
+    // Fills every sound; returns how many came from embedded assets
+    int load();
+    
+    const Sound& get(SoundId id) const;
+    std::size_t getByteCount() const; // PCM held by the bank
+    
+    static const char* getName(SoundId id);
+    
+private:
+    bool decode(const std::string& asset, Sound& sound);
+    void synthesize(SoundId id, Sound& sound);
+    
+    Sound m_sounds[kSoundCount];
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_SOUND_BANK_HPP
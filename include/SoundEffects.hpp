@@ -0,0 +1,27 @@
+#ifndef TEMPEST_SOUND_EFFECTS_HPP
+#define TEMPEST_SOUND_EFFECTS_HPP
+
+#include <SFML/System.hpp>
+#include "AudioMixer.hpp"
+#include "GameEvents.hpp"
+
+namespace tempest {
+
+// Turns gameplay events into mixer commands, panned by where on screen they
+// happened. Sounds are cosmetic, so the same events can drive a live device
+// or an offline render.
+class SoundEffects : public GameEventListener {
+public:
+    explicit SoundEffects(AudioMixer& mixer);
+    
+    void onEvents(const GameEventQueue& events) override;
+    
+private:
+    static float panFor(const sf::Vector2f& position);
+    
+    AudioMixer& m_mixer;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_SOUND_EFFECTS_HPP
@@ -0,0 +1,136 @@
+#ifndef TEMPEST_SPECTATOR_FEED_HPP
+#define TEMPEST_SPECTATOR_FEED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tempest {
+
+class Simulation;
+
+// What spectators see of one tick. The layout is shared with other
+// processes, so it is fixed width and native byte order, and changing it
+// means a new feed version.
+struct SpectatorEnemy {
+    std::uint8_t type;   // Enemy::Type
+    std::uint8_t lane;
+    std::uint16_t depth; // 0 at the rim to 65535 at the far end
+    float x;             // Logical coordinates (see Layout.hpp)
+    float y;
+};
+
+struct SpectatorShot {
+    std::uint8_t lane;
+    std::uint8_t reserved[3];
+    float x;
+    float y;
+};
+
+struct SpectatorRecord {
+    static const int kMaxEnemies = 64;
+    static const int kMaxShots = 16;
+    
+    std::uint64_t tick;           // Ticks simulated
+    std::uint64_t stateHash;      // Simulation::getStateHash
+    std::int32_t score;
+    std::int32_t highScore;
+    std::int32_t level;
+    std::int32_t lives;
+    std::uint8_t state;           // GameState
+    std::uint8_t playfieldType;   // Playfield::Type
+    std::uint8_t laneCount;
+    std::uint8_t playerLane;
+    std::uint8_t superzapperCharges;
+    std::uint8_t reserved[3];
+    std::uint16_t enemyCount;     // Entries in enemies, at most kMaxEnemies
+    std::uint16_t enemyTotal;     // Live in the game
+    std::uint16_t shotCount;      // Entries in shots
+    std::uint16_t reserved2;
+    SpectatorEnemy enemies[kMaxEnemies];
+    SpectatorShot shots[kMaxShots];
+};
+
+// Publishes a SpectatorRecord every tick into a named shared-memory ring
+// (POSIX shm_open, or a named file mapping on Windows) that any number of
+// local processes can follow with a SpectatorReader.
+//
+// Each slot is a seqlock: the publisher makes the slot's sequence odd,
+// writes the record in place and makes it even again, and readers copy the
+// record and keep it only if the sequence was the same even value before and
+// after. Readers map the ring read-only and never write to it, so publishing
+// is a few stores with no waiting, whatever the readers do: a stalled reader
+// just finds its records overwritten, and a crashed one leaves nothing
+// behind.
+class SpectatorFeed {
+public:
+    static const std::uint32_t kSlotCount = 64; // About a second of ticks
+    
+    SpectatorFeed();
+    ~SpectatorFeed(); // Closes
+    
+    SpectatorFeed(const SpectatorFeed&) = delete;
+    SpectatorFeed& operator=(const SpectatorFeed&) = delete;
+    
+    // Creates a fresh ring under the name, replacing any left by an earlier
+    // run; readers still attached to that one see it closed or stop moving
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const;
+    
+    // After each tick; doesn't allocate
+    void publish(const Simulation& simulation);
+    
+private:
+    friend class SpectatorReader;
+    struct Layout;
+    
+    Layout* m_layout;
+    std::string m_name;   // As passed to the system
+    std::uint64_t m_published;
+#ifdef _WIN32
+    void* m_mapping;      // HANDLE, kept out of the header with windows.h
+#endif
+};
+
+// Follows a SpectatorFeed from another process
+class SpectatorReader {
+public:
+    enum class Result {
+        OK,
+        NOT_YET,    // Not published yet
+        OVERWRITTEN // The publisher has lapped it; it is gone
+    };
+    
+    SpectatorReader();
+    ~SpectatorReader();
+    
+    SpectatorReader(const SpectatorReader&) = delete;
+    SpectatorReader& operator=(const SpectatorReader&) = delete;
+    
+    // Fails if there is no feed under the name or it isn't this version
+    bool open(const std::string& name);
+    void close();
+    bool isOpen() const;
+    
+    // Records published so far; record n is the one published n-th, from 0
+    std::uint64_t getPublishedCount() const;
+    // The publisher closed the feed; a new one may be opened under the name
+    bool isClosed() const;
+    
+    // Copies record n out of the ring without ever holding up the publisher.
+    // Slots are only rewritten with later records, so a copy torn by a
+    // concurrent write means record n is gone: that is OVERWRITTEN too.
+    Result read(std::uint64_t index, SpectatorRecord& out) const;
+    
+private:
+    const SpectatorFeed::Layout* m_layout;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_mapping;
+#endif
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_SPECTATOR_FEED_HPP
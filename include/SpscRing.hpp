@@ -0,0 +1,67 @@
+#ifndef TEMPEST_SPSC_RING_HPP
+#define TEMPEST_SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace tempest {
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Head and tail only ever grow and are masked into the buffer, so a
+// push or pop is one acquire load of the other side's index and one release
+// store of its own. The indices sit on separate cache lines so the two
+// threads don't contend for one.
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing()
+        : m_head(0)
+        , m_tail(0)
+    {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side; false when full
+    bool push(const T& item) {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        m_items[head & (Capacity - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: the oldest item without removing it, or null when empty
+    const T* front() const {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &m_items[tail & (Capacity - 1)];
+    }
+
+    // Consumer side: drops the item front() returned
+    void pop() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Approximate from either side while the other is running
+    std::size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<std::size_t> m_head; // Written by the producer
+    alignas(64) std::atomic<std::size_t> m_tail; // Written by the consumer
+    alignas(64) T m_items[Capacity];
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_SPSC_RING_HPP
@@ -0,0 +1,34 @@
+#ifndef TEMPEST_STARTUP_PROFILE_HPP
+#define TEMPEST_STARTUP_PROFILE_HPP
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tempest {
+
+// Splits startup into named phases. Timing starts at construction; each
+// mark() closes the phase that has been running since the previous mark.
+class StartupProfile {
+public:
+    StartupProfile();
+    
+    void mark(const char* phase);
+    
+    double getTotalMilliseconds() const;
+    
+    // One line per phase plus the total, flagged if it exceeds the budget
+    std::string getReport(double budgetMilliseconds) const;
+    
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    Clock::time_point m_start;
+    Clock::time_point m_last;
+    std::vector<std::pair<const char*, double>> m_phases;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_STARTUP_PROFILE_HPP
@@ -0,0 +1,76 @@
+#ifndef TEMPEST_STATE_HASH_HPP
+#define TEMPEST_STATE_HASH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tempest {
+
+// Hashing of the game state for desync detection (Simulation::getStateHash).
+//
+// The state hash is a sum of one term per component: the player, each enemy,
+// each shot and the random generators. A component that changes has its old
+// term taken out and its new one put in, so keeping the hash current costs
+// in proportion to what changed. It is a sum rather than an XOR so that two
+// identical enemies in the same place don't cancel out.
+//
+// Each tick's state hash is chained onto the previous tick's. The hash after
+// a tick therefore covers every tick before it: once two runs differ they
+// differ from then on, and the first differing tick is a binary search away.
+namespace statehash {
+
+// What a term describes, so equal values in different components differ
+enum Tag : std::uint64_t {
+    TAG_PLAYER = 1,
+    TAG_SCORE,
+    TAG_ENEMY,
+    TAG_SHOT,
+    TAG_RANDOM
+};
+
+// Steps of depth from the rim to the far end that count as a change
+const int kDepthSteps = 256;
+
+// splitmix64's finalizer: every input bit affects every output bit
+inline std::uint64_t mix(std::uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+inline std::uint64_t term(Tag tag, std::uint64_t value) {
+    return mix(value + mix(tag));
+}
+
+inline std::uint32_t quantizeDepth(float depth) {
+    return static_cast<std::uint32_t>(std::max(0.0f, depth) * kDepthSteps);
+}
+
+inline std::uint64_t chain(std::uint64_t previous, std::uint64_t state) {
+    return mix(previous + mix(state));
+}
+
+// The first index at which two sequences of chained hashes differ, or the
+// length of the shorter one if they agree that far; O(log n) comparisons
+inline std::size_t findFirstDifference(const std::vector<std::uint64_t>& a,
+                                       const std::vector<std::uint64_t>& b) {
+    std::size_t low = 0;
+    std::size_t high = std::min(a.size(), b.size());
+    while (low < high) {
+        std::size_t middle = low + (high - low) / 2;
+        if (a[middle] != b[middle]) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+} // namespace statehash
+
+} // namespace tempest
+
+#endif // TEMPEST_STATE_HASH_HPP
@@ -0,0 +1,136 @@
+#ifndef TEMPEST_STATE_STREAM_HPP
+#define TEMPEST_STATE_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace tempest {
+
+// Byte streams for simulation snapshots (Simulation::saveState).
+//
+// Fixed little-endian layout whatever the host, and floats as their exact
+// bit patterns, so a snapshot restores bit for bit on any machine and two
+// snapshots of the same state compare equal byte for byte.
+class StateWriter {
+public:
+    explicit StateWriter(std::vector<std::uint8_t>& buffer)
+        : m_buffer(buffer)
+    {
+    }
+    
+    void writeU8(std::uint8_t value) {
+        m_buffer.push_back(value);
+    }
+    
+    void writeBool(bool value) {
+        writeU8(value ? 1 : 0);
+    }
+    
+    void writeU32(std::uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            m_buffer.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+    }
+    
+    void writeU64(std::uint64_t value) {
+        writeU32(static_cast<std::uint32_t>(value));
+        writeU32(static_cast<std::uint32_t>(value >> 32));
+    }
+    
+    void writeInt(int value) {
+        writeU32(static_cast<std::uint32_t>(value));
+    }
+    
+    void writeFloat(float value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeU32(bits);
+    }
+    
+private:
+    std::vector<std::uint8_t>& m_buffer;
+};
+
+// Reads what StateWriter wrote. Reading past the end yields zeros and
+// clears ok(), so callers can read a whole record and check once.
+class StateReader {
+public:
+    StateReader(const std::uint8_t* data, std::size_t size)
+        : m_data(data)
+        , m_size(size)
+        , m_offset(0)
+        , m_ok(true)
+    {
+    }
+    
+    std::uint8_t readU8() {
+        if (m_offset + 1 > m_size) {
+            m_ok = false;
+            return 0;
+        }
+        return m_data[m_offset++];
+    }
+    
+    bool readBool() {
+        return readU8() != 0;
+    }
+    
+    std::uint32_t readU32() {
+        if (m_offset + 4 > m_size) {
+            m_ok = false;
+            return 0;
+        }
+        const std::uint8_t* bytes = m_data + m_offset;
+        m_offset += 4;
+        return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+               (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+    }
+    
+    std::uint64_t readU64() {
+        std::uint64_t low = readU32();
+        std::uint64_t high = readU32();
+        return low | (high << 32);
+    }
+    
+    int readInt() {
+        return static_cast<int>(readU32());
+    }
+    
+    float readFloat() {
+        std::uint32_t bits = readU32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    
+    // A count of records still to come, each at least minimumSize bytes;
+    // fails rather than let a corrupt count size a huge allocation
+    std::size_t readCount(std::size_t minimumSize) {
+        std::uint32_t count = readU32();
+        if (minimumSize > 0 && count > (m_size - m_offset) / minimumSize) {
+            m_ok = false;
+            return 0;
+        }
+        return count;
+    }
+    
+    bool ok() const {
+        return m_ok;
+    }
+    
+    bool atEnd() const {
+        return m_offset == m_size;
+    }
+    
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+    std::size_t m_offset;
+    bool m_ok;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_STATE_STREAM_HPP
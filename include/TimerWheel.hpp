@@ -0,0 +1,114 @@
+#ifndef TEMPEST_TIMER_WHEEL_HPP
+#define TEMPEST_TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tempest {
+
+class StateReader;
+class StateWriter;
+
+// Hierarchical timer wheel keyed on simulation ticks.
+//
+// Four levels of 64 slots each; a timer sits in the finest level whose span
+// covers its deadline and drops a level each time the coarser slot comes
+// round, so one advance() costs the timers that fire plus those cascading
+// down, never a pass over every pending timer. Cancelling is constant time
+// through generation-checked handles.
+//
+// A timer is a kind and a payload rather than a closure, and the wheel holds
+// only plain data, so copying it is a snapshot and assigning it back
+// restores the timers with their handles intact.
+class TimerWheel {
+public:
+    typedef std::uint64_t TimerId;
+    static const TimerId kNoTimer = 0; // Never a live handle
+    
+    struct Timer {
+        TimerId id;
+        std::uint64_t deadline; // Tick it fired for
+        std::uint32_t kind;
+        std::uint32_t payload;
+    };
+    
+    explicit TimerWheel(std::uint64_t now = 0);
+    
+    // Fire at the given tick, then every period ticks if the period is not 0.
+    // Deadlines already past fire on the next advance.
+    TimerId schedule(std::uint64_t deadline, std::uint32_t kind, std::uint32_t payload = 0,
+                     std::uint32_t period = 0);
+    
+    // False if the timer already fired (and does not repeat) or was cancelled
+    bool cancel(TimerId id);
+    bool isPending(TimerId id) const;
+    std::uint64_t getDeadline(TimerId id) const; // Next deadline, 0 if not pending
+    
+    // Fire every timer due at the current tick, in the order they were
+    // scheduled, and move on to the next tick. Timers scheduled from the
+    // callback fire on a later advance.
+    template <typename Function>
+    void advance(Function onFire) {
+        collectDue();
+        Timer timer;
+        while (popDue(timer)) {
+            onFire(timer);
+        }
+    }
+    
+    void clear();
+    
+    std::uint64_t getNow() const; // The tick the next advance() fires
+    std::size_t getPendingCount() const;
+    
+    // The same plain data as a byte stream, for simulation snapshots;
+    // handles stay valid across a save and load
+    void saveState(StateWriter& out) const;
+    bool loadState(StateReader& in);
+    
+private:
+    static const int kLevels = 4;
+    static const int kSlotBits = 6;
+    static const int kSlots = 1 << kSlotBits;
+    static const std::uint32_t kDueList = kLevels * kSlots; // Fired this tick
+    static const std::uint32_t kFree = kDueList + 1;
+    static const std::uint32_t kNil = 0xFFFFFFFFu;
+    
+    struct Node {
+        std::uint64_t deadline;
+        std::uint32_t period;
+        std::uint32_t kind;
+        std::uint32_t payload;
+        std::uint32_t generation;
+        std::uint32_t list;     // Slot, kDueList or kFree
+        std::uint32_t previous;
+        std::uint32_t next;
+    };
+    
+    struct List {
+        std::uint32_t head;
+        std::uint32_t tail;
+    };
+    
+    const Node* find(TimerId id) const;
+    TimerId makeId(std::uint32_t index) const;
+    
+    void insert(std::uint32_t index);
+    void pushBack(std::uint32_t list, std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    void cascade(int level);
+    void collectDue();
+    bool popDue(Timer& timer);
+    
+    std::vector<Node> m_nodes;
+    List m_lists[kDueList + 1];
+    std::uint32_t m_freeHead; // Singly linked through Node::next
+    std::uint64_t m_now;
+    std::size_t m_pendingCount;
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_TIMER_WHEEL_HPP
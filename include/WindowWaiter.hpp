@@ -0,0 +1,37 @@
+#ifndef TEMPEST_WINDOW_WAITER_HPP
+#define TEMPEST_WINDOW_WAITER_HPP
+
+#include <SFML/Window.hpp>
+
+namespace tempest {
+
+// Blocks until a window has input or a timeout passes, which SFML 2 can't
+// do: waitEvent has no timeout and polls every 10 ms inside.
+//
+// On X11 it watches the window through a connection of its own, so the
+// events still reach the window's; on Windows it waits on the thread's
+// message queue. Elsewhere it sleeps a tick at a time, for the caller to
+// poll the window in between.
+class WindowWaiter {
+public:
+    WindowWaiter();
+    ~WindowWaiter();
+    
+    WindowWaiter(const WindowWaiter&) = delete;
+    WindowWaiter& operator=(const WindowWaiter&) = delete;
+    
+    void attach(sf::WindowHandle window);
+    
+    // True once the window may have input, false on timing out (or at the
+    // end of a slice, where there is no way to wait for input)
+    bool wait(sf::Time timeout);
+    
+private:
+#ifdef TEMPEST_X11
+    void* m_display; // Display*, kept out of the header with the rest of Xlib
+#endif
+};
+
+} // namespace tempest
+
+#endif // TEMPEST_WINDOW_WAITER_HPP
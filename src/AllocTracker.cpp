@@ -0,0 +1,429 @@
+#include "AllocTracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#if defined(TEMPEST_ALLOC_TRACKING) && defined(__GLIBC__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#define TEMPEST_ALLOC_BACKTRACE 1
+#endif
+
+namespace tempest {
+
+const int AllocTracker::kSubsystemCount;
+const int AllocTracker::kSiteDepth;
+const std::size_t AllocTracker::kMaxSites;
+
+namespace {
+
+const char* const kSubsystemNames[AllocTracker::kSubsystemCount] = {
+    "other", "simulation", "player", "enemies", "events", "particles", "render", "ui", "audio"
+};
+
+#ifdef TEMPEST_ALLOC_TRACKING
+
+// Everything here is zero-initialized static storage, so it is usable by
+// allocations made before main() and during static destruction
+
+struct Counter {
+    std::atomic<std::uint64_t> allocations;
+    std::atomic<std::uint64_t> bytes;
+    std::atomic<std::uint64_t> frees;
+};
+
+struct SiteSlot {
+    std::atomic<std::uint64_t> hash;      // 0 while the slot is free
+    std::atomic<bool> ready;              // stack and subsystem are written
+    const void* stack[AllocTracker::kSiteDepth];
+    AllocSubsystem subsystem;
+    std::atomic<std::uint64_t> allocations;
+    std::atomic<std::uint64_t> bytes;
+    std::atomic<std::uint64_t> frameAllocations;
+};
+
+// Probes before a call site counts as lost rather than scanning the table
+const std::size_t kMaxProbes = 64;
+
+// Frames of the hook itself: recordAllocation() and operator new
+const int kHookFrames = 2;
+
+Counter g_total[AllocTracker::kSubsystemCount];
+Counter g_frame[AllocTracker::kSubsystemCount];
+SiteSlot g_sites[AllocTracker::kMaxSites];
+std::atomic<std::uint64_t> g_lostSites;
+
+thread_local AllocSubsystem t_subsystem = AllocSubsystem::OTHER;
+thread_local bool t_inHook = false; // backtrace() may allocate the first time
+
+// Keeps the tracker's own bookkeeping and reports out of the counts
+class Untracked {
+public:
+    Untracked()
+        : m_wasInHook(t_inHook)
+    {
+        t_inHook = true;
+    }
+    
+    ~Untracked() {
+        t_inHook = m_wasInHook;
+    }
+    
+private:
+    bool m_wasInHook;
+};
+
+void add(Counter& counter, std::size_t size) {
+    counter.allocations.fetch_add(1, std::memory_order_relaxed);
+    counter.bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+std::uint64_t hashStack(const void* const* stack) {
+    // FNV-1a over the addresses; 0 is reserved for free slots
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (int i = 0; i < AllocTracker::kSiteDepth; ++i) {
+        hash ^= reinterpret_cast<std::uintptr_t>(stack[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash | 1;
+}
+
+void recordSite(std::size_t size, AllocSubsystem subsystem) {
+    const void* stack[AllocTracker::kSiteDepth] = {};
+#ifdef TEMPEST_ALLOC_BACKTRACE
+    void* frames[AllocTracker::kSiteDepth + kHookFrames];
+    int depth = backtrace(frames, AllocTracker::kSiteDepth + kHookFrames);
+    for (int i = kHookFrames; i < depth; ++i) {
+        stack[i - kHookFrames] = frames[i];
+    }
+#elif defined(__GNUC__)
+    stack[0] = __builtin_return_address(1);
+#endif
+    
+    std::uint64_t hash = hashStack(stack);
+    std::size_t index = static_cast<std::size_t>(hash % AllocTracker::kMaxSites);
+    for (std::size_t probe = 0; probe < kMaxProbes; ++probe) {
+        SiteSlot& slot = g_sites[(index + probe) % AllocTracker::kMaxSites];
+        std::uint64_t existing = slot.hash.load(std::memory_order_acquire);
+        if (existing == 0) {
+            if (slot.hash.compare_exchange_strong(existing, hash, std::memory_order_acq_rel)) {
+                std::copy(stack, stack + AllocTracker::kSiteDepth, slot.stack);
+                slot.subsystem = subsystem;
+                slot.ready.store(true, std::memory_order_release);
+                existing = hash;
+            }
+        }
+        if (existing == hash) {
+            slot.allocations.fetch_add(1, std::memory_order_relaxed);
+            slot.bytes.fetch_add(size, std::memory_order_relaxed);
+            slot.frameAllocations.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    g_lostSites.fetch_add(1, std::memory_order_relaxed);
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void recordAllocation(std::size_t size) {
+    if (t_inHook) {
+        return;
+    }
+    t_inHook = true;
+    
+    AllocSubsystem subsystem = t_subsystem;
+    add(g_total[static_cast<int>(subsystem)], size);
+    add(g_frame[static_cast<int>(subsystem)], size);
+    recordSite(size, subsystem);
+    
+    t_inHook = false;
+}
+
+void recordFree() {
+    int subsystem = static_cast<int>(t_subsystem);
+    g_total[subsystem].frees.fetch_add(1, std::memory_order_relaxed);
+    g_frame[subsystem].frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocTracker::Counts read(const Counter& counter) {
+    AllocTracker::Counts counts;
+    counts.allocations = counter.allocations.load(std::memory_order_relaxed);
+    counts.bytes = counter.bytes.load(std::memory_order_relaxed);
+    counts.frees = counter.frees.load(std::memory_order_relaxed);
+    return counts;
+}
+
+AllocTracker::Counts sum(const Counter* counters) {
+    AllocTracker::Counts total = {0, 0, 0};
+    for (int i = 0; i < AllocTracker::kSubsystemCount; ++i) {
+        AllocTracker::Counts counts = read(counters[i]);
+        total.allocations += counts.allocations;
+        total.bytes += counts.bytes;
+        total.frees += counts.frees;
+    }
+    return total;
+}
+
+#else
+
+class Untracked {
+public:
+    Untracked() {}
+};
+
+#endif // TEMPEST_ALLOC_TRACKING
+
+} // namespace
+
+#ifdef TEMPEST_ALLOC_TRACKING
+
+bool AllocTracker::isEnabled() {
+    return true;
+}
+
+void AllocTracker::beginFrame() {
+    for (Counter& counter : g_frame) {
+        counter.allocations.store(0, std::memory_order_relaxed);
+        counter.bytes.store(0, std::memory_order_relaxed);
+        counter.frees.store(0, std::memory_order_relaxed);
+    }
+    for (SiteSlot& slot : g_sites) {
+        if (slot.ready.load(std::memory_order_acquire)) {
+            slot.frameAllocations.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+AllocTracker::Counts AllocTracker::getTotal() {
+    return sum(g_total);
+}
+
+AllocTracker::Counts AllocTracker::getTotal(AllocSubsystem subsystem) {
+    return read(g_total[static_cast<int>(subsystem)]);
+}
+
+AllocTracker::Counts AllocTracker::getFrame() {
+    return sum(g_frame);
+}
+
+AllocTracker::Counts AllocTracker::getFrame(AllocSubsystem subsystem) {
+    return read(g_frame[static_cast<int>(subsystem)]);
+}
+
+std::size_t AllocTracker::getSites(Site* sites, std::size_t maxSites, bool frameOnly) {
+    // Sorted by copying into a temporary, which isn't counted
+    Untracked untracked;
+    std::vector<Site> found;
+    for (const SiteSlot& slot : g_sites) {
+        if (!slot.ready.load(std::memory_order_acquire)) {
+            continue;
+        }
+        Site site;
+        std::copy(slot.stack, slot.stack + kSiteDepth, site.stack);
+        site.subsystem = slot.subsystem;
+        site.allocations = slot.allocations.load(std::memory_order_relaxed);
+        site.bytes = slot.bytes.load(std::memory_order_relaxed);
+        site.frameAllocations = slot.frameAllocations.load(std::memory_order_relaxed);
+        if (!frameOnly || site.frameAllocations > 0) {
+            found.push_back(site);
+        }
+    }
+    
+    std::sort(found.begin(), found.end(), [frameOnly](const Site& a, const Site& b) {
+        return frameOnly ? a.frameAllocations > b.frameAllocations : a.allocations > b.allocations;
+    });
+    std::size_t count = std::min(maxSites, found.size());
+    std::copy(found.begin(), found.begin() + count, sites);
+    return count;
+}
+
+std::uint64_t AllocTracker::getLostSites() {
+    return g_lostSites.load(std::memory_order_relaxed);
+}
+
+AllocScope::AllocScope(AllocSubsystem subsystem)
+    : m_previous(t_subsystem)
+{
+    t_subsystem = subsystem;
+}
+
+AllocScope::~AllocScope() {
+    t_subsystem = m_previous;
+}
+
+#else
+
+bool AllocTracker::isEnabled() {
+    return false;
+}
+
+void AllocTracker::beginFrame() {
+}
+
+AllocTracker::Counts AllocTracker::getTotal() {
+    return Counts{0, 0, 0};
+}
+
+AllocTracker::Counts AllocTracker::getTotal(AllocSubsystem) {
+    return Counts{0, 0, 0};
+}
+
+AllocTracker::Counts AllocTracker::getFrame() {
+    return Counts{0, 0, 0};
+}
+
+AllocTracker::Counts AllocTracker::getFrame(AllocSubsystem) {
+    return Counts{0, 0, 0};
+}
+
+std::size_t AllocTracker::getSites(Site*, std::size_t, bool) {
+    return 0;
+}
+
+std::uint64_t AllocTracker::getLostSites() {
+    return 0;
+}
+
+#endif // TEMPEST_ALLOC_TRACKING
+
+const char* AllocTracker::getSubsystemName(AllocSubsystem subsystem) {
+    return kSubsystemNames[static_cast<int>(subsystem)];
+}
+
+std::string AllocTracker::describe(const Site& site) {
+    Untracked untracked;
+    std::stringstream ss;
+    for (int i = 0; i < kSiteDepth && site.stack[i]; ++i) {
+        if (i > 0) {
+            ss << " <- ";
+        }
+#ifdef TEMPEST_ALLOC_BACKTRACE
+        Dl_info info;
+        if (dladdr(site.stack[i], &info) && info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+            std::free(demangled);
+    
+            // Template-heavy names are cut down to something readable
+            if (name.size() > 80) {
+                name = name.substr(0, 77) + "...";
+            }
+            ss << name << "+0x" << std::hex
+               << (static_cast<const char*>(site.stack[i]) - static_cast<const char*>(info.dli_saddr))
+               << std::dec;
+            continue;
+        }
+#endif
+        ss << site.stack[i];
+    }
+    return ss.str();
+}
+
+std::string AllocTracker::getReport(std::size_t siteCount) {
+    if (!isEnabled()) {
+        return "Allocation tracking not built in (configure with -DTEMPEST_ALLOC_TRACKING=ON)";
+    }
+    
+    Untracked untracked;
+    Counts total = getTotal();
+    std::stringstream ss;
+    ss << "Allocations: " << total.allocations << " (" << total.bytes << " bytes), "
+       << total.frees << " frees";
+    for (int i = 0; i < kSubsystemCount; ++i) {
+        Counts counts = getTotal(static_cast<AllocSubsystem>(i));
+        if (counts.allocations > 0) {
+            ss << "\n  " << kSubsystemNames[i] << ": " << counts.allocations << " ("
+               << counts.bytes << " bytes)";
+        }
+    }
+    
+    std::vector<Site> sites(siteCount);
+    sites.resize(getSites(sites.data(), siteCount, false));
+    for (const Site& site : sites) {
+        ss << "\n  " << site.allocations << "x " << site.bytes << " bytes ["
+           << getSubsystemName(site.subsystem) << "] " << describe(site);
+    }
+    if (getLostSites() > 0) {
+        ss << "\n  " << getLostSites() << " allocations from untracked sites";
+    }
+    return ss.str();
+}
+
+} // namespace tempest
+
+#ifdef TEMPEST_ALLOC_TRACKING
+
+// Replacements for the global allocation functions. They forward to malloc
+// and free, so they never recurse into themselves.
+
+void* operator new(std::size_t size) {
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    tempest::recordAllocation(size);
+    return memory;
+}
+
+void* operator new[](std::size_t size) {
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    tempest::recordAllocation(size);
+    return memory;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    void* memory = std::malloc(size ? size : 1);
+    if (memory) {
+        tempest::recordAllocation(size);
+    }
+    return memory;
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    void* memory = std::malloc(size ? size : 1);
+    if (memory) {
+        tempest::recordAllocation(size);
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory) {
+        tempest::recordFree();
+        std::free(memory);
+    }
+}
+
+void operator delete[](void* memory) noexcept {
+    if (memory) {
+        tempest::recordFree();
+        std::free(memory);
+    }
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    operator delete[](memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    operator delete[](memory);
+}
+
+#endif // TEMPEST_ALLOC_TRACKING
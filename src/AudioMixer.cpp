@@ -0,0 +1,258 @@
+#include "AudioMixer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace tempest {
+
+const AudioMixer::VoiceHandle AudioMixer::kNoVoice;
+const int AudioMixer::kChannels;
+const int AudioMixer::kDefaultVoices;
+const int AudioMixer::kMaxVoices;
+const std::size_t AudioMixer::kBlockFrames;
+
+AudioMixer::AudioMixer(const SoundBank& bank, int voiceCount)
+    : m_bank(bank)
+    , m_nextHandle(kNoVoice)
+    , m_voices()
+    , m_voiceCount(std::max(1, std::min(kMaxVoices, voiceCount)))
+    , m_masterVolume(1.0f)
+    , m_accumulator()
+    , m_framesMixed(0)
+    , m_played(0)
+    , m_stolen(0)
+    , m_dropped(0)
+    , m_commandsLost(0)
+    , m_activeVoices(0)
+    , m_peakVoices(0)
+{
+}
+
+AudioMixer::VoiceHandle AudioMixer::play(SoundId id, float volume, float pan) {
+    // Equal-power pan, worked out here so the mixer does no trigonometry
+    const float kQuarterPi = 0.78539816f;
+    float angle = (std::max(-1.0f, std::min(1.0f, pan)) + 1.0f) * kQuarterPi;
+    float level = volume * m_bank.get(id).volume;
+    
+    if (++m_nextHandle == kNoVoice) {
+        ++m_nextHandle;
+    }
+    
+    Command command = {Command::Type::PLAY, id, m_nextHandle,
+                       level * std::cos(angle), level * std::sin(angle)};
+    send(command);
+    return command.handle;
+}
+
+void AudioMixer::stop(VoiceHandle handle) {
+    Command command = {Command::Type::STOP, SoundId::SHOT, handle, 0.0f, 0.0f};
+    send(command);
+}
+
+void AudioMixer::stopAll() {
+    Command command = {Command::Type::STOP_ALL, SoundId::SHOT, kNoVoice, 0.0f, 0.0f};
+    send(command);
+}
+
+void AudioMixer::setMasterVolume(float volume) {
+    Command command = {Command::Type::MASTER_VOLUME, SoundId::SHOT, kNoVoice,
+                       std::max(0.0f, volume), 0.0f};
+    send(command);
+}
+
+void AudioMixer::mix(std::int16_t* output, std::size_t frameCount) {
+    applyCommands();
+    
+    std::size_t done = 0;
+    while (done < frameCount) {
+        std::size_t block = std::min(kBlockFrames, frameCount - done);
+        std::fill(m_accumulator, m_accumulator + block * kChannels, 0.0f);
+    
+        for (int v = 0; v < m_voiceCount; ++v) {
+            Voice& voice = m_voices[v];
+            if (!voice.samples) {
+                continue;
+            }
+    
+            std::size_t count = std::min(block, voice.length - voice.position);
+            const std::int16_t* source = voice.samples + voice.position;
+            const float left = voice.gainLeft * (1.0f / 32768.0f);
+            const float right = voice.gainRight * (1.0f / 32768.0f);
+            for (std::size_t i = 0; i < count; ++i) {
+                float sample = source[i];
+                m_accumulator[i * 2] += sample * left;
+                m_accumulator[i * 2 + 1] += sample * right;
+            }
+    
+            voice.position += count;
+            if (voice.position >= voice.length) {
+                voice.samples = nullptr;
+            }
+        }
+    
+        // Hard clip: the per-sound levels leave headroom for the usual mix
+        const float scale = m_masterVolume * 32767.0f;
+        std::int16_t* target = output + done * kChannels;
+        for (std::size_t i = 0; i < block * kChannels; ++i) {
+            float value = std::max(-32768.0f, std::min(32767.0f, m_accumulator[i] * scale));
+            target[i] = static_cast<std::int16_t>(value);
+        }
+        done += block;
+    }
+    
+    int active = 0;
+    for (int v = 0; v < m_voiceCount; ++v) {
+        active += m_voices[v].samples ? 1 : 0;
+    }
+    m_activeVoices.store(active, std::memory_order_relaxed);
+    m_framesMixed.fetch_add(frameCount, std::memory_order_relaxed);
+}
+
+void AudioMixer::render(std::size_t frameCount, std::vector<std::int16_t>& output) {
+    std::size_t offset = output.size();
+    output.resize(offset + frameCount * kChannels);
+    mix(output.data() + offset, frameCount);
+}
+
+int AudioMixer::getVoiceCount() const {
+    return m_voiceCount;
+}
+
+int AudioMixer::getActiveVoices() const {
+    return m_activeVoices.load(std::memory_order_relaxed);
+}
+
+AudioMixer::Stats AudioMixer::getStats() const {
+    Stats stats;
+    stats.framesMixed = m_framesMixed.load(std::memory_order_relaxed);
+    stats.played = m_played.load(std::memory_order_relaxed);
+    stats.stolen = m_stolen.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.commandsLost = m_commandsLost.load(std::memory_order_relaxed);
+    stats.peakVoices = m_peakVoices.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioMixer::send(const Command& command) {
+    // A full queue means the mixer has stalled; losing a sound beats waiting
+    if (!m_commands.push(command)) {
+        m_commandsLost.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AudioMixer::applyCommands() {
+    while (const Command* command = m_commands.front()) {
+        switch (command->type) {
+            case Command::Type::PLAY:
+                start(*command);
+                break;
+            case Command::Type::STOP:
+                for (int v = 0; v < m_voiceCount; ++v) {
+                    if (m_voices[v].samples && m_voices[v].handle == command->handle) {
+                        m_voices[v].samples = nullptr;
+                    }
+                }
+                break;
+            case Command::Type::STOP_ALL:
+                for (int v = 0; v < m_voiceCount; ++v) {
+                    m_voices[v].samples = nullptr;
+                }
+                break;
+            case Command::Type::MASTER_VOLUME:
+                m_masterVolume = command->gainLeft;
+                break;
+        }
+        m_commands.pop();
+    }
+}
+
+void AudioMixer::start(const Command& command) {
+    const SoundBank::Sound& sound = m_bank.get(command.sound);
+    if (sound.samples.empty()) {
+        return;
+    }
+    
+    // A free voice, or else the weakest one: lowest priority, then least
+    // left to play
+    Voice* target = nullptr;
+    Voice* victim = nullptr;
+    int active = 0;
+    for (int v = 0; v < m_voiceCount; ++v) {
+        Voice& voice = m_voices[v];
+        if (!voice.samples) {
+            if (!target) {
+                target = &voice;
+            }
+            continue;
+        }
+    
+        active++;
+        if (!victim || voice.priority < victim->priority ||
+            (voice.priority == victim->priority &&
+             voice.length - voice.position < victim->length - victim->position)) {
+            victim = &voice;
+        }
+    }
+    
+    if (!target) {
+        if (victim->priority > sound.priority) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        target = victim;
+        active--;
+        m_stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    target->samples = sound.samples.data();
+    target->length = sound.samples.size();
+    target->position = 0;
+    target->handle = command.handle;
+    target->priority = sound.priority;
+    target->gainLeft = command.gainLeft;
+    target->gainRight = command.gainRight;
+    m_played.fetch_add(1, std::memory_order_relaxed);
+    
+    if (active + 1 > m_peakVoices.load(std::memory_order_relaxed)) {
+        m_peakVoices.store(active + 1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<std::uint8_t> encodeWav(const std::vector<std::int16_t>& samples, unsigned channels,
+                                    unsigned sampleRate) {
+    const std::uint32_t dataBytes = static_cast<std::uint32_t>(samples.size() * 2);
+    std::vector<std::uint8_t> file;
+    file.reserve(44 + dataBytes);
+    
+    auto text = [&file](const char* tag) {
+        file.insert(file.end(), tag, tag + 4);
+    };
+    auto u16 = [&file](std::uint32_t value) {
+        file.push_back(static_cast<std::uint8_t>(value));
+        file.push_back(static_cast<std::uint8_t>(value >> 8));
+    };
+    auto u32 = [&u16](std::uint32_t value) {
+        u16(value & 0xFFFF);
+        u16(value >> 16);
+    };
+    
+    // Little-endian throughout, whatever the host
+    text("RIFF");
+    u32(36 + dataBytes);
+    text("WAVE");
+    text("fmt ");
+    u32(16);
+    u16(1); // PCM
+    u16(channels);
+    u32(sampleRate);
+    u32(sampleRate * channels * 2);
+    u16(channels * 2);
+    u16(16);
+    text("data");
+    u32(dataBytes);
+    for (std::int16_t sample : samples) {
+        u16(static_cast<std::uint16_t>(sample));
+    }
+    return file;
+}
+
+} // namespace tempest
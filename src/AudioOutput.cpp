@@ -0,0 +1,35 @@
+#include "AudioOutput.hpp"
+#include "AllocTracker.hpp"
+
+namespace tempest {
+
+const std::size_t AudioOutput::kDefaultChunkFrames;
+
+AudioOutput::AudioOutput(AudioMixer& mixer, std::size_t chunkFrames)
+    : m_mixer(mixer)
+    , m_buffer(chunkFrames * AudioMixer::kChannels)
+{
+    initialize(AudioMixer::kChannels, SoundBank::kSampleRate);
+    
+    // Refill as soon as a buffer is free rather than on SFML's default 10 ms
+    setProcessingInterval(sf::milliseconds(2));
+}
+
+AudioOutput::~AudioOutput() {
+    // The streaming thread must be gone before the buffer and mixer are
+    stop();
+}
+
+bool AudioOutput::onGetData(Chunk& data) {
+    AllocScope scope(AllocSubsystem::AUDIO);
+    m_mixer.mix(m_buffer.data(), m_buffer.size() / AudioMixer::kChannels);
+    data.samples = m_buffer.data();
+    data.sampleCount = m_buffer.size();
+    return true;
+}
+
+void AudioOutput::onSeek(sf::Time) {
+    // A live stream has nowhere to seek to
+}
+
+} // namespace tempest
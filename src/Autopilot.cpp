@@ -0,0 +1,62 @@
+#include "Autopilot.hpp"
+
+namespace tempest {
+
+namespace {
+
+// The lane nearest the player's, either way round, with an enemy parked on
+// the rim; -1 if there is none
+int findNearestRimLane(const LaneIndex& lanes, int lane) {
+    int numLanes = lanes.getNumLanes();
+    for (int distance = 1; distance <= numLanes / 2; ++distance) {
+        for (int direction = 1; direction >= -1; direction -= 2) {
+            int candidate = (lane + direction * distance + numLanes) % numLanes;
+            const LaneIndex::Entry* enemy = lanes.findNearest(candidate);
+            if (enemy && enemy->depth <= Enemy::kEdgeDepth) {
+                return candidate;
+            }
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+PlayerInput getAutopilotInput(const Simulation& simulation, std::uint64_t tick) {
+    PlayerInput input;
+    input.left = (tick / 90) % 2 == 0 && tick % 6 < 2;
+    input.right = (tick / 90) % 2 == 1 && tick % 6 < 2;
+    input.fire = true;
+    input.spin = 0;
+    
+    const LaneIndex& lanes = simulation.getEnemyManager().getLaneIndex();
+    const Player& player = simulation.getPlayer();
+    int lane = player.getPosition();
+    int numLanes = lanes.getNumLanes();
+    const LaneIndex::Entry* threat = lanes.findNearest(lane);
+    int target = lanes.findNearestEmpty(lane);
+    int rimLane = findNearestRimLane(lanes, lane);
+    if (threat && threat->depth < 0.2f && target >= 0) {
+        int clockwise = (target - lane + numLanes) % numLanes;
+        input.right = clockwise > 0 && clockwise <= numLanes / 2;
+        input.left = clockwise > numLanes / 2;
+    } else if (rimLane >= 0) {
+        // Enemies on the rim stay there, so the level can't end until they
+        // are shot: step into their lane a lane at a time, and take the last
+        // step only with a shot ready, which then hits before they do
+        int clockwise = (rimLane - lane + numLanes) % numLanes;
+        bool adjacent = clockwise == 1 || clockwise == numLanes - 1;
+        input.left = false;
+        input.right = false;
+        input.fire = !adjacent || player.isShotReady();
+        if (input.fire) {
+            input.spin = clockwise <= numLanes / 2 ? Player::kSpinUnitsPerLane : -Player::kSpinUnitsPerLane;
+        }
+    }
+    
+    input.superzapper = false;
+    input.confirm = simulation.getState() != GameState::PLAYING;
+    return input;
+}
+
+} // namespace tempest
@@ -0,0 +1,15 @@
+#include "EmbeddedAssets.hpp"
+
+namespace tempest {
+
+const EmbeddedAsset* findEmbeddedAsset(const std::string& name) {
+    const EmbeddedAsset* assets = getEmbeddedAssets();
+    for (std::size_t i = 0; i < getEmbeddedAssetCount(); ++i) {
+        if (name == assets[i].name) {
+            return &assets[i];
+        }
+    }
+    return nullptr;
+}
+
+} // namespace tempest
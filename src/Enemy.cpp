@@ -1,140 +1,94 @@
 #include "Enemy.hpp"
+#include <array>
 #include <cmath>
-#include <random>
+#include <utility>
+#include "EnemyTraits.hpp"
+#include "Layout.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "StateHash.hpp"
+#include "StateStream.hpp"
 
 namespace tempest {
 
-Enemy::Enemy(Type type, int lane, Playfield& playfield)
+namespace {
+
+template <Enemy::Type T>
+constexpr EnemyTypeInfo makeEnemyTypeInfo() {
+    return EnemyTypeInfo{
+        EnemyTraits<T>::kSpeed,
+        EnemyTraits<T>::kRadius,
+        EnemyTraits<T>::kRotationRate,
+        EnemyTraits<T>::kScore,
+        EnemyTraits<T>::kExplosionParticles,
+        EnemyTraits<T>::kExplosionSpeed,
+        EnemyTraits<T>::kPulsePeriod,
+        EnemyTraits<T>::kElectrifyReach,
+        EnemyTraits<T>::kSplitCount,
+        EnemyTraits<T>::kSplitType,
+        &EnemyTraits<T>::createShape,
+        &EnemyTraits<T>::pulseColor
+    };
+}
+
+template <std::size_t... Types>
+constexpr std::array<EnemyTypeInfo, Enemy::kTypeCount> makeEnemyTypeTable(std::index_sequence<Types...>) {
+    return {{ makeEnemyTypeInfo<static_cast<Enemy::Type>(Types)>()... }};
+}
+
+constexpr std::array<EnemyTypeInfo, Enemy::kTypeCount> kEnemyTypeTable =
+    makeEnemyTypeTable(std::make_index_sequence<Enemy::kTypeCount>());
+
+} // namespace
+
+const EnemyTypeInfo& getEnemyTypeInfo(Enemy::Type type) {
+    return kEnemyTypeTable[static_cast<std::size_t>(type)];
+}
+
+Enemy::Enemy(Type type, int lane, Playfield& playfield, LevelArena* arena, float depth)
     : m_type(type)
     , m_lane(lane)
-    , m_depth(1.0f) // Start at the inner edge
+    , m_depth(depth)
     , m_speed(0.0f)
     , m_playfield(&playfield)
     , m_radius(0.0f)
+    , m_scale(1.0f)
     , m_destroyed(false)
+    , m_arena(arena)
+    , m_shapes(ArenaAllocator<ArenaPtr<sf::Shape>>(arena))
     , m_rotationAngle(0.0f)
-    , m_pulseTimer(0.0f)
-    , m_pulseState(false)
+    , m_nextLaneChange(0)
+    , m_hashKey(~0ULL) // No enemy packs to this
+    , m_hashTerm(0)
 {
     // Set properties based on enemy type
-    switch (m_type) {
-        case Type::FLIPPER:
-            m_speed = 0.15f;
-            m_radius = 10.0f;
-            createFlipperShape();
-            break;
-            
-        case Type::TANKER:
-            m_speed = 0.1f;
-            m_radius = 12.0f;
-            createTankerShape();
-            break;
-            
-        case Type::SPIKER:
-            m_speed = 0.12f;
-            m_radius = 10.0f;
-            createSpikerShape();
-            break;
-            
-        case Type::FUSEBALL:
-            m_speed = 0.2f;
-            m_radius = 8.0f;
-            createFuseballShape();
-            break;
-            
-        case Type::PULSAR:
-            m_speed = 0.08f;
-            m_radius = 10.0f;
-            createPulsarShape();
-            break;
-            
-        default:
-            m_speed = 0.1f;
-            m_radius = 8.0f;
-            createFlipperShape();
-            break;
-    }
+    const EnemyTypeInfo& info = getEnemyTypeInfo(m_type);
+    m_speed = info.speed;
+    m_radius = info.radius * layout::kPixel;
+    info.createShape(*this);
     
     updatePosition();
 }
 
-void Enemy::update(float deltaTime) {
+void Enemy::draw(sf::RenderTarget& target) {
     if (!m_destroyed) {
-        // Move toward the outer edge
-        m_depth -= m_speed * deltaTime;
-        
-        // Clamp depth between 0 and 1
-        m_depth = std::max(0.0f, std::min(1.0f, m_depth));
-        
-        // Update position
-        updatePosition();
-        
-        // Special behavior based on enemy type
-        switch (m_type) {
-            case Type::FLIPPER:
-                // Rotate the flipper
-                m_rotationAngle += 180.0f * deltaTime; // 180 degrees per second
-                if (m_rotationAngle >= 360.0f) {
-                    m_rotationAngle -= 360.0f;
-                }
-                
-                // Occasionally change lanes
-                if (rand() % 100 < 1) {
-                    m_lane = (m_lane + (rand() % 2 == 0 ? 1 : -1)) % m_playfield->getNumSegments();
-                    if (m_lane < 0) m_lane += m_playfield->getNumSegments();
-                }
-                break;
-                
-            case Type::FUSEBALL:
-                // Rotate the fuseball
-                m_rotationAngle += 360.0f * deltaTime; // 360 degrees per second
-                if (m_rotationAngle >= 360.0f) {
-                    m_rotationAngle -= 360.0f;
-                }
-                
-                // Move faster and bounce between lanes
-                if (rand() % 100 < 5) {
-                    m_lane = (m_lane + (rand() % 3 - 1)) % m_playfield->getNumSegments();
-                    if (m_lane < 0) m_lane += m_playfield->getNumSegments();
-                }
-                break;
-                
-            case Type::PULSAR:
-                // Update pulse effect
-                m_pulseTimer += deltaTime;
-                if (m_pulseTimer >= 0.5f) { // Pulse every 0.5 seconds
-                    m_pulseTimer = 0.0f;
-                    m_pulseState = !m_pulseState;
-                    
-                    // Update color based on pulse state
-                    if (m_pulseState) {
-                        for (auto& shape : m_shapes) {
-                            shape->setFillColor(sf::Color::Yellow);
-                        }
-                    } else {
-                        for (auto& shape : m_shapes) {
-                            shape->setFillColor(sf::Color::Green);
-                        }
-                    }
-                }
-                break;
-                
-            default:
-                break;
+        for (auto& shape : m_shapes) {
+            target.draw(*shape);
         }
     }
 }
 
-void Enemy::draw(sf::RenderWindow& window) {
+void Enemy::draw(SoftwareRasterizer& rasterizer) const {
     if (!m_destroyed) {
-        for (auto& shape : m_shapes) {
-            window.draw(*shape);
+        for (const auto& shape : m_shapes) {
+            rasterizer.draw(*shape);
         }
     }
 }
 
+const float Enemy::kEdgeDepth = 0.05f;
+
 bool Enemy::isAtEdge() const {
-    return m_depth <= 0.05f;
+    return m_depth <= kEdgeDepth;
 }
 
 bool Enemy::isDestroyed() const {
@@ -146,7 +100,19 @@ const sf::Vector2f& Enemy::getPosition() const {
 }
 
 float Enemy::getRadius() const {
-    return m_radius;
+    return m_radius * m_scale;
+}
+
+float Enemy::getDepth() const {
+    return m_depth;
+}
+
+float Enemy::getSpeed() const {
+    return m_speed;
+}
+
+float Enemy::getRotation() const {
+    return m_rotationAngle;
 }
 
 int Enemy::getLane() const {
@@ -161,18 +127,80 @@ void Enemy::destroy() {
     m_destroyed = true;
 }
 
+std::uint64_t Enemy::rehash() {
+    // Most ticks an enemy stays within its depth step, and this is a compare
+    std::uint64_t key = static_cast<std::uint64_t>(m_type) | (m_destroyed ? 0x100ULL : 0) |
+                        (static_cast<std::uint64_t>(static_cast<std::uint32_t>(m_lane)) << 16) |
+                        (static_cast<std::uint64_t>(statehash::quantizeDepth(m_depth)) << 48);
+    if (key == m_hashKey) {
+        return 0;
+    }
+    
+    std::uint64_t term = statehash::term(statehash::TAG_ENEMY, key);
+    std::uint64_t change = term - m_hashTerm;
+    m_hashKey = key;
+    m_hashTerm = term;
+    return change;
+}
+
+std::uint64_t Enemy::getHashTerm() const {
+    return m_hashTerm;
+}
+
+void Enemy::setColor(const sf::Color& color) {
+    for (auto& shape : m_shapes) {
+        shape->setFillColor(color);
+    }
+}
+
+void Enemy::saveState(StateWriter& out) const {
+    out.writeInt(m_lane);
+    out.writeFloat(m_depth);
+    out.writeFloat(m_speed);
+    out.writeFloat(m_position.x);
+    out.writeFloat(m_position.y);
+    out.writeFloat(m_radius);
+    out.writeFloat(m_scale);
+    out.writeBool(m_destroyed);
+    out.writeFloat(m_rotationAngle);
+    out.writeU64(m_nextLaneChange);
+}
+
+void Enemy::loadState(StateReader& in) {
+    // Position and scale are kept as computed by the kinematics pass rather
+    // than recomputed, which could differ in the last bit
+    m_lane = in.readInt();
+    m_depth = in.readFloat();
+    m_speed = in.readFloat();
+    m_position.x = in.readFloat();
+    m_position.y = in.readFloat();
+    m_radius = in.readFloat();
+    m_scale = in.readFloat();
+    m_destroyed = in.readBool();
+    m_rotationAngle = in.readFloat();
+    m_nextLaneChange = in.readU64();
+    updateShapes(getEnemyTypeInfo(m_type).rotationRate > 0.0f);
+}
+
 void Enemy::updatePosition() {
     if (m_playfield) {
         m_position = m_playfield->getPointPosition(m_lane, m_depth);
+        m_scale = m_playfield->getDepthScale(m_depth);
+        updateShapes(getEnemyTypeInfo(m_type).rotationRate > 0.0f);
+    }
+}
+
+void Enemy::updateShapes(bool rotate) {
+    // Update all shapes' positions and perspective size; the outlines are
+    // drawn in design pixels
+    const float scale = m_scale * layout::kPixel;
+    for (auto& shape : m_shapes) {
+        shape->setPosition(m_position);
+        shape->setScale(scale, scale);
         
-        // Update all shapes' positions
-        for (auto& shape : m_shapes) {
-            shape->setPosition(m_position);
-            
-            // Apply rotation for certain enemy types
-            if (m_type == Type::FLIPPER || m_type == Type::FUSEBALL) {
-                shape->setRotation(m_rotationAngle);
-            }
+        // Apply rotation for spinning enemy types
+        if (rotate) {
+            shape->setRotation(m_rotationAngle);
         }
     }
 }
@@ -180,9 +208,10 @@ void Enemy::updatePosition() {
 void Enemy::createFlipperShape() {
     // Clear any existing shapes
     m_shapes.clear();
+    m_shapes.reserve(1);
     
     // Create bow-tie/chevron shape
-    auto flipper = std::make_unique<sf::ConvexShape>();
+    auto flipper = makeInArena<sf::ConvexShape>(m_arena);
     flipper->setPointCount(4);
     flipper->setPoint(0, sf::Vector2f(-10, -5));
     flipper->setPoint(1, sf::Vector2f(0, 0));
@@ -197,9 +226,10 @@ void Enemy::createFlipperShape() {
 void Enemy::createTankerShape() {
     // Clear any existing shapes
     m_shapes.clear();
+    m_shapes.reserve(1);
     
     // Create diamond/rhomboid shape
-    auto tanker = std::make_unique<sf::ConvexShape>();
+    auto tanker = makeInArena<sf::ConvexShape>(m_arena);
     tanker->setPointCount(4);
     tanker->setPoint(0, sf::Vector2f(0, -12));
     tanker->setPoint(1, sf::Vector2f(12, 0));
@@ -214,9 +244,10 @@ void Enemy::createTankerShape() {
 void Enemy::createSpikerShape() {
     // Clear any existing shapes
     m_shapes.clear();
+    m_shapes.reserve(4);
     
     // Create spiral shape with spikes
-    auto spiker = std::make_unique<sf::ConvexShape>();
+    auto spiker = makeInArena<sf::ConvexShape>(m_arena);
     spiker->setPointCount(8);
     
     // Create a star-like shape for the spiker
@@ -236,7 +267,7 @@ void Enemy::createSpikerShape() {
     
     // Add a trail of spikes
     for (int i = 1; i <= 3; i++) {
-        auto spike = std::make_unique<sf::CircleShape>(2.0f);
+        auto spike = makeInArena<sf::CircleShape>(m_arena, 2.0f);
         spike->setFillColor(sf::Color::Cyan);
         spike->setOrigin(2.0f, 2.0f);
         m_shapes.push_back(std::move(spike));
@@ -246,9 +277,10 @@ void Enemy::createSpikerShape() {
 void Enemy::createFuseballShape() {
     // Clear any existing shapes
     m_shapes.clear();
+    m_shapes.reserve(9);
     
     // Create central sphere
-    auto center = std::make_unique<sf::CircleShape>(8.0f);
+    auto center = makeInArena<sf::CircleShape>(m_arena, 8.0f);
     center->setFillColor(sf::Color(255, 165, 0)); // Orange
     center->setOrigin(8.0f, 8.0f);
     
@@ -256,7 +288,7 @@ void Enemy::createFuseballShape() {
     
     // Add tendrils
     for (int i = 0; i < 8; i++) {
-        auto tendril = std::make_unique<sf::RectangleShape>(sf::Vector2f(8.0f, 1.0f));
+        auto tendril = makeInArena<sf::RectangleShape>(m_arena, sf::Vector2f(8.0f, 1.0f));
         tendril->setFillColor(sf::Color(255, 165, 0)); // Orange
         tendril->setOrigin(0, 0.5f);
         tendril->setRotation(i * 45.0f);
@@ -268,9 +300,10 @@ void Enemy::createFuseballShape() {
 void Enemy::createPulsarShape() {
     // Clear any existing shapes
     m_shapes.clear();
+    m_shapes.reserve(1);
     
     // Create wavy line shape
-    auto pulsar = std::make_unique<sf::ConvexShape>();
+    auto pulsar = makeInArena<sf::ConvexShape>(m_arena);
     pulsar->setPointCount(8);
     
     // Create a wavy circle
@@ -0,0 +1,331 @@
+#include "EnemyKinematics.hpp"
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TEMPEST_KINEMATICS_X86_DISPATCH 1
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEMPEST_KINEMATICS_SSE2 1
+#endif
+
+#if defined(TEMPEST_KINEMATICS_X86_DISPATCH) && defined(__SSE2__)
+#define TEMPEST_KINEMATICS_SSE2 1
+#endif
+
+namespace tempest {
+
+namespace {
+
+struct KinematicsBatch {
+    float* depth;
+    const float* speed;
+    const std::int32_t* lane;
+    float* x;
+    float* y;
+    std::size_t count;
+};
+
+struct LaneColumns {
+    const float* x;      // Projected points, lane * stride + bucket
+    const float* y;
+    std::int32_t stride;
+};
+
+typedef std::size_t (*AdvanceKernel)(const KinematicsBatch&, const LaneColumns&, float);
+
+const float kBuckets = static_cast<float>(Playfield::LaneTable::kDepthBuckets);
+
+// Handles entries [begin, count); the vector kernels use it for their tail.
+// The projected point is lerped between the two depth buckets around the
+// enemy; at depth 1 the bucket is the last one and the weight is exactly 0.
+void advanceScalar(const KinematicsBatch& batch, const LaneColumns& lanes,
+                   float deltaTime, std::size_t begin) {
+    for (std::size_t i = begin; i < batch.count; ++i) {
+        float depth = batch.depth[i] - batch.speed[i] * deltaTime;
+        depth = std::max(0.0f, std::min(1.0f, depth));
+        batch.depth[i] = depth;
+        
+        float bucket = depth * kBuckets;
+        std::int32_t whole = static_cast<std::int32_t>(bucket);
+        float t = bucket - static_cast<float>(whole);
+        std::int32_t index = batch.lane[i] * lanes.stride + whole;
+        
+        batch.x[i] = lanes.x[index] + (lanes.x[index + 1] - lanes.x[index]) * t;
+        batch.y[i] = lanes.y[index] + (lanes.y[index + 1] - lanes.y[index]) * t;
+    }
+}
+
+// The fixed-point path: integer depth, then the bucket and lerp weight
+// straight from its bits. The positions are only drawn, so their rounding
+// doesn't matter.
+void advanceFixed(const KinematicsBatch& batch, Fixed* fixedDepth, const Fixed* fixedSpeed,
+                  const LaneColumns& lanes, Fixed deltaTime) {
+    const int bucketShift = fixed::kFractionBits;
+    for (std::size_t i = 0; i < batch.count; ++i) {
+        Fixed depth = fixedDepth[i] - fixed::mul(fixedSpeed[i], deltaTime);
+        depth = std::max<Fixed>(0, std::min(fixed::kOne, depth));
+        fixedDepth[i] = depth;
+        batch.depth[i] = fixed::toFloat(depth);
+        
+        std::int64_t scaled = static_cast<std::int64_t>(depth) * Playfield::LaneTable::kDepthBuckets;
+        std::int32_t whole = static_cast<std::int32_t>(scaled >> bucketShift);
+        float t = fixed::toFloat(static_cast<Fixed>(scaled - (static_cast<std::int64_t>(whole) << bucketShift)));
+        std::int32_t index = batch.lane[i] * lanes.stride + whole;
+        
+        batch.x[i] = lanes.x[index] + (lanes.x[index + 1] - lanes.x[index]) * t;
+        batch.y[i] = lanes.y[index] + (lanes.y[index + 1] - lanes.y[index]) * t;
+    }
+}
+
+#if defined(TEMPEST_KINEMATICS_SSE2)
+std::size_t advanceSse2(const KinematicsBatch& batch, const LaneColumns& lanes, float deltaTime) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 buckets = _mm_set1_ps(kBuckets);
+
+    std::size_t end = batch.count & ~static_cast<std::size_t>(3);
+    for (std::size_t i = 0; i < end; i += 4) {
+        __m128 depth = _mm_loadu_ps(batch.depth + i);
+        depth = _mm_sub_ps(depth, _mm_mul_ps(_mm_loadu_ps(batch.speed + i), dt));
+        depth = _mm_max_ps(zero, _mm_min_ps(one, depth));
+        _mm_storeu_ps(batch.depth + i, depth);
+
+        __m128 bucket = _mm_mul_ps(depth, buckets);
+        __m128i whole = _mm_cvttps_epi32(bucket);
+        __m128 t = _mm_sub_ps(bucket, _mm_cvtepi32_ps(whole));
+
+        // No 32-bit multiply or gather before SSE4.1/AVX2, so build the
+        // indices and assemble the table columns by hand
+        alignas(16) std::int32_t wholes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(wholes), whole);
+        std::int32_t index[4];
+        for (int k = 0; k < 4; ++k) {
+            index[k] = batch.lane[i + k] * lanes.stride + wholes[k];
+        }
+
+        __m128 x0 = _mm_setr_ps(lanes.x[index[0]], lanes.x[index[1]],
+                                lanes.x[index[2]], lanes.x[index[3]]);
+        __m128 x1 = _mm_setr_ps(lanes.x[index[0] + 1], lanes.x[index[1] + 1],
+                                lanes.x[index[2] + 1], lanes.x[index[3] + 1]);
+        __m128 y0 = _mm_setr_ps(lanes.y[index[0]], lanes.y[index[1]],
+                                lanes.y[index[2]], lanes.y[index[3]]);
+        __m128 y1 = _mm_setr_ps(lanes.y[index[0] + 1], lanes.y[index[1] + 1],
+                                lanes.y[index[2] + 1], lanes.y[index[3] + 1]);
+
+        _mm_storeu_ps(batch.x + i, _mm_add_ps(x0, _mm_mul_ps(_mm_sub_ps(x1, x0), t)));
+        _mm_storeu_ps(batch.y + i, _mm_add_ps(y0, _mm_mul_ps(_mm_sub_ps(y1, y0), t)));
+    }
+    return end;
+}
+#else
+std::size_t advanceNone(const KinematicsBatch&, const LaneColumns&, float) {
+    return 0;
+}
+#endif
+
+#if defined(TEMPEST_KINEMATICS_X86_DISPATCH)
+__attribute__((target("avx2")))
+std::size_t advanceAvx2(const KinematicsBatch& batch, const LaneColumns& lanes, float deltaTime) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 buckets = _mm256_set1_ps(kBuckets);
+    const __m256i stride = _mm256_set1_epi32(lanes.stride);
+
+    std::size_t end = batch.count & ~static_cast<std::size_t>(7);
+    for (std::size_t i = 0; i < end; i += 8) {
+        __m256 depth = _mm256_loadu_ps(batch.depth + i);
+        depth = _mm256_sub_ps(depth, _mm256_mul_ps(_mm256_loadu_ps(batch.speed + i), dt));
+        depth = _mm256_max_ps(zero, _mm256_min_ps(one, depth));
+        _mm256_storeu_ps(batch.depth + i, depth);
+
+        __m256 bucket = _mm256_mul_ps(depth, buckets);
+        __m256i whole = _mm256_cvttps_epi32(bucket);
+        __m256 t = _mm256_sub_ps(bucket, _mm256_cvtepi32_ps(whole));
+
+        __m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.lane + i));
+        __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(lane, stride), whole);
+        __m256 x0 = _mm256_i32gather_ps(lanes.x, index, 4);
+        __m256 x1 = _mm256_i32gather_ps(lanes.x + 1, index, 4);
+        __m256 y0 = _mm256_i32gather_ps(lanes.y, index, 4);
+        __m256 y1 = _mm256_i32gather_ps(lanes.y + 1, index, 4);
+
+        // Kept as separate mul/add (no FMA) to round exactly like the scalar path
+        _mm256_storeu_ps(batch.x + i, _mm256_add_ps(x0, _mm256_mul_ps(_mm256_sub_ps(x1, x0), t)));
+        _mm256_storeu_ps(batch.y + i, _mm256_add_ps(y0, _mm256_mul_ps(_mm256_sub_ps(y1, y0), t)));
+    }
+    return end;
+}
+
+__attribute__((target("avx512f")))
+std::size_t advanceAvx512(const KinematicsBatch& batch, const LaneColumns& lanes, float deltaTime) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 dt = _mm512_set1_ps(deltaTime);
+    const __m512 buckets = _mm512_set1_ps(kBuckets);
+    const __m512i stride = _mm512_set1_epi32(lanes.stride);
+
+    std::size_t end = batch.count & ~static_cast<std::size_t>(15);
+    for (std::size_t i = 0; i < end; i += 16) {
+        __m512 depth = _mm512_loadu_ps(batch.depth + i);
+        depth = _mm512_sub_ps(depth, _mm512_mul_ps(_mm512_loadu_ps(batch.speed + i), dt));
+        depth = _mm512_max_ps(zero, _mm512_min_ps(one, depth));
+        _mm512_storeu_ps(batch.depth + i, depth);
+
+        __m512 bucket = _mm512_mul_ps(depth, buckets);
+        __m512i whole = _mm512_cvttps_epi32(bucket);
+        __m512 t = _mm512_sub_ps(bucket, _mm512_cvtepi32_ps(whole));
+
+        __m512i lane = _mm512_loadu_si512(batch.lane + i);
+        __m512i index = _mm512_add_epi32(_mm512_mullo_epi32(lane, stride), whole);
+        __m512 x0 = _mm512_i32gather_ps(index, lanes.x, 4);
+        __m512 x1 = _mm512_i32gather_ps(index, lanes.x + 1, 4);
+        __m512 y0 = _mm512_i32gather_ps(index, lanes.y, 4);
+        __m512 y1 = _mm512_i32gather_ps(index, lanes.y + 1, 4);
+
+        _mm512_storeu_ps(batch.x + i, _mm512_add_ps(x0, _mm512_mul_ps(_mm512_sub_ps(x1, x0), t)));
+        _mm512_storeu_ps(batch.y + i, _mm512_add_ps(y0, _mm512_mul_ps(_mm512_sub_ps(y1, y0), t)));
+    }
+    return end;
+}
+#endif
+
+struct KernelChoice {
+    AdvanceKernel kernel;
+    const char* name;
+};
+
+KernelChoice selectKernel() {
+#if defined(TEMPEST_KINEMATICS_X86_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return KernelChoice{advanceAvx512, "avx512"};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return KernelChoice{advanceAvx2, "avx2"};
+    }
+#endif
+#if defined(TEMPEST_KINEMATICS_SSE2)
+    return KernelChoice{advanceSse2, "sse2"};
+#else
+    return KernelChoice{advanceNone, "scalar"};
+#endif
+}
+
+const KernelChoice& getKernel() {
+    static const KernelChoice choice = selectKernel();
+    return choice;
+}
+
+} // namespace
+
+EnemyKinematics::EnemyKinematics()
+    : m_arithmetic(Arithmetic::FLOAT)
+{
+}
+
+EnemyKinematics::EnemyKinematics(LevelArena& arena, Arithmetic arithmetic)
+    : m_arithmetic(arithmetic)
+    , m_depth(ArenaAllocator<float>(&arena))
+    , m_speed(ArenaAllocator<float>(&arena))
+    , m_lane(ArenaAllocator<std::int32_t>(&arena))
+    , m_x(ArenaAllocator<float>(&arena))
+    , m_y(ArenaAllocator<float>(&arena))
+    , m_fixedDepth(ArenaAllocator<Fixed>(&arena))
+    , m_fixedSpeed(ArenaAllocator<Fixed>(&arena))
+{
+}
+
+std::size_t EnemyKinematics::add(int lane, float depth, float speed) {
+    // Depths in fixed-point mode came from Fixed values, so this is exact
+    m_depth.push_back(depth);
+    m_speed.push_back(speed);
+    m_lane.push_back(lane);
+    m_x.push_back(0.0f);
+    m_y.push_back(0.0f);
+    m_fixedDepth.push_back(fixed::fromFloat(depth));
+    m_fixedSpeed.push_back(fixed::fromFloat(speed));
+    return m_depth.size() - 1;
+}
+
+void EnemyKinematics::removeSwap(std::size_t index) {
+    std::size_t last = m_depth.size() - 1;
+    if (index != last) {
+        m_depth[index] = m_depth[last];
+        m_speed[index] = m_speed[last];
+        m_lane[index] = m_lane[last];
+        m_x[index] = m_x[last];
+        m_y[index] = m_y[last];
+        m_fixedDepth[index] = m_fixedDepth[last];
+        m_fixedSpeed[index] = m_fixedSpeed[last];
+    }
+
+    m_depth.pop_back();
+    m_speed.pop_back();
+    m_lane.pop_back();
+    m_x.pop_back();
+    m_y.pop_back();
+    m_fixedDepth.pop_back();
+    m_fixedSpeed.pop_back();
+}
+
+void EnemyKinematics::clear() {
+    m_depth.clear();
+    m_speed.clear();
+    m_lane.clear();
+    m_x.clear();
+    m_y.clear();
+    m_fixedDepth.clear();
+    m_fixedSpeed.clear();
+}
+
+void EnemyKinematics::reserve(std::size_t capacity) {
+    m_depth.reserve(capacity);
+    m_speed.reserve(capacity);
+    m_lane.reserve(capacity);
+    m_x.reserve(capacity);
+    m_y.reserve(capacity);
+    m_fixedDepth.reserve(capacity);
+    m_fixedSpeed.reserve(capacity);
+}
+
+std::size_t EnemyKinematics::size() const {
+    return m_depth.size();
+}
+
+void EnemyKinematics::setLane(std::size_t index, int lane) {
+    m_lane[index] = lane;
+}
+
+float EnemyKinematics::getDepth(std::size_t index) const {
+    return m_depth[index];
+}
+
+sf::Vector2f EnemyKinematics::getPosition(std::size_t index) const {
+    return sf::Vector2f(m_x[index], m_y[index]);
+}
+
+void EnemyKinematics::advance(float deltaTime, const Playfield::LaneTable& lanes) {
+    KinematicsBatch batch = {
+        m_depth.data(), m_speed.data(), m_lane.data(), m_x.data(), m_y.data(), m_depth.size()
+    };
+    LaneColumns columns = {
+        lanes.x.data(), lanes.y.data(), Playfield::LaneTable::kStride
+    };
+
+    if (m_arithmetic == Arithmetic::FIXED_POINT) {
+        advanceFixed(batch, m_fixedDepth.data(), m_fixedSpeed.data(), columns, fixed::fromFloat(deltaTime));
+        return;
+    }
+
+    std::size_t done = getKernel().kernel(batch, columns, deltaTime);
+    advanceScalar(batch, columns, deltaTime, done);
+}
+
+const char* EnemyKinematics::getKernelName() {
+    return getKernel().name;
+}
+
+} // namespace tempest
@@ -1,87 +1,500 @@
 #include "EnemyManager.hpp"
-#include <cstdlib>
+#include <algorithm>
 #include <ctime>
+#include "EnemyTraits.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "StateHash.hpp"
+#include "StateStream.hpp"
 
 namespace tempest {
 
+namespace {
+
+const float kSpikeErosion = 0.05f; // Spike height one shot takes off
+
+} // namespace
+
 EnemyManager::EnemyManager()
     : m_playfield(nullptr)
-    , m_spawnTimer(0.0f)
-    , m_spawnRate(0.5f)  // Enemies per second
+    , m_arena(nullptr)
+    , m_arithmetic(Arithmetic::FLOAT)
+    , m_generation(0)
+    , m_tick(0)
+    , m_pulseStates()
+    , m_electrifiedLanes(0)
     , m_enemySpeed(1.0f)
 {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
 }
 
 EnemyManager::EnemyManager(Playfield& playfield)
     : m_playfield(&playfield)
-    , m_spawnTimer(0.0f)
-    , m_spawnRate(0.5f)  // Enemies per second
+    , m_arena(nullptr)
+    , m_arithmetic(Arithmetic::FLOAT)
+    , m_generation(0)
+    , m_laneIndex(playfield.getNumSegments())
+    , m_random(static_cast<std::uint64_t>(std::time(nullptr)))
+    , m_tick(0)
+    , m_pulseStates()
+    , m_spikeHeights(playfield.getNumSegments(), 0.0f)
+    , m_electrifiedLanes(0)
+    , m_enemySpeed(1.0f)
+{
+}
+
+EnemyManager::EnemyManager(Playfield& playfield, LevelArena& arena, std::uint64_t seed,
+                           Arithmetic arithmetic)
+    : m_playfield(&playfield)
+    , m_arena(&arena)
+    , m_arithmetic(arithmetic)
+    , m_generation(0)
+    , m_laneIndex(playfield.getNumSegments(), &arena)
+    , m_random(seed)
+    , m_tick(0)
+    , m_pulseStates()
+    , m_pendingSpawns(ArenaAllocator<PendingSpawn>(&arena))
+    , m_spikeHeights(playfield.getNumSegments(), 0.0f, ArenaAllocator<float>(&arena))
+    , m_electrifiedLanes(0)
+    , m_laneEffects(ArenaAllocator<sf::Vertex>(&arena))
     , m_enemySpeed(1.0f)
 {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
+    // Enough for a busy level without regrowing the pools mid-play
+    for (auto& pool : m_pools) {
+        pool = EnemyPool(arena, arithmetic);
+        pool.enemies.reserve(32);
+        pool.kinematics.reserve(32);
+    }
+    m_pendingSpawns.reserve(8);
+    m_laneEffects.reserve(4 * m_spikeHeights.size()); // A spike and a lit lane each
+}
+
+void EnemyManager::update(float deltaTime, int playerLane) {
+    m_tick++;
+    
+    // Remove destroyed enemies
+    for (auto& pool : m_pools) {
+        retireStalePool(pool);
+        removeDestroyedEnemies(pool);
+    }
+    
+    // Children of enemies shot last tick appear where their parent was
+    for (const auto& spawn : m_pendingSpawns) {
+        spawnEnemy(spawn.type, spawn.lane, spawn.depth);
+    }
+    m_pendingSpawns.clear();
+    
+    // Run the per-type systems over their pools
+    if (m_playfield) {
+        EnemyContext context = {
+            *m_playfield, m_random, deltaTime, m_tick, playerLane, m_spikeHeights.data(), m_arithmetic};
+        updateEnemySystems(m_pools, context);
+    }
+    
+    refreshLaneIndex();
+    refreshLaneEffects();
+}
+
+void EnemyManager::draw(sf::RenderTarget& target) {
+    if (!m_laneEffects.empty()) {
+        target.draw(m_laneEffects.data(), m_laneEffects.size(), sf::Lines);
+    }
+    forEachEnemy([&target](Enemy& enemy) {
+        enemy.draw(target);
+    });
+}
+
+void EnemyManager::draw(SoftwareRasterizer& rasterizer) const {
+    if (!m_laneEffects.empty()) {
+        rasterizer.draw(m_laneEffects.data(), m_laneEffects.size(), sf::Lines);
+    }
+    forEachEnemy([&rasterizer](const Enemy& enemy) {
+        enemy.draw(rasterizer);
+    });
 }
 
-void EnemyManager::update(float deltaTime) {
-    // Update existing enemies
-    for (auto it = m_enemies.begin(); it != m_enemies.end();) {
-        it->update(deltaTime);
+void EnemyManager::spawnEnemy(Enemy::Type type, int lane, float depth) {
+    if (m_playfield) {
+        EnemyPool& pool = m_pools[static_cast<int>(type)];
+        retireStalePool(pool);
+        pool.enemies.emplace_back(type, lane, *m_playfield, m_arena, depth);
+        pool.liveCount++;
         
-        // Remove destroyed enemies
-        if (it->isDestroyed()) {
-            it = m_enemies.erase(it);
-        } else {
-            ++it;
+        Enemy& enemy = pool.enemies.back();
+        pool.hash += enemy.rehash();
+        pool.kinematics.add(enemy.getLane(), enemy.getDepth(), enemy.getSpeed());
+        m_laneIndex.add(getHandle(enemy), enemy.getLane(), enemy.getDepth());
+        
+        // Join the type's current pulse
+        const EnemyTypeInfo& info = getEnemyTypeInfo(type);
+        if (info.pulsePeriod > 0.0f) {
+            enemy.setColor(info.pulseColor(m_pulseStates[static_cast<int>(type)]));
         }
     }
-    
-    // Spawn new enemies
+}
+
+void EnemyManager::spawnRandomEnemy() {
     if (m_playfield) {
-        m_spawnTimer += deltaTime;
+        // Randomly select enemy type
+        Enemy::Type type = static_cast<Enemy::Type>(m_random.nextInt(Enemy::kTypeCount));
         
-        if (m_spawnTimer >= 1.0f / m_spawnRate) {
-            // Randomly select enemy type
-            Enemy::Type type = static_cast<Enemy::Type>(std::rand() % 5);
-            
-            // Randomly select lane
-            int lane = std::rand() % m_playfield->getNumSegments();
-            
-            spawnEnemy(type, lane);
-            m_spawnTimer = 0.0f;
+        // Randomly select lane
+        int lane = m_random.nextInt(m_playfield->getNumSegments());
+        
+        spawnEnemy(type, lane);
+    }
+}
+
+void EnemyManager::clearAllEnemies() {
+    for (auto& pool : m_pools) {
+        pool.enemies.clear();
+        pool.kinematics.clear();
+        pool.liveCount = 0;
+        pool.hash = 0;
+        pool.generation = m_generation;
+    }
+    m_pendingSpawns.clear();
+    m_electrifiedLanes = 0;
+    m_laneIndex.clear();
+}
+
+void EnemyManager::shootEnemy(Enemy& enemy) {
+    if (enemy.isDestroyed() || !m_playfield) {
+        return;
+    }
+    destroyEnemy(enemy);
+    
+    // Children go to alternate sides, one lane further out for each pair
+    const EnemyTypeInfo& info = getEnemyTypeInfo(enemy.getType());
+    const int numLanes = m_playfield->getNumSegments();
+    for (int i = 0; i < info.splitCount; ++i) {
+        int offset = (i / 2 + 1) * (i % 2 == 0 ? -1 : 1);
+        int lane = ((enemy.getLane() + offset) % numLanes + numLanes) % numLanes;
+        m_pendingSpawns.push_back(PendingSpawn{info.splitType, lane, enemy.getDepth()});
+    }
+}
+
+void EnemyManager::pulse(Enemy::Type type) {
+    int index = static_cast<int>(type);
+    m_pulseStates[index] = !m_pulseStates[index];
+    
+    EnemyPool& pool = m_pools[index];
+    if (pool.generation == m_generation) {
+        sf::Color color = getEnemyTypeInfo(type).pulseColor(m_pulseStates[index]);
+        for (auto& enemy : pool.enemies) {
+            enemy.setColor(color);
         }
     }
 }
 
-void EnemyManager::draw(sf::RenderWindow& window) {
-    for (auto& enemy : m_enemies) {
-        enemy.draw(window);
+void EnemyManager::destroyEnemy(Enemy& enemy) {
+    if (!enemy.isDestroyed()) {
+        EnemyPool& pool = m_pools[static_cast<int>(enemy.getType())];
+        enemy.destroy();
+        pool.liveCount--;
+        pool.hash += enemy.rehash();
+        m_laneIndex.remove(getHandle(enemy));
     }
 }
 
-void EnemyManager::spawnEnemy(Enemy::Type type, int lane) {
-    if (m_playfield) {
-        m_enemies.emplace_back(type, lane, *m_playfield);
+EnemyManager::KillTally EnemyManager::destroyAllEnemies() {
+    // Touches the pools, never the enemies in them
+    KillTally tally = {{}, 0};
+    for (int type = 0; type < Enemy::kTypeCount; ++type) {
+        EnemyPool& pool = m_pools[type];
+        if (pool.generation == m_generation) {
+            tally.kills[type] = static_cast<int>(pool.liveCount);
+            tally.total += tally.kills[type];
+        }
+        pool.liveCount = 0;
     }
+    
+    // Children waiting to appear go with their parents
+    m_pendingSpawns.clear();
+    m_generation++;
+    m_electrifiedLanes = 0;
+    m_laneIndex.clear();
+    return tally;
 }
 
-void EnemyManager::clearAllEnemies() {
-    m_enemies.clear();
+const Enemy* EnemyManager::destroyRandomEnemy() {
+    std::size_t count = getEnemyCount();
+    if (count == 0) {
+        return nullptr;
+    }
+    
+    // Find the pick-th live enemy; destroyed ones still in the pools are skipped
+    std::size_t pick = static_cast<std::size_t>(m_random.nextInt(static_cast<int>(count)));
+    Enemy* chosen = nullptr;
+    forEachEnemy([&](Enemy& enemy) {
+        if (!chosen && !enemy.isDestroyed() && pick-- == 0) {
+            chosen = &enemy;
+        }
+    });
+    
+    if (chosen) {
+        destroyEnemy(*chosen);
+    }
+    return chosen;
 }
 
 bool EnemyManager::areEnemiesCleared() const {
-    return m_enemies.empty();
+    return getEnemyCount() == 0 && m_pendingSpawns.empty();
+}
+
+std::size_t EnemyManager::getEnemyCount() const {
+    std::size_t count = 0;
+    for (const auto& pool : m_pools) {
+        if (pool.generation == m_generation) {
+            count += pool.liveCount;
+        }
+    }
+    return count;
+}
+
+float EnemyManager::getSpikeHeight(int lane) const {
+    if (lane < 0 || lane >= static_cast<int>(m_spikeHeights.size())) {
+        return 0.0f;
+    }
+    return m_spikeHeights[lane];
+}
+
+bool EnemyManager::erodeSpike(const Shot& shot) {
+    int lane = shot.getLane();
+    float height = getSpikeHeight(lane);
+    if (!m_playfield || height <= 0.0f) {
+        return false;
+    }
+    
+    // Fixed-point heights are whole Fixed values, so this is all integer
+    if (m_arithmetic == Arithmetic::FIXED_POINT) {
+        Fixed tip = fixed::kOne - fixed::fromFloat(height);
+        if (shot.getDepth() < tip) {
+            return false;
+        }
+        Fixed worn = fixed::fromFloat(height) - fixed::fromFloat(kSpikeErosion);
+        m_spikeHeights[lane] = fixed::toFloat(std::max<Fixed>(0, worn));
+        return true;
+    }
+    
+    // Shots fly out from the rim, so compare how far along the lane each is
+    sf::Vector2f rim = m_playfield->getPointPosition(lane, 0.0f);
+    sf::Vector2f toTip = m_playfield->getPointPosition(lane, 1.0f - height) - rim;
+    sf::Vector2f toShot = shot.getPosition() - rim;
+    if (toShot.x * toShot.x + toShot.y * toShot.y < toTip.x * toTip.x + toTip.y * toTip.y) {
+        return false;
+    }
+    
+    m_spikeHeights[lane] = std::max(0.0f, height - kSpikeErosion);
+    return true;
+}
+
+std::uint64_t EnemyManager::getStateHash() const {
+    // Pools killed off in bulk hash as empty, like they count
+    std::uint64_t hash = statehash::term(statehash::TAG_RANDOM, m_random.getState());
+    for (const auto& pool : m_pools) {
+        if (pool.generation == m_generation) {
+            hash += pool.hash;
+        }
+    }
+    return hash;
+}
+
+std::uint64_t EnemyManager::getElectrifiedLanes() const {
+    return m_electrifiedLanes;
+}
+
+bool EnemyManager::isLaneElectrified(int lane) const {
+    return lane >= 0 && lane < LaneIndex::kMaxLanes && ((m_electrifiedLanes >> lane) & 1ULL);
+}
+
+const LaneIndex& EnemyManager::getLaneIndex() const {
+    return m_laneIndex;
 }
 
-const std::vector<Enemy>& EnemyManager::getEnemies() const {
-    return m_enemies;
+Enemy& EnemyManager::getEnemy(EnemyHandle handle) {
+    return m_pools[handle.type].enemies[handle.slot];
 }
 
-void EnemyManager::setSpawnRate(float spawnRate) {
-    m_spawnRate = spawnRate;
+const Enemy& EnemyManager::getEnemy(EnemyHandle handle) const {
+    return m_pools[handle.type].enemies[handle.slot];
 }
 
 void EnemyManager::setEnemySpeed(float speed) {
     m_enemySpeed = speed;
 }
 
+void EnemyManager::saveState(StateWriter& out) const {
+    out.writeU32(m_generation);
+    out.writeU64(m_random.getState());
+    out.writeU64(m_tick);
+    out.writeU64(m_electrifiedLanes);
+    out.writeFloat(m_enemySpeed);
+    for (bool pulse : m_pulseStates) {
+        out.writeBool(pulse);
+    }
+    
+    // Stale pools are as good as empty
+    for (const auto& pool : m_pools) {
+        bool current = pool.generation == m_generation;
+        out.writeU32(pool.generation);
+        out.writeU32(current ? static_cast<std::uint32_t>(pool.enemies.size()) : 0);
+        if (current) {
+            for (const auto& enemy : pool.enemies) {
+                enemy.saveState(out);
+            }
+        }
+    }
+    
+    out.writeU32(static_cast<std::uint32_t>(m_pendingSpawns.size()));
+    for (const auto& spawn : m_pendingSpawns) {
+        out.writeInt(static_cast<int>(spawn.type));
+        out.writeInt(spawn.lane);
+        out.writeFloat(spawn.depth);
+    }
+    
+    out.writeU32(static_cast<std::uint32_t>(m_spikeHeights.size()));
+    for (float height : m_spikeHeights) {
+        out.writeFloat(height);
+    }
+}
+
+void EnemyManager::loadState(StateReader& in) {
+    m_generation = in.readU32();
+    m_random.setState(in.readU64());
+    m_tick = in.readU64();
+    std::uint64_t electrifiedLanes = in.readU64();
+    m_enemySpeed = in.readFloat();
+    for (bool& pulse : m_pulseStates) {
+        pulse = in.readBool();
+    }
+    
+    for (int type = 0; type < Enemy::kTypeCount; ++type) {
+        EnemyPool& pool = m_pools[type];
+        pool.enemies.clear();
+        pool.kinematics.clear();
+        pool.liveCount = 0;
+        pool.hash = 0;
+        pool.generation = in.readU32();
+        
+        std::size_t count = in.readCount(41);
+        const EnemyTypeInfo& info = getEnemyTypeInfo(static_cast<Enemy::Type>(type));
+        for (std::size_t i = 0; i < count && m_playfield; ++i) {
+            pool.enemies.emplace_back(static_cast<Enemy::Type>(type), 0, *m_playfield, m_arena);
+            Enemy& enemy = pool.enemies.back();
+            enemy.loadState(in);
+            if (enemy.getLane() < 0 || enemy.getLane() >= m_playfield->getNumSegments()) {
+                pool.enemies.pop_back();
+                continue;
+            }
+            pool.kinematics.add(enemy.getLane(), enemy.getDepth(), enemy.getSpeed());
+            pool.liveCount += enemy.isDestroyed() ? 0 : 1;
+            pool.hash += enemy.rehash();
+            if (info.pulsePeriod > 0.0f) {
+                enemy.setColor(info.pulseColor(m_pulseStates[type]));
+            }
+        }
+    }
+    
+    m_pendingSpawns.clear();
+    std::size_t spawnCount = in.readCount(12);
+    for (std::size_t i = 0; i < spawnCount; ++i) {
+        int type = in.readInt();
+        int lane = in.readInt();
+        float depth = in.readFloat();
+        if (type >= 0 && type < Enemy::kTypeCount) {
+            m_pendingSpawns.push_back(PendingSpawn{static_cast<Enemy::Type>(type), lane, depth});
+        }
+    }
+    
+    std::size_t laneCount = in.readCount(4);
+    for (std::size_t lane = 0; lane < laneCount; ++lane) {
+        float height = in.readFloat();
+        if (lane < m_spikeHeights.size()) {
+            m_spikeHeights[lane] = height;
+        }
+    }
+    
+    // The index holds only live enemies, as it would after kills patched it
+    m_laneIndex.clear();
+    forEachEnemy([this](Enemy& enemy) {
+        if (!enemy.isDestroyed()) {
+            m_laneIndex.add(getHandle(enemy), enemy.getLane(), enemy.getDepth());
+        }
+    });
+    m_electrifiedLanes = electrifiedLanes;
+    refreshLaneEffects();
+}
+
+void EnemyManager::retireStalePool(EnemyPool& pool) {
+    if (pool.generation != m_generation) {
+        pool.enemies.clear();
+        pool.kinematics.clear();
+        pool.hash = 0;
+        pool.generation = m_generation;
+    }
+}
+
+void EnemyManager::refreshLaneIndex() {
+    // The index holds just the live enemies, and only they can light a lane
+    m_electrifiedLanes = 0;
+    m_laneIndex.update([this](EnemyHandle handle, float& depth) {
+        const Enemy& enemy = getEnemy(handle);
+        depth = enemy.getDepth();
+        
+        // A lit pulse electrifies the lane once the enemy is close enough
+        float reach = getEnemyTypeInfo(enemy.getType()).electrifyReach;
+        if (reach > 0.0f && m_pulseStates[handle.type] && enemy.getDepth() <= reach &&
+            enemy.getLane() < LaneIndex::kMaxLanes) {
+            m_electrifiedLanes |= 1ULL << enemy.getLane();
+        }
+        return enemy.getLane();
+    });
+}
+
+void EnemyManager::refreshLaneEffects() {
+    m_laneEffects.clear();
+    if (!m_playfield) {
+        return;
+    }
+    
+    const sf::Color spikeColor = sf::Color::Green;
+    const sf::Color litColor = getEnemyTypeInfo(Enemy::Type::PULSAR).pulseColor(true);
+    for (int lane = 0; lane < static_cast<int>(m_spikeHeights.size()); ++lane) {
+        // Spikes stand up from the far end
+        if (m_spikeHeights[lane] > 0.0f) {
+            m_laneEffects.emplace_back(m_playfield->getPointPosition(lane, 1.0f), spikeColor);
+            m_laneEffects.emplace_back(
+                m_playfield->getPointPosition(lane, 1.0f - m_spikeHeights[lane]), spikeColor);
+        }
+        if (isLaneElectrified(lane)) {
+            m_laneEffects.emplace_back(m_playfield->getPointPosition(lane, 0.0f), litColor);
+            m_laneEffects.emplace_back(m_playfield->getPointPosition(lane, 1.0f), litColor);
+        }
+    }
+}
+
+EnemyHandle EnemyManager::getHandle(const Enemy& enemy) const {
+    const EnemyPool& pool = m_pools[static_cast<int>(enemy.getType())];
+    return EnemyHandle{static_cast<std::uint16_t>(enemy.getType()),
+                       static_cast<std::uint16_t>(&enemy - pool.enemies.data())};
+}
+
+void EnemyManager::removeDestroyedEnemies(EnemyPool& pool) {
+    // Swap with the last enemy so removal is O(1) and the kinematics arrays
+    // stay in step; draw order is not significant
+    for (std::size_t i = 0; i < pool.enemies.size();) {
+        if (!pool.enemies[i].isDestroyed()) {
+            ++i;
+            continue;
+        }
+        
+        pool.hash -= pool.enemies[i].getHashTerm();
+        if (i + 1 != pool.enemies.size()) {
+            m_laneIndex.relocate(getHandle(pool.enemies.back()), static_cast<std::uint16_t>(i));
+            pool.enemies[i] = std::move(pool.enemies.back());
+        }
+        pool.enemies.pop_back();
+        pool.kinematics.removeSwap(i);
+    }
+}
+
 } // namespace tempest
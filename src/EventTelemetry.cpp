@@ -0,0 +1,60 @@
+#include "EventTelemetry.hpp"
+#include <sstream>
+
+namespace tempest {
+
+EventTelemetry::EventTelemetry()
+    : m_kills()
+    , m_superzapperKills(0)
+    , m_shotsFired(0)
+    , m_playerHits(0)
+    , m_levelsCleared(0)
+    , m_superzappersFired(0)
+{
+}
+
+void EventTelemetry::onEvents(const GameEventQueue& events) {
+    // Superzapper kills are tallied from the zap itself
+    for (const auto& event : events.get<EnemyKilledEvent>()) {
+        if (!event.bySuperzapper) {
+            m_kills[static_cast<int>(event.type)]++;
+        }
+    }
+    for (const auto& event : events.get<SuperzapperFiredEvent>()) {
+        for (int i = 0; i < Enemy::kTypeCount; ++i) {
+            m_kills[i] += event.kills[i];
+        }
+        m_superzapperKills += event.totalKills;
+    }
+    
+    m_shotsFired += events.get<ShotFiredEvent>().size();
+    m_playerHits += events.get<PlayerHitEvent>().size();
+    m_levelsCleared += events.get<LevelClearedEvent>().size();
+    m_superzappersFired += events.get<SuperzapperFiredEvent>().size();
+}
+
+std::string EventTelemetry::getSummary() const {
+    static const char* const kTypeNames[Enemy::kTypeCount] = {
+        "flippers", "tankers", "spikers", "fuseballs", "pulsars"
+    };
+    
+    std::uint64_t totalKills = 0;
+    std::stringstream kills;
+    for (int i = 0; i < Enemy::kTypeCount; ++i) {
+        totalKills += m_kills[i];
+        kills << (i > 0 ? ", " : "") << m_kills[i] << " " << kTypeNames[i];
+    }
+    
+    // Shots that found a target, leaving out superzapper kills
+    std::uint64_t shotKills = totalKills - m_superzapperKills;
+    double accuracy = m_shotsFired > 0 ? 100.0 * shotKills / m_shotsFired : 0.0;
+    
+    std::stringstream ss;
+    ss << "Session: " << totalKills << " kills (" << kills.str() << "), "
+       << m_shotsFired << " shots, " << accuracy << "% accuracy, "
+       << m_superzappersFired << " superzappers (" << m_superzapperKills << " kills), "
+       << m_playerHits << " hits taken, " << m_levelsCleared << " levels cleared";
+    return ss.str();
+}
+
+} // namespace tempest
@@ -0,0 +1,245 @@
+#include "FrameExporter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+namespace tempest {
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// BT.601 video-range conversion in 8.8 fixed point
+inline std::uint8_t toY(int r, int g, int b) {
+    return static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+inline std::uint8_t toU(int r, int g, int b) {
+    return static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+inline std::uint8_t toV(int r, int g, int b) {
+    return static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+} // namespace
+
+FrameExporter::FrameExporter(Format format, const std::string& path, unsigned width, unsigned height,
+                             unsigned fps, unsigned workerCount, unsigned queueDepth)
+    : m_format(format)
+    , m_path(path)
+    , m_width(width)
+    , m_height(height)
+    , m_fps(fps)
+    , m_workerCount(workerCount > 0 ? workerCount : 1)
+    , m_frames(queueDepth > 0 ? queueDepth : 1)
+    , m_nextSubmit(0)
+    , m_nextWrite(0)
+    , m_stopping(false)
+    , m_failed(false)
+    , m_stats()
+{
+    // All frame memory is allocated up front and recycled
+    for (auto& frame : m_frames) {
+        frame.pixels.resize(static_cast<std::size_t>(width) * height * 4);
+        if (m_format == Format::Y4M) {
+            std::size_t chroma = static_cast<std::size_t>((width + 1) / 2) * ((height + 1) / 2);
+            frame.encoded.resize(static_cast<std::size_t>(width) * height + 2 * chroma);
+        }
+        m_free.push_back(&frame);
+    }
+}
+
+FrameExporter::~FrameExporter() {
+    finish();
+}
+
+bool FrameExporter::start() {
+    if (m_format == Format::Y4M) {
+        m_stream.open(m_path, std::ios::binary);
+        if (!m_stream.is_open()) {
+            return false;
+        }
+        
+        std::ostringstream header;
+        header << "YUV4MPEG2 W" << m_width << " H" << m_height << " F" << m_fps
+               << ":1 Ip A1:1 C420jpeg\n";
+        m_stream << header.str();
+    }
+    
+    for (unsigned i = 0; i < m_workerCount; ++i) {
+        m_workers.emplace_back(&FrameExporter::workerLoop, this);
+    }
+    return true;
+}
+
+bool FrameExporter::submit(const SoftwareRasterizer& rasterizer) {
+    if (rasterizer.getWidth() != m_width || rasterizer.getHeight() != m_height ||
+        rasterizer.getFormat() != SoftwareRasterizer::Format::RGBA) {
+        return false;
+    }
+    
+    Frame* frame = nullptr;
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_freeCondition.wait(lock, [this] { return !m_free.empty() || m_failed; });
+        m_stats.submitWaitSeconds += secondsSince(start);
+        
+        if (m_failed) {
+            return false;
+        }
+        frame = m_free.back();
+        m_free.pop_back();
+        frame->index = m_nextSubmit++;
+    }
+    
+    // Read back outside the lock; the workers only see the frame once queued
+    const std::uint8_t* pixels = rasterizer.getPixels();
+    std::copy(pixels, pixels + frame->pixels.size(), frame->pixels.begin());
+    
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(frame);
+    }
+    m_pendingCondition.notify_one();
+    return true;
+}
+
+bool FrameExporter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_pendingCondition.notify_all();
+    
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    
+    if (m_stream.is_open()) {
+        m_stream.close();
+        if (m_stream.fail()) {
+            m_failed = true;
+        }
+    }
+    return !m_failed;
+}
+
+FrameExporter::Stats FrameExporter::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void FrameExporter::workerLoop() {
+    for (;;) {
+        Frame* frame = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_pendingCondition.wait(lock, [this] { return !m_pending.empty() || m_stopping; });
+            
+            // Drain the queue before stopping
+            if (m_pending.empty()) {
+                return;
+            }
+            frame = m_pending.front();
+            m_pending.pop_front();
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        bool written = encode(*frame);
+        double elapsed = secondsSince(start);
+        
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.encodeSeconds += elapsed;
+            if (written) {
+                m_stats.framesWritten++;
+            } else {
+                m_failed = true;
+            }
+            m_free.push_back(frame);
+        }
+        m_freeCondition.notify_all();
+    }
+}
+
+bool FrameExporter::encode(Frame& frame) {
+    if (m_format == Format::PNG_SEQUENCE) {
+        return writePng(frame);
+    }
+    
+    convertToYuv(frame);
+    return appendInOrder(frame);
+}
+
+bool FrameExporter::writePng(const Frame& frame) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame_%06llu.png",
+                  static_cast<unsigned long long>(frame.index));
+    
+    sf::Image image;
+    image.create(m_width, m_height, frame.pixels.data());
+    return image.saveToFile(m_path + name);
+}
+
+void FrameExporter::convertToYuv(Frame& frame) const {
+    const std::uint8_t* rgba = frame.pixels.data();
+    std::uint8_t* yPlane = frame.encoded.data();
+    const unsigned chromaWidth = (m_width + 1) / 2;
+    const unsigned chromaHeight = (m_height + 1) / 2;
+    std::uint8_t* uPlane = yPlane + static_cast<std::size_t>(m_width) * m_height;
+    std::uint8_t* vPlane = uPlane + static_cast<std::size_t>(chromaWidth) * chromaHeight;
+    
+    for (unsigned y = 0; y < m_height; ++y) {
+        const std::uint8_t* row = rgba + static_cast<std::size_t>(y) * m_width * 4;
+        for (unsigned x = 0; x < m_width; ++x) {
+            yPlane[static_cast<std::size_t>(y) * m_width + x] = toY(row[x * 4], row[x * 4 + 1], row[x * 4 + 2]);
+        }
+    }
+    
+    // Chroma from the average of each 2x2 block (centered siting, as in JPEG)
+    for (unsigned cy = 0; cy < chromaHeight; ++cy) {
+        for (unsigned cx = 0; cx < chromaWidth; ++cx) {
+            int r = 0, g = 0, b = 0, count = 0;
+            for (unsigned y = cy * 2; y < cy * 2 + 2 && y < m_height; ++y) {
+                for (unsigned x = cx * 2; x < cx * 2 + 2 && x < m_width; ++x) {
+                    const std::uint8_t* pixel = rgba + (static_cast<std::size_t>(y) * m_width + x) * 4;
+                    r += pixel[0];
+                    g += pixel[1];
+                    b += pixel[2];
+                    count++;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            
+            std::size_t index = static_cast<std::size_t>(cy) * chromaWidth + cx;
+            uPlane[index] = toU(r, g, b);
+            vPlane[index] = toV(r, g, b);
+        }
+    }
+}
+
+bool FrameExporter::appendInOrder(const Frame& frame) {
+    // Frames are dequeued in order, so the one being waited for is always
+    // already with a worker and this cannot deadlock
+    std::unique_lock<std::mutex> lock(m_writeMutex);
+    m_writeCondition.wait(lock, [this, &frame] { return m_nextWrite == frame.index; });
+    
+    m_stream << "FRAME\n";
+    m_stream.write(reinterpret_cast<const char*>(frame.encoded.data()), frame.encoded.size());
+    bool written = m_stream.good();
+    
+    m_nextWrite++;
+    lock.unlock();
+    m_writeCondition.notify_all();
+    return written;
+}
+
+} // namespace tempest
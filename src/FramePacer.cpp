@@ -0,0 +1,61 @@
+#include "FramePacer.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace tempest {
+
+namespace {
+
+const FramePacer::Clock::duration kMinSpinMargin = std::chrono::microseconds(200);
+const FramePacer::Clock::duration kMaxSpinMargin = std::chrono::milliseconds(4);
+
+} // namespace
+
+FramePacer::FramePacer(double framesPerSecond)
+    : m_period(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / framesPerSecond)))
+    , m_nextFrame(Clock::now() + m_period)
+    , m_spinMargin(std::chrono::milliseconds(2))
+{
+}
+
+void FramePacer::waitForNextFrame() {
+    Clock::time_point now = Clock::now();
+    
+    // Running more than a frame late: start a new schedule from here
+    if (now > m_nextFrame + m_period) {
+        m_nextFrame = now;
+    }
+    
+    // Coarse sleep up to the margin, then learn from how far it overshot
+    Clock::time_point wakeTarget = m_nextFrame - m_spinMargin;
+    if (now < wakeTarget) {
+        std::this_thread::sleep_until(wakeTarget);
+        Clock::duration oversleep = Clock::now() - wakeTarget;
+        
+        // Keep twice the typical overshoot in hand, moving a quarter of the
+        // way per frame so a single hiccup doesn't stick
+        Clock::duration wanted = std::max(kMinSpinMargin, std::min(kMaxSpinMargin, oversleep * 2));
+        m_spinMargin += (wanted - m_spinMargin) / 4;
+    }
+    
+    // Fine wait
+    while (Clock::now() < m_nextFrame) {
+    }
+    
+    m_nextFrame += m_period;
+}
+
+void FramePacer::resync() {
+    m_nextFrame = Clock::now() + m_period;
+}
+
+FramePacer::Clock::duration FramePacer::getPeriod() const {
+    return m_period;
+}
+
+FramePacer::Clock::duration FramePacer::getSpinMargin() const {
+    return m_spinMargin;
+}
+
+} // namespace tempest
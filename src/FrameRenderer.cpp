@@ -0,0 +1,132 @@
+#include "FrameRenderer.hpp"
+#include <cmath>
+#include <cstdio>
+#include "Layout.hpp"
+
+namespace tempest {
+
+const sf::FloatRect FrameRenderer::kGameArea = layout::getArea();
+
+namespace {
+
+// HUD values are formatted on the stack; as std::strings most of them would
+// be past the small-string buffer and allocate every frame
+void drawValue(SoftwareRasterizer& rasterizer, const char* label, int value,
+               const sf::Vector2f& position, const sf::Color& color) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%s%d", label, value);
+    rasterizer.drawText(text, position, 20 * layout::kPixel, color);
+}
+
+} // namespace
+
+FrameRenderer::FrameRenderer() {
+}
+
+void FrameRenderer::render(Simulation& simulation, SoftwareRasterizer& rasterizer,
+                           const ParticleSystem* particles) {
+    rasterizer.clear(sf::Color::Black);
+    
+    // State-specific rendering
+    switch (simulation.getState()) {
+        case GameState::MENU:
+            renderMenu(simulation, rasterizer);
+            break;
+            
+        case GameState::PLAYING:
+            renderGame(simulation, rasterizer, particles);
+            break;
+            
+        case GameState::GAME_OVER:
+            renderGameOver(simulation, rasterizer);
+            break;
+            
+        case GameState::LEVEL_COMPLETE:
+            renderLevelComplete(simulation, rasterizer);
+            break;
+    }
+    
+    rasterizer.display();
+}
+
+void FrameRenderer::renderMenu(Simulation& simulation, SoftwareRasterizer& rasterizer) {
+    drawCentered(rasterizer, "TEMPEST", 100.0f, 72, sf::Color::Yellow);
+    drawCentered(rasterizer, "PRESS ENTER TO START", 300.0f, 24, sf::Color::White);
+    drawCentered(rasterizer,
+                 "CONTROLS:\n"
+                 "LEFT/RIGHT: MOVE\n"
+                 "SPACE: SHOOT\n"
+                 "Z: SUPERZAPPER\n"
+                 "ESC: QUIT",
+                 400.0f, 16, sf::Color::Cyan);
+    drawValue(rasterizer, "HIGH SCORE: ", simulation.getHighScore(),
+              layout::fromDesign(600.0f, 20.0f), sf::Color::Yellow);
+    drawTempestLogo(rasterizer);
+}
+
+void FrameRenderer::renderGame(Simulation& simulation, SoftwareRasterizer& rasterizer,
+                               const ParticleSystem* particles) {
+    simulation.getPlayfield().draw(rasterizer);
+    simulation.getPlayer().draw(rasterizer);
+    simulation.getEnemyManager().draw(rasterizer);
+    if (particles) {
+        particles->draw(rasterizer);
+    }
+    
+    // Draw HUD elements
+    drawValue(rasterizer, "SCORE: ", simulation.getScore(),
+              layout::fromDesign(20.0f, 20.0f), sf::Color::White);
+    drawValue(rasterizer, "HIGH SCORE: ", simulation.getHighScore(),
+              layout::fromDesign(600.0f, 20.0f), sf::Color::Yellow);
+    drawValue(rasterizer, "LEVEL: ", simulation.getLevel(),
+              layout::fromDesign(350.0f, 20.0f), sf::Color::Green);
+    drawValue(rasterizer, "LIVES: ", simulation.getLives(),
+              layout::fromDesign(20.0f, 560.0f), sf::Color::Red);
+}
+
+void FrameRenderer::renderGameOver(Simulation& simulation, SoftwareRasterizer& rasterizer) {
+    drawCentered(rasterizer, "GAME OVER", 200.0f, 72, sf::Color::Red);
+    drawCentered(rasterizer, "PRESS ENTER TO CONTINUE", 300.0f, 24, sf::Color::White);
+    drawValue(rasterizer, "SCORE: ", simulation.getScore(),
+              layout::fromDesign(20.0f, 20.0f), sf::Color::White);
+    drawValue(rasterizer, "HIGH SCORE: ", simulation.getHighScore(),
+              layout::fromDesign(600.0f, 20.0f), sf::Color::Yellow);
+}
+
+void FrameRenderer::renderLevelComplete(Simulation& simulation, SoftwareRasterizer& rasterizer) {
+    char title[32];
+    std::snprintf(title, sizeof(title), "LEVEL %d COMPLETE!", simulation.getLevel());
+    drawCentered(rasterizer, title, 200.0f, 48, sf::Color::Green);
+    drawCentered(rasterizer, "PRESS ENTER TO CONTINUE", 300.0f, 24, sf::Color::White);
+    drawValue(rasterizer, "SCORE: ", simulation.getScore(),
+              layout::fromDesign(20.0f, 20.0f), sf::Color::White);
+}
+
+void FrameRenderer::drawTempestLogo(SoftwareRasterizer& rasterizer) {
+    // Same hexagon and spokes as Game::drawTempestLogo
+    const sf::Vector2f center = layout::fromDesign(400.0f, 200.0f);
+    const float centerX = center.x;
+    const float centerY = center.y;
+    const float size = 150.0f * layout::kPixel;
+    
+    for (int i = 0; i < 6; ++i) {
+        float angle = i * 2.0f * M_PI / 6.0f;
+        float nextAngle = (i + 1) * 2.0f * M_PI / 6.0f;
+        sf::Vector2f corner(centerX + size * std::cos(angle), centerY + size * std::sin(angle));
+        sf::Vector2f nextCorner(centerX + size * std::cos(nextAngle), centerY + size * std::sin(nextAngle));
+        
+        rasterizer.drawLine(corner, nextCorner, sf::Color::Yellow);
+        rasterizer.drawLine(center, corner, sf::Color::Yellow);
+    }
+}
+
+void FrameRenderer::drawCentered(SoftwareRasterizer& rasterizer, const char* text, float y,
+                                 unsigned characterSize, const sf::Color& color) {
+    // Sizes and positions are in design pixels, like the window's layout
+    float size = characterSize * layout::kPixel;
+    float width = SoftwareRasterizer::getTextWidth(text, size);
+    sf::Vector2f position(kGameArea.left + (kGameArea.width - width) / 2.0f, layout::fromDesign(0.0f, y).y);
+    rasterizer.drawText(text, position, size, color);
+}
+
+} // namespace tempest
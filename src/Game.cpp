@@ -1,26 +1,75 @@
 #include "Game.hpp"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
-#include <sstream>
+#include <cstdio>
+#include <ctime>
 #include <fstream>
+#include "AllocTracker.hpp"
+#include "EmbeddedAssets.hpp"
+#include "Layout.hpp"
 #include "utils.hpp"
 
 namespace tempest {
 
-Game::Game() 
-    : m_window(sf::VideoMode(800, 600), "Tempest")
-    , m_state(GameState::MENU)
-    , m_playfield(Playfield::Type::CIRCLE, 16)
-    , m_player(m_playfield)
-    , m_enemyManager(m_playfield)
-    , m_score(0)
-    , m_highScore(0)
-    , m_level(1)
-    , m_lives(3)
+namespace {
+
+const std::uint32_t kBlinkTicks = Simulation::kTickRate / 2; // Instruction text blink
+
+// Real time a frame may catch up on at most. Stalls (window drags,
+// breakpoints) are cut short while playing; static screens sleep up to a
+// blink at a time and must get all of it, or the blink runs slow.
+const float kMaxCatchUp = 0.25f;
+const float kMaxIdleCatchUp = 1.0f;
+
+// An event that woke the waiter can reach SFML's own connection a moment
+// later
+const int kEventArrivalTries = 5;
+
+// Cold start target, from the first member to the end of the constructor
+const double kStartupBudgetMilliseconds = 250.0;
+
+} // namespace
+
+Game::Game(const GameOptions& options) 
+    : m_verticalSync(options.verticalSync)
+    , m_pacer(Simulation::kTickRate)
+    , m_latency(m_pacer.getPeriod())
+    , m_pixelsPerUnit(1.0f)
+    , m_dynamicResolution(options.dynamicResolution)
+    , m_renderScaler(m_pacer.getPeriod())
+    , m_sceneScaled(false)
+    , m_simulation(static_cast<std::uint64_t>(std::time(nullptr)), options.arithmetic)
+    , m_inputSampler(options.input)
+    , m_input()
+    , m_tickAccumulator(0.0f)
+    , m_recording(false)
+    , m_particles(m_simulation.getSeed())
+    , m_mixer(m_soundBank)
+    , m_soundEffects(m_mixer)
+    , m_hudDirty(true)
+    , m_allocatingFrames(0)
+    , m_needsRedraw(true)
+    , m_blinkTimer(m_uiTimers.schedule(kBlinkTicks, 0, 0, kBlinkTicks))
 {
-    m_window.setFramerateLimit(60);
-    
-    // Load font
-    if (!m_font.loadFromFile("assets/fonts/arcade.ttf")) {
+    // Members, including the simulation's first level, are built by now
+    m_startup.mark("level init");
+    
+    // Everything is laid out in logical units, so any size or aspect works
+    if (options.fullscreen) {
+        m_window.create(sf::VideoMode::getDesktopMode(), "Tempest", sf::Style::Fullscreen);
+    } else {
+        m_window.create(sf::VideoMode(options.width, options.height), "Tempest");
+    }
+    m_window.setVerticalSyncEnabled(m_verticalSync);
+    m_windowWaiter.attach(m_window.getSystemHandle());
+    m_inputSampler.start();
+    m_startup.mark("window");
+    
+    // The font is compiled into the executable; nothing is read from disk
+    // unless it turns out to be unusable
+    const EmbeddedAsset* font = findEmbeddedAsset("fonts/arcade.ttf");
+    if (!font || !m_font.loadFromMemory(font->data, font->size)) {
         // If font loading fails, use a system font as fallback
         Utils::printMessage("Failed to load arcade font, using system font");
         
@@ -39,26 +88,28 @@ Game::Game()
         }
         #endif
     }
+    m_startup.mark("assets");
+    
+    // Every effect is turned into PCM before the stream starts pulling
+    if (options.sound) {
+        int decoded = m_soundBank.load();
+        Utils::printMessage("Sound bank: " + std::to_string(decoded) + " of " +
+                            std::to_string(SoundBank::kSoundCount) + " sounds from assets, " +
+                            std::to_string(m_soundBank.getByteCount() / 1024) + " KB PCM");
+        m_audioOutput.reset(new AudioOutput(m_mixer));
+        m_audioOutput->play();
+    }
+    m_startup.mark("sound");
     
     // Initialize text elements
     m_titleText.setFont(m_font);
     m_titleText.setString("TEMPEST");
-    m_titleText.setCharacterSize(72);
     m_titleText.setFillColor(sf::Color::Yellow);
     m_titleText.setStyle(sf::Text::Bold);
-    m_titleText.setPosition(
-        (m_window.getSize().x - m_titleText.getLocalBounds().width) / 2.0f,
-        100.0f
-    );
     
     m_instructionText.setFont(m_font);
     m_instructionText.setString("PRESS ENTER TO START");
-    m_instructionText.setCharacterSize(24);
     m_instructionText.setFillColor(sf::Color::White);
-    m_instructionText.setPosition(
-        (m_window.getSize().x - m_instructionText.getLocalBounds().width) / 2.0f,
-        300.0f
-    );
     
     m_controlsText.setFont(m_font);
     m_controlsText.setString(
@@ -68,172 +119,309 @@ Game::Game()
         "Z: SUPERZAPPER\n"
         "ESC: QUIT"
     );
-    m_controlsText.setCharacterSize(16);
     m_controlsText.setFillColor(sf::Color::Cyan);
-    m_controlsText.setPosition(
-        (m_window.getSize().x - m_controlsText.getLocalBounds().width) / 2.0f,
-        400.0f
-    );
     
     m_scoreText.setFont(m_font);
-    m_scoreText.setCharacterSize(20);
     m_scoreText.setFillColor(sf::Color::White);
-    m_scoreText.setPosition(20.0f, 20.0f);
     
     m_highScoreText.setFont(m_font);
-    m_highScoreText.setCharacterSize(20);
     m_highScoreText.setFillColor(sf::Color::Yellow);
-    m_highScoreText.setPosition(
-        m_window.getSize().x - 200.0f,
-        20.0f
-    );
     
     m_levelText.setFont(m_font);
-    m_levelText.setCharacterSize(20);
     m_levelText.setFillColor(sf::Color::Green);
-    m_levelText.setPosition(
-        (m_window.getSize().x - 100.0f) / 2.0f,
-        20.0f
-    );
     
     m_livesText.setFont(m_font);
-    m_livesText.setCharacterSize(20);
     m_livesText.setFillColor(sf::Color::Red);
-    m_livesText.setPosition(20.0f, m_window.getSize().y - 40.0f);
     
     m_gameOverText.setFont(m_font);
     m_gameOverText.setString("GAME OVER");
-    m_gameOverText.setCharacterSize(72);
     m_gameOverText.setFillColor(sf::Color::Red);
-    m_gameOverText.setPosition(
-        (m_window.getSize().x - m_gameOverText.getLocalBounds().width) / 2.0f,
-        200.0f
-    );
+    
+    m_levelCompleteText.setFont(m_font);
+    m_levelCompleteText.setFillColor(sf::Color::Green);
+    
+    m_continueText.setFont(m_font);
+    m_continueText.setString("PRESS ENTER TO CONTINUE");
+    m_continueText.setFillColor(sf::Color::White);
+    
+    buildTempestLogo();
+    
+    // Sizes and positions the text for the window
+    updateView();
     
     // Load high score if available
     loadHighScore();
     
+    m_simulation.addListener(this);
+    m_simulation.addListener(&m_telemetry);
+    m_simulation.addListener(&m_particles);
+    if (m_audioOutput) {
+        m_simulation.addListener(&m_soundEffects);
+    }
+    
+    // Each game is recorded into these buffers; reserved now so starting one
+    // doesn't allocate
+    m_replay = Replay(m_simulation.getSeed(), m_simulation.getHighScore(), m_simulation.getArithmetic());
+    
+    if (!options.spectatorFeed.empty()) {
+        Utils::printMessage(m_spectatorFeed.open(options.spectatorFeed)
+                                ? "Spectator feed: " + options.spectatorFeed
+                                : "Failed to open spectator feed " + options.spectatorFeed);
+    }
+    
+    m_startup.mark("ui");
+    
     Utils::printMessage("Game initialized");
+    Utils::printMessage(m_startup.getReport(kStartupBudgetMilliseconds));
 }
 
 Game::~Game() {
     // Save high score before shutting down
     saveHighScore();
+    Utils::printMessage(m_telemetry.getSummary());
+    Utils::printMessage(m_latency.getReport());
+    m_inputSampler.stop();
+    if (m_inputSampler.getDroppedCount() > 0) {
+        Utils::printMessage("Input events dropped: " + std::to_string(m_inputSampler.getDroppedCount()));
+    }
+    if (m_audioOutput) {
+        m_audioOutput->stop();
+        AudioMixer::Stats audio = m_mixer.getStats();
+        Utils::printMessage("Audio: " + std::to_string(audio.played) + " sounds, peak " +
+                            std::to_string(audio.peakVoices) + " of " +
+                            std::to_string(m_mixer.getVoiceCount()) + " voices, " +
+                            std::to_string(audio.stolen) + " stolen, " +
+                            std::to_string(audio.dropped) + " dropped");
+    }
+    if (AllocTracker::isEnabled()) {
+        Utils::printMessage("Frames that allocated while playing: " +
+                            std::to_string(m_allocatingFrames));
+        Utils::printMessage(AllocTracker::getReport());
+    }
+    
+    // A game quit before it ended is still worth its replay
+    if (m_recording) {
+        saveReplay();
+    }
     Utils::printMessage("Game shutdown");
 }
 
 void Game::run() {
     while (m_window.isOpen()) {
+        // Static screens only redraw when something on them changes
+        bool idle = m_simulation.getState() != GameState::PLAYING;
+        
+        // Wait first, so input is read as late as possible before the step
+        if (idle) {
+            waitWhileIdle();
+        } else if (!m_verticalSync) {
+            m_pacer.waitForNextFrame();
+        }
+        
+        LatencyMonitor::Clock::time_point frameStart = LatencyMonitor::Clock::now();
+        AllocTracker::beginFrame();
         processInput();
         
         float deltaTime = m_clock.restart().asSeconds();
         update(deltaTime);
         
-        render();
+        if (m_simulation.getState() == GameState::PLAYING || m_needsRedraw) {
+            render();
+            LatencyMonitor::Clock::time_point drawn = LatencyMonitor::Clock::now();
+            m_window.display();
+            LatencyMonitor::Clock::time_point presented = LatencyMonitor::Clock::now();
+            m_needsRedraw = false;
+            
+            // Gameplay frames are meant to run from memory set up in advance
+            if (!idle && AllocTracker::getFrame().allocations > 0) {
+                m_allocatingFrames++;
+            }
+            
+            // Idle gaps are not frame times
+            if (idle) {
+                m_latency.idleFramePresented(presented);
+            } else {
+                m_latency.framePresented(presented);
+                
+                // With vertical sync, display() waits for the display, which
+                // says nothing about what the frame cost
+                if (m_dynamicResolution &&
+                    m_renderScaler.frameFinished((m_verticalSync ? drawn : presented) - frameStart)) {
+                    updateSceneTarget();
+                }
+            }
+        }
+    }
+}
+
+void Game::waitWhileIdle() {
+    // Sleep until the next blink, the only thing that changes a static
+    // screen on its own, or until the window has input, which is handled
+    // at once. The deadline is on m_clock, which update() reads next.
+    std::uint64_t ticksLeft = m_uiTimers.getDeadline(m_blinkTimer) - m_uiTimers.getNow() + 1;
+    sf::Time untilBlink = sf::seconds(ticksLeft * Simulation::kTickDuration - m_tickAccumulator);
+    
+    while (m_window.isOpen() && !pollEvents()) {
+        sf::Time left = untilBlink - m_clock.getElapsedTime();
+        if (left <= sf::Time::Zero) {
+            return;
+        }
+        if (m_windowWaiter.wait(left)) {
+            for (int i = 0; i < kEventArrivalTries && !pollEvents(); ++i) {
+                sf::sleep(sf::milliseconds(1));
+            }
+            return;
+        }
     }
 }
 
 void Game::processInput() {
+    pollEvents();
+    
+    // The joystick's state is as of the events just polled; held controls
+    // and analog motion are then collected per tick
+    m_inputSampler.sampleJoystick();
+}
+
+bool Game::pollEvents() {
+    bool any = false;
     sf::Event event;
     while (m_window.pollEvent(event)) {
-        if (event.type == sf::Event::Closed) {
+        handleEvent(event);
+        any = true;
+    }
+    return any;
+}
+
+void Game::handleEvent(const sf::Event& event) {
+    m_inputSampler.handleEvent(event);
+    
+    if (event.type == sf::Event::Closed) {
+        m_window.close();
+    }
+    
+    // Keep the logical area letterboxed in the new size
+    if (event.type == sf::Event::Resized) {
+        updateView();
+    }
+    
+    // The window contents may have been lost
+    if (event.type == sf::Event::GainedFocus) {
+        m_needsRedraw = true;
+    }
+    
+    if (event.type == sf::Event::KeyPressed) {
+        m_latency.inputReceived(LatencyMonitor::Clock::now());
+        
+        if (event.key.code == sf::Keyboard::Escape) {
             m_window.close();
         }
         
-        if (event.type == sf::Event::KeyPressed) {
-            if (event.key.code == sf::Keyboard::Escape) {
-                m_window.close();
-            }
-            
-            // Handle state-specific key presses
-            switch (m_state) {
-                case GameState::MENU:
-                    if (event.key.code == sf::Keyboard::Return) {
-                        startGame();
-                    }
-                    break;
-                    
-                case GameState::GAME_OVER:
-                    if (event.key.code == sf::Keyboard::Return) {
-                        m_state = GameState::MENU;
-                    }
-                    break;
-                    
-                case GameState::LEVEL_COMPLETE:
-                    if (event.key.code == sf::Keyboard::Return) {
-                        startNextLevel();
-                    }
-                    break;
-                    
-                default:
-                    break;
-            }
+        // Enter starts, continues or returns to the menu on the next tick
+        if (event.key.code == sf::Keyboard::Return) {
+            m_input.confirm = true;
         }
     }
-    
-    // Continuous input handling (only during gameplay)
-    if (m_state == GameState::PLAYING) {
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
-            m_player.moveLeft();
-        }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
-            m_player.moveRight();
-        }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) {
-            m_player.shoot();
-        }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Z)) {
-            m_player.useSuperzapper();
-        }
+}
+
+void Game::onEvents(const GameEventQueue& events) {
+    if (!events.get<EnemyKilledEvent>().empty() || !events.get<PlayerHitEvent>().empty() ||
+        !events.get<LevelClearedEvent>().empty() || !events.get<SuperzapperFiredEvent>().empty()) {
+        m_hudDirty = true;
     }
 }
 
 void Game::update(float deltaTime) {
-    // Update text elements
-    updateScoreText();
-    
-    // Blink instruction text in menu
-    static float blinkTimer = 0.0f;
-    blinkTimer += deltaTime;
-    if (blinkTimer >= 0.5f) {
-        blinkTimer = 0.0f;
-        if (m_state == GameState::MENU || m_state == GameState::GAME_OVER) {
-            m_instructionText.setFillColor(
-                m_instructionText.getFillColor() == sf::Color::White ? 
-                sf::Color::Transparent : sf::Color::White
-            );
-        }
-    }
+    // Run as many fixed ticks as real time allows
+    float maxCatchUp = m_simulation.getState() == GameState::PLAYING ? kMaxCatchUp : kMaxIdleCatchUp;
+    m_tickAccumulator = std::min(m_tickAccumulator + deltaTime, maxCatchUp);
+    InputSampler::Clock::time_point now = InputSampler::Clock::now();
     
-    // State-specific updates
-    switch (m_state) {
-        case GameState::PLAYING:
-            m_player.update(deltaTime);
-            m_enemyManager.update(deltaTime);
-            m_levelManager.update(deltaTime);
-            
-            checkCollisions();
+    while (m_tickAccumulator >= Simulation::kTickDuration) {
+        m_tickAccumulator -= Simulation::kTickDuration;
+        
+        // Each tick takes the input up to the real time it stands for; what
+        // is left in the accumulator is still to come
+        m_inputSampler.collect(now - std::chrono::duration_cast<InputSampler::Clock::duration>(
+                                         std::chrono::duration<float>(m_tickAccumulator)),
+                               m_input);
+        
+        // Only games are recorded, each from the state before the tick that
+        // starts it; the menu and game-over screens would grow it forever
+        GameState previousState = m_simulation.getState();
+        if (previousState == GameState::MENU && m_input.confirm) {
+            m_replay.start(m_simulation);
+            m_recording = true;
+        }
+        if (m_recording) {
+            m_replay.record(m_input);
+        }
+        m_simulation.tick(m_input);
+        if (m_recording) {
+            m_replay.recordOutcome(m_simulation);
+            if (m_simulation.getState() == GameState::GAME_OVER) {
+                saveReplay();
+                m_recording = false;
+            }
+        }
+        m_spectatorFeed.publish(m_simulation);
+        m_input.confirm = false;
+        
+        // Blink instruction text in menu; the blink is the only UI timer
+        m_uiTimers.advance([this](const TimerWheel::Timer&) {
+            if (m_simulation.getState() == GameState::MENU ||
+                m_simulation.getState() == GameState::GAME_OVER) {
+                m_instructionText.setFillColor(
+                    m_instructionText.getFillColor() == sf::Color::White ? 
+                    sf::Color::Transparent : sf::Color::White
+                );
+                m_needsRedraw = true;
+            }
+        });
+        
+        if (m_simulation.getState() != previousState) {
+            m_hudDirty = true;
+            m_needsRedraw = true;
             
-            // Check if level is complete
-            // Only check if there are enemies to clear
-            if (m_enemyManager.getEnemies().size() > 0 && m_enemyManager.areEnemiesCleared()) {
-                m_state = GameState::LEVEL_COMPLETE;
-                // Add level completion bonus
-                m_score += 1000 * m_level;
-                updateScoreText();
+            // Explosions don't carry over into a new game or level
+            if (m_simulation.getState() == GameState::PLAYING) {
+                m_particles.clear();
             }
-            break;
             
-        default:
-            break;
+            if (m_simulation.getState() == GameState::GAME_OVER) {
+                // Update instruction text for game over screen
+                m_instructionText.setString("PRESS ENTER TO CONTINUE");
+                placeCentered(m_instructionText, 24, 300.0f);
+            }
+        }
+    }
+    
+    // Particles are cosmetic, so they move with frame time
+    if (m_simulation.getState() == GameState::PLAYING) {
+        AllocScope scope(AllocSubsystem::PARTICLES);
+        m_particles.update(deltaTime);
+    }
+    
+    // Update text elements
+    if (m_hudDirty) {
+        AllocScope scope(AllocSubsystem::UI);
+        updateScoreText();
+        m_hudDirty = false;
+        m_needsRedraw = true;
     }
 }
 
 void Game::render() {
+    AllocScope scope(AllocSubsystem::RENDER);
     m_window.clear(sf::Color::Black);
     
-    // State-specific rendering
-    switch (m_state) {
+    // Geometry first, at the scene's resolution...
+    sf::RenderTarget& scene = beginScene();
+    renderScene(scene);
+    endScene();
+    
+    // ...then text on top, always at the window's
+    switch (m_simulation.getState()) {
         case GameState::MENU:
             renderMenu();
             break;
@@ -250,8 +438,121 @@ void Game::render() {
             renderLevelComplete();
             break;
     }
+}
+
+void Game::updateView() {
+    sf::Vector2u size = m_window.getSize();
+    sf::FloatRect viewport = layout::getLetterbox(size.x, size.y);
+    
+    m_view = sf::View(layout::getArea());
+    m_view.setViewport(viewport);
+    m_window.setView(m_view);
+    m_pixelsPerUnit = std::max(1.0f, viewport.height * size.y / layout::kHeight);
+    
+    layoutText();
+    updateSceneTarget();
+    if (m_dynamicResolution) {
+        m_renderScaler.resetWindow();
+    }
+    m_needsRedraw = true;
+}
+
+void Game::layoutText() {
+    placeCentered(m_titleText, 72, 100.0f);
+    placeCentered(m_instructionText, 24, 300.0f);
+    placeCentered(m_controlsText, 16, 400.0f);
+    placeText(m_scoreText, 20, 20.0f, 20.0f);
+    placeText(m_highScoreText, 20, 600.0f, 20.0f);
+    placeText(m_levelText, 20, 350.0f, 20.0f);
+    placeText(m_livesText, 20, 20.0f, 560.0f);
+    placeCentered(m_gameOverText, 72, 200.0f);
+    placeCentered(m_levelCompleteText, 48, 200.0f);
+    placeCentered(m_continueText, 24, 300.0f);
+}
+
+void Game::placeText(sf::Text& text, unsigned designSize, float designX, float designY) {
+    // Glyphs are rasterized at the size they cover in the window and scaled
+    // back to logical units, so text stays sharp at any resolution
+    float pixels = designSize * layout::kPixel * m_pixelsPerUnit;
+    text.setCharacterSize(std::max(1u, static_cast<unsigned>(pixels + 0.5f)));
+    text.setScale(1.0f / m_pixelsPerUnit, 1.0f / m_pixelsPerUnit);
+    text.setPosition(layout::fromDesign(designX, designY));
+}
+
+void Game::placeCentered(sf::Text& text, unsigned designSize, float designY) {
+    placeText(text, designSize, 0.0f, designY);
+    
+    sf::FloatRect area = layout::getArea();
+    float width = text.getLocalBounds().width / m_pixelsPerUnit;
+    text.setPosition(area.left + (area.width - width) / 2.0f, text.getPosition().y);
+}
+
+void Game::updateSceneTarget() {
+    m_sceneScaled = false;
     
-    m_window.display();
+    float scale = m_dynamicResolution ? m_renderScaler.getScale() : 1.0f;
+    if (scale >= 1.0f) {
+        return;
+    }
+    
+    unsigned width = static_cast<unsigned>(layout::kWidth * m_pixelsPerUnit * scale + 0.5f);
+    unsigned height = static_cast<unsigned>(layout::kHeight * m_pixelsPerUnit * scale + 0.5f);
+    if (!m_sceneTexture.create(std::max(1u, width), std::max(1u, height))) {
+        Utils::printMessage("Failed to create scene texture, dynamic resolution off");
+        m_dynamicResolution = false;
+        return;
+    }
+    
+    // Smoothing does the upscale when the texture is drawn to the window
+    m_sceneTexture.setSmooth(true);
+    m_sceneTexture.setView(sf::View(layout::getArea()));
+    m_sceneScaled = true;
+    
+    Utils::printMessage("Scene render scale " + std::to_string(static_cast<int>(scale * 100.0f + 0.5f)) + "%");
+}
+
+sf::RenderTarget& Game::beginScene() {
+    if (!m_sceneScaled) {
+        return m_window;
+    }
+    
+    m_sceneTexture.clear(sf::Color::Black);
+    return m_sceneTexture;
+}
+
+void Game::endScene() {
+    if (!m_sceneScaled) {
+        return;
+    }
+    
+    m_sceneTexture.display();
+    
+    // Stretch the texture over the logical area
+    sf::FloatRect area = layout::getArea();
+    sf::Vector2u size = m_sceneTexture.getSize();
+    sf::Sprite sprite(m_sceneTexture.getTexture());
+    sprite.setPosition(area.left, area.top);
+    sprite.setScale(area.width / size.x, area.height / size.y);
+    m_window.draw(sprite);
+}
+
+void Game::renderScene(sf::RenderTarget& target) {
+    switch (m_simulation.getState()) {
+        case GameState::MENU:
+            // Draw a vector-style Tempest logo
+            drawTempestLogo(target);
+            break;
+            
+        case GameState::PLAYING:
+            m_simulation.getPlayfield().draw(target);
+            m_simulation.getPlayer().draw(target);
+            m_simulation.getEnemyManager().draw(target);
+            m_particles.draw(target);
+            break;
+            
+        default:
+            break;
+    }
 }
 
 void Game::renderMenu() {
@@ -260,21 +561,19 @@ void Game::renderMenu() {
     m_window.draw(m_instructionText);
     m_window.draw(m_controlsText);
     m_window.draw(m_highScoreText);
-    
-    // Draw a vector-style Tempest logo
-    drawTempestLogo();
-    
-    Utils::printMessage("Rendering menu screen");
 }
 
-void Game::drawTempestLogo() {
-    // Draw a vector-style Tempest logo using lines
-    const float centerX = m_window.getSize().x / 2.0f;
-    const float centerY = 200.0f;
-    const float size = 150.0f;
+void Game::buildTempestLogo() {
+    // A vector-style Tempest logo using lines; it never changes, so it is
+    // built once
+    const sf::Vector2f center = layout::fromDesign(400.0f, 200.0f);
+    const float centerX = center.x;
+    const float centerY = center.y;
+    const float size = 150.0f * layout::kPixel;
     
     // Create a hexagon shape for the logo
-    sf::VertexArray hexagon(sf::LineStrip, 7);
+    sf::VertexArray& hexagon = m_logoHexagon;
+    hexagon = sf::VertexArray(sf::LineStrip, 7);
     for (int i = 0; i < 7; ++i) {
         float angle = i * 2.0f * M_PI / 6.0f;
         hexagon[i].position = sf::Vector2f(
@@ -285,7 +584,8 @@ void Game::drawTempestLogo() {
     }
     
     // Create spokes radiating from the center
-    sf::VertexArray spokes(sf::Lines, 12);
+    sf::VertexArray& spokes = m_logoSpokes;
+    spokes = sf::VertexArray(sf::Lines, 12);
     for (int i = 0; i < 6; ++i) {
         float angle = i * 2.0f * M_PI / 6.0f;
         spokes[i*2].position = sf::Vector2f(centerX, centerY);
@@ -297,23 +597,19 @@ void Game::drawTempestLogo() {
         );
         spokes[i*2+1].color = sf::Color::Yellow;
     }
-    
-    m_window.draw(hexagon);
-    m_window.draw(spokes);
+}
+
+void Game::drawTempestLogo(sf::RenderTarget& target) {
+    target.draw(m_logoHexagon);
+    target.draw(m_logoSpokes);
 }
 
 void Game::renderGame() {
-    m_playfield.draw(m_window);
-    m_player.draw(m_window);
-    m_enemyManager.draw(m_window);
-    
     // Draw HUD elements
     m_window.draw(m_scoreText);
     m_window.draw(m_highScoreText);
     m_window.draw(m_levelText);
     m_window.draw(m_livesText);
-    
-    Utils::printMessage("Rendering game screen");
 }
 
 void Game::renderGameOver() {
@@ -324,163 +620,52 @@ void Game::renderGameOver() {
 }
 
 void Game::renderLevelComplete() {
-    sf::Text levelCompleteText;
-    levelCompleteText.setFont(m_font);
-    levelCompleteText.setString("LEVEL " + std::to_string(m_level) + " COMPLETE!");
-    levelCompleteText.setCharacterSize(48);
-    levelCompleteText.setFillColor(sf::Color::Green);
-    levelCompleteText.setPosition(
-        (m_window.getSize().x - levelCompleteText.getLocalBounds().width) / 2.0f,
-        200.0f
-    );
-    
-    sf::Text continueText;
-    continueText.setFont(m_font);
-    continueText.setString("PRESS ENTER TO CONTINUE");
-    continueText.setCharacterSize(24);
-    continueText.setFillColor(sf::Color::White);
-    continueText.setPosition(
-        (m_window.getSize().x - continueText.getLocalBounds().width) / 2.0f,
-        300.0f
-    );
-    
-    m_window.draw(levelCompleteText);
-    m_window.draw(continueText);
+    m_window.draw(m_levelCompleteText);
+    m_window.draw(m_continueText);
     m_window.draw(m_scoreText);
 }
 
-void Game::checkCollisions() {
-    // Check collisions between player shots and enemies
-    const auto& enemies = m_enemyManager.getEnemies();
-    const auto& shots = m_player.getShots();
-    
-    for (const auto& shot : shots) {
-        for (auto& enemy : const_cast<std::vector<Enemy>&>(enemies)) {
-            if (!enemy.isDestroyed() && !shot.isOutOfBounds()) {
-                float distance = std::sqrt(
-                    std::pow(shot.getPosition().x - enemy.getPosition().x, 2) +
-                    std::pow(shot.getPosition().y - enemy.getPosition().y, 2)
-                );
-                
-                if (distance < (shot.getRadius() + enemy.getRadius())) {
-                    enemy.destroy();
-                    const_cast<Shot&>(shot).destroy();
-                    
-                    // Award points based on enemy type
-                    switch (enemy.getType()) {
-                        case Enemy::Type::FLIPPER:
-                            m_score += 150;
-                            break;
-                        case Enemy::Type::TANKER:
-                            m_score += 200;
-                            break;
-                        case Enemy::Type::SPIKER:
-                            m_score += 250;
-                            break;
-                        case Enemy::Type::FUSEBALL:
-                            m_score += 300;
-                            break;
-                        case Enemy::Type::PULSAR:
-                            m_score += 350;
-                            break;
-                        default:
-                            m_score += 100;
-                            break;
-                    }
-                    
-                    // Update high score if needed
-                    if (m_score > m_highScore) {
-                        m_highScore = m_score;
-                    }
-                }
-            }
-        }
-    }
-    
-    // Check collisions between player and enemies
-    for (const auto& enemy : enemies) {
-        if (!enemy.isDestroyed() && enemy.isAtEdge() && enemy.getLane() == m_player.getPosition()) {
-            // Player hit by enemy
-            playerHit();
-        }
-    }
-}
-
-void Game::startGame() {
-    m_state = GameState::PLAYING;
-    m_score = 0;
-    m_level = 1;
-    m_lives = 3;
-    
-    // Reset game elements
-    m_playfield = Playfield(Playfield::Type::CIRCLE, 16);
-    m_player = Player(m_playfield);
-    m_enemyManager = EnemyManager(m_playfield);
-    m_levelManager = LevelManager();
-    
-    // Set initial enemy spawn rate and speed
-    m_enemyManager.setSpawnRate(m_levelManager.getEnemySpawnRate());
-    m_enemyManager.setEnemySpeed(m_levelManager.getEnemySpeed());
-    
-    updateScoreText();
-}
-
-void Game::startNextLevel() {
-    m_level++;
-    m_levelManager.startNextLevel();
-    m_playfield = Playfield(m_levelManager.getCurrentPlayfieldType(), m_levelManager.getNumSegments());
-    m_player = Player(m_playfield);
-    m_enemyManager = EnemyManager(m_playfield);
-    m_enemyManager.setSpawnRate(m_levelManager.getEnemySpawnRate());
-    m_enemyManager.setEnemySpeed(m_levelManager.getEnemySpeed());
-    m_state = GameState::PLAYING;
-}
-
-void Game::playerHit() {
-    m_lives--;
-    
-    if (m_lives <= 0) {
-        m_state = GameState::GAME_OVER;
-        
-        // Update instruction text for game over screen
-        m_instructionText.setString("PRESS ENTER TO CONTINUE");
-        m_instructionText.setPosition(
-            (m_window.getSize().x - m_instructionText.getLocalBounds().width) / 2.0f,
-            300.0f
-        );
-    }
-}
-
 void Game::updateScoreText() {
-    std::stringstream ss;
-    ss << "SCORE: " << m_score;
-    m_scoreText.setString(ss.str());
+    // Formatted on the stack; sf::Text still copies the string it is given
+    char text[32];
+    std::snprintf(text, sizeof(text), "SCORE: %d", m_simulation.getScore());
+    m_scoreText.setString(text);
+    
+    std::snprintf(text, sizeof(text), "HIGH SCORE: %d", m_simulation.getHighScore());
+    m_highScoreText.setString(text);
     
-    ss.str("");
-    ss << "HIGH SCORE: " << m_highScore;
-    m_highScoreText.setString(ss.str());
+    std::snprintf(text, sizeof(text), "LEVEL: %d", m_simulation.getLevel());
+    m_levelText.setString(text);
     
-    ss.str("");
-    ss << "LEVEL: " << m_level;
-    m_levelText.setString(ss.str());
+    std::snprintf(text, sizeof(text), "LIVES: %d", m_simulation.getLives());
+    m_livesText.setString(text);
     
-    ss.str("");
-    ss << "LIVES: " << m_lives;
-    m_livesText.setString(ss.str());
+    std::snprintf(text, sizeof(text), "LEVEL %d COMPLETE!", m_simulation.getLevel());
+    m_levelCompleteText.setString(text);
+    placeCentered(m_levelCompleteText, 48, 200.0f);
 }
 
 void Game::loadHighScore() {
     std::ifstream file("highscore.dat");
     if (file.is_open()) {
-        file >> m_highScore;
+        int highScore = 0;
+        file >> highScore;
+        m_simulation.setHighScore(highScore);
         file.close();
     }
 }
 
+void Game::saveReplay() {
+    if (m_replay.saveToFile("replay.dat")) {
+        Utils::printMessage("Replay saved to replay.dat (" +
+                            std::to_string(m_replay.getTickCount()) + " ticks)");
+    }
+}
+
 void Game::saveHighScore() {
     std::ofstream file("highscore.dat");
     if (file.is_open()) {
-        file << m_highScore;
+        file << m_simulation.getHighScore();
         file.close();
     }
 }
@@ -0,0 +1,34 @@
+#include "GameEvents.hpp"
+
+namespace tempest {
+
+namespace {
+
+// Well above what one tick produces, even with a superzapper on a full tube
+const std::size_t kEventsPerTick = 64;
+
+} // namespace
+
+GameEventQueue::GameEventQueue() {
+    std::get<0>(m_buffers).reserve(kEventsPerTick);
+    std::get<1>(m_buffers).reserve(kEventsPerTick);
+    std::get<2>(m_buffers).reserve(kEventsPerTick);
+    std::get<3>(m_buffers).reserve(kEventsPerTick);
+    std::get<4>(m_buffers).reserve(kEventsPerTick);
+}
+
+bool GameEventQueue::empty() const {
+    return std::get<0>(m_buffers).empty() && std::get<1>(m_buffers).empty() &&
+           std::get<2>(m_buffers).empty() && std::get<3>(m_buffers).empty() &&
+           std::get<4>(m_buffers).empty();
+}
+
+void GameEventQueue::clear() {
+    std::get<0>(m_buffers).clear();
+    std::get<1>(m_buffers).clear();
+    std::get<2>(m_buffers).clear();
+    std::get<3>(m_buffers).clear();
+    std::get<4>(m_buffers).clear();
+}
+
+} // namespace tempest
@@ -0,0 +1,321 @@
+#include "InputSampler.hpp"
+#include <SFML/Window.hpp>
+#include <algorithm>
+#include <cmath>
+#include "utils.hpp"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace tempest {
+
+namespace {
+
+const float kStickDeadZone = 20.0f;   // Of 100, ignored around the center
+const float kPovThreshold = 50.0f;    // D-pad deflection that counts as held
+const unsigned kFireButton = 0;
+const unsigned kSuperzapperButton = 1;
+
+// Longest gap the stick's turn is reckoned over, as the game caps its
+// catch-up after a stall
+const float kMaxStickInterval = 0.25f;
+
+// Larger turns carry over to the next ticks, so a flicked spinner can't
+// skip the player past lanes in one tick
+const std::int64_t kMaxSpinPerTick = 4 * Player::kSpinUnitsPerLane;
+
+std::uint8_t bit(InputButton button) {
+    return static_cast<std::uint8_t>(1u << static_cast<int>(button));
+}
+
+// The keyboard's controls; 0 for other keys
+std::uint8_t keyBit(sf::Keyboard::Key key) {
+    switch (key) {
+    case sf::Keyboard::Left:
+        return bit(InputButton::LEFT);
+    case sf::Keyboard::Right:
+        return bit(InputButton::RIGHT);
+    case sf::Keyboard::Space:
+        return bit(InputButton::FIRE);
+    case sf::Keyboard::Z:
+        return bit(InputButton::SUPERZAPPER);
+    default:
+        return 0;
+    }
+}
+
+} // namespace
+
+InputSampler::InputSampler(const InputOptions& options)
+    : m_options(options)
+    , m_running(false)
+    , m_dropped(0)
+    , m_spinnerCarry(0)
+    , m_spinnerFd(-1)
+    , m_stopPipe{-1, -1}
+    , m_keysHeld(0)
+    , m_reportedHeld()
+    , m_stickCarry(0.0f)
+    , m_lastJoystickSample(Clock::now())
+    , m_held()
+    , m_pressedSinceCollect(0)
+    , m_pendingSpin(0)
+{
+}
+
+InputSampler::~InputSampler() {
+    stop();
+}
+
+void InputSampler::start() {
+    if (m_running.load()) {
+        return;
+    }
+
+    // Without a spinner there is nothing for a thread to do
+#ifdef __linux__
+    if (!m_options.spinnerDevice.empty()) {
+        m_spinnerFd = open(m_options.spinnerDevice.c_str(), O_RDONLY | O_NONBLOCK);
+        if (m_spinnerFd < 0) {
+            Utils::printMessage("Could not open spinner " + m_options.spinnerDevice);
+        } else if (pipe(m_stopPipe) != 0) {
+            Utils::printMessage("Could not start the spinner thread");
+            close(m_spinnerFd);
+            m_spinnerFd = -1;
+        } else {
+            // Stamp events on the same clock as everything else
+            int clock = CLOCK_MONOTONIC;
+            ioctl(m_spinnerFd, EVIOCSCLOCKID, &clock);
+            m_running.store(true);
+            m_thread = std::thread(&InputSampler::run, this);
+        }
+    }
+#else
+    if (!m_options.spinnerDevice.empty()) {
+        Utils::printMessage("Spinner devices are only supported on Linux");
+    }
+#endif
+}
+
+void InputSampler::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+
+#ifdef __linux__
+    char wake = 0;
+    if (write(m_stopPipe[1], &wake, 1) < 0) {
+        Utils::printMessage("Could not wake the spinner thread");
+    }
+    m_thread.join();
+
+    close(m_stopPipe[0]);
+    close(m_stopPipe[1]);
+    m_stopPipe[0] = m_stopPipe[1] = -1;
+    close(m_spinnerFd);
+    m_spinnerFd = -1;
+#endif
+}
+
+void InputSampler::handleEvent(const sf::Event& event) {
+    std::uint8_t held = m_keysHeld;
+    if (event.type == sf::Event::KeyPressed) {
+        held |= keyBit(event.key.code);
+    } else if (event.type == sf::Event::KeyReleased) {
+        held &= static_cast<std::uint8_t>(~keyBit(event.key.code));
+    } else if (event.type == sf::Event::LostFocus) {
+        // Keys let go elsewhere never report their release here
+        held = 0;
+    }
+
+    // Repeats of a held key change nothing and queue nothing
+    if (held != m_keysHeld) {
+        m_keysHeld = held;
+        setButtons(Source::KEYBOARD, held, toNanoseconds(Clock::now()));
+    }
+}
+
+void InputSampler::sampleJoystick() {
+    Clock::time_point sampled = Clock::now();
+    std::int64_t now = toNanoseconds(sampled);
+    float interval = std::min(kMaxStickInterval,
+                              std::chrono::duration<float>(sampled - m_lastJoystickSample).count());
+    m_lastJoystickSample = sampled;
+
+    // The first connected joystick
+    unsigned joystick = 0;
+    while (joystick < sf::Joystick::Count && !sf::Joystick::isConnected(joystick)) {
+        ++joystick;
+    }
+    if (joystick == sf::Joystick::Count) {
+        setButtons(Source::JOYSTICK, 0, now);
+        m_stickCarry = 0.0f;
+        return;
+    }
+
+    std::uint8_t held = 0;
+    if (sf::Joystick::isButtonPressed(joystick, kFireButton)) held |= bit(InputButton::FIRE);
+    if (sf::Joystick::isButtonPressed(joystick, kSuperzapperButton)) held |= bit(InputButton::SUPERZAPPER);
+    if (sf::Joystick::hasAxis(joystick, sf::Joystick::PovX)) {
+        float pov = sf::Joystick::getAxisPosition(joystick, sf::Joystick::PovX);
+        if (pov <= -kPovThreshold) held |= bit(InputButton::LEFT);
+        if (pov >= kPovThreshold) held |= bit(InputButton::RIGHT);
+    }
+    setButtons(Source::JOYSTICK, held, now);
+
+    // The stick turns at a rate proportional to its deflection
+    float deflection = sf::Joystick::getAxisPosition(joystick, sf::Joystick::X);
+    if (std::fabs(deflection) < kStickDeadZone) {
+        m_stickCarry = 0.0f;
+        return;
+    }
+
+    m_stickCarry += deflection / 100.0f * m_options.stickLanesPerSecond * interval *
+                    Player::kSpinUnitsPerLane;
+    float whole = std::trunc(m_stickCarry);
+    if (whole != 0.0f) {
+        m_stickCarry -= whole;
+        InputEvent event = {now, InputEvent::Type::SPIN, Source::JOYSTICK,
+                            InputButton::LEFT, false, static_cast<std::int32_t>(whole)};
+        emit(m_windowEvents, event);
+    }
+}
+
+void InputSampler::collect(Clock::time_point until, PlayerInput& input) {
+    const std::int64_t limit = toNanoseconds(until);
+    std::int64_t spin = m_pendingSpin;
+
+    // Each ring holds its own sources, so they can be taken one after the
+    // other
+    apply(m_windowEvents, limit, spin);
+    apply(m_spinnerEvents, limit, spin);
+
+    // Held on any device, or tapped since the last tick
+    std::uint8_t buttons = m_pressedSinceCollect;
+    for (std::uint8_t held : m_held) {
+        buttons |= held;
+    }
+    m_pressedSinceCollect = 0;
+
+    input.left = (buttons & bit(InputButton::LEFT)) != 0;
+    input.right = (buttons & bit(InputButton::RIGHT)) != 0;
+    input.fire = (buttons & bit(InputButton::FIRE)) != 0;
+    input.superzapper = (buttons & bit(InputButton::SUPERZAPPER)) != 0;
+
+    std::int64_t taken = std::max(-kMaxSpinPerTick, std::min(kMaxSpinPerTick, spin));
+    input.spin = static_cast<int>(taken);
+    m_pendingSpin = spin - taken;
+}
+
+bool InputSampler::hasSpinner() const {
+    return m_spinnerFd >= 0;
+}
+
+std::uint64_t InputSampler::getDroppedCount() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void InputSampler::run() {
+#ifdef __linux__
+    // Asleep until the spinner has counts or stop() writes to the pipe, so
+    // an idle spinner costs nothing; counts go out as they arrive
+    pollfd descriptors[2] = {{m_spinnerFd, POLLIN, 0}, {m_stopPipe[0], POLLIN, 0}};
+    while (m_running.load(std::memory_order_relaxed)) {
+        if (poll(descriptors, 2, -1) <= 0) {
+            continue;
+        }
+        // An unplugged spinner would wake the thread for ever
+        if (descriptors[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            break;
+        }
+        if (descriptors[0].revents & POLLIN) {
+            readSpinner();
+        }
+    }
+#endif
+}
+
+void InputSampler::readSpinner() {
+#ifdef __linux__
+    input_event events[64];
+    ssize_t bytes;
+    while ((bytes = read(m_spinnerFd, events, sizeof(events))) > 0) {
+        std::size_t count = static_cast<std::size_t>(bytes) / sizeof(input_event);
+        for (std::size_t i = 0; i < count; ++i) {
+            const input_event& raw = events[i];
+            if (raw.type != EV_REL ||
+                (raw.code != REL_DIAL && raw.code != REL_X && raw.code != REL_WHEEL)) {
+                continue;
+            }
+
+            // Counts to spin units, keeping any remainder for the next count
+            int scaled = raw.value * Player::kSpinUnitsPerLane + m_spinnerCarry;
+            int units = scaled / std::max(1, m_options.spinnerCountsPerLane);
+            m_spinnerCarry = scaled - units * std::max(1, m_options.spinnerCountsPerLane);
+            if (units == 0) {
+                continue;
+            }
+
+            std::int64_t time = static_cast<std::int64_t>(raw.time.tv_sec) * 1000000000LL +
+                                static_cast<std::int64_t>(raw.time.tv_usec) * 1000LL;
+            InputEvent event = {time, InputEvent::Type::SPIN, Source::SPINNER,
+                                InputButton::LEFT, false, units};
+            emit(m_spinnerEvents, event);
+        }
+    }
+#endif
+}
+
+void InputSampler::setButtons(Source source, std::uint8_t held, std::int64_t now) {
+    // Only changes go into the ring
+    std::uint8_t& previous = m_reportedHeld[static_cast<int>(source)];
+    std::uint8_t changed = static_cast<std::uint8_t>(held ^ previous);
+    for (int button = 0; changed != 0 && button < kButtonCount; ++button) {
+        std::uint8_t mask = static_cast<std::uint8_t>(1u << button);
+        if (changed & mask) {
+            InputEvent event = {now, InputEvent::Type::BUTTON, source,
+                                static_cast<InputButton>(button), (held & mask) != 0, 0};
+            emit(m_windowEvents, event);
+        }
+    }
+    previous = held;
+}
+
+void InputSampler::emit(EventRing& ring, const InputEvent& event) {
+    if (!ring.push(event)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void InputSampler::apply(EventRing& ring, std::int64_t limit, std::int64_t& spin) {
+    while (const InputEvent* event = ring.front()) {
+        if (event->time > limit) {
+            break;
+        }
+
+        if (event->type == InputEvent::Type::BUTTON) {
+            std::uint8_t& held = m_held[static_cast<int>(event->source)];
+            if (event->pressed) {
+                held |= bit(event->button);
+                m_pressedSinceCollect |= bit(event->button);
+            } else {
+                held &= static_cast<std::uint8_t>(~bit(event->button));
+            }
+        } else {
+            spin += event->spin;
+        }
+        ring.pop();
+    }
+}
+
+std::int64_t InputSampler::toNanoseconds(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace tempest
@@ -0,0 +1,282 @@
+#include "LaneIndex.hpp"
+#include <algorithm>
+
+namespace tempest {
+
+namespace {
+
+// Index of the lowest and highest set bit of a non-zero mask
+int lowestBit(std::uint64_t mask) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int bit = 0;
+    while (!((mask >> bit) & 1ULL)) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+int highestBit(std::uint64_t mask) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(mask);
+#else
+    int bit = 63;
+    while (!((mask >> bit) & 1ULL)) {
+        --bit;
+    }
+    return bit;
+#endif
+}
+
+// Rim first; ties in the order the enemies are visited in, pool by pool
+bool isCloser(const LaneIndex::Entry& lhs, const LaneIndex::Entry& rhs) {
+    if (lhs.depth != rhs.depth) {
+        return lhs.depth < rhs.depth;
+    }
+    if (lhs.enemy.type != rhs.enemy.type) {
+        return lhs.enemy.type < rhs.enemy.type;
+    }
+    return lhs.enemy.slot < rhs.enemy.slot;
+}
+
+} // namespace
+
+const int LaneIndex::kMaxLanes;
+const std::uint16_t LaneIndex::kNoSlot;
+
+LaneIndex::LaneIndex(int numLanes, LevelArena* arena)
+    : m_numLanes(std::min(std::max(numLanes, 0), kMaxLanes))
+    , m_laneMask(0)
+    , m_occupancy(0)
+    , m_entries(ArenaAllocator<Entry>(arena))
+    , m_laneStart(m_numLanes + 1, 0, ArenaAllocator<int>(arena))
+    , m_liveCount(m_numLanes, 0, ArenaAllocator<int>(arena))
+    , m_moving(ArenaAllocator<Entry>(arena))
+    , m_movingLanes(ArenaAllocator<int>(arena))
+    , m_dirty(false)
+{
+    m_laneMask = m_numLanes == kMaxLanes ? ~0ULL : (1ULL << m_numLanes) - 1;
+    
+    // As many slots as EnemyManager reserves in its pools
+    for (auto& slotLanes : m_slotLanes) {
+        slotLanes = IntList(ArenaAllocator<int>(arena));
+        slotLanes.reserve(32);
+    }
+    m_moving.reserve(8);
+    m_movingLanes.reserve(8);
+}
+
+void LaneIndex::add(EnemyHandle enemy, int lane, float depth) {
+    if (enemy.type >= Enemy::kTypeCount || enemy.slot == kNoSlot || lane < 0 || lane >= m_numLanes) {
+        return;
+    }
+    
+    IntList& slotLanes = m_slotLanes[enemy.type];
+    if (enemy.slot >= slotLanes.size()) {
+        slotLanes.resize(enemy.slot + 1, -1);
+    }
+    if (slotLanes[enemy.slot] < 0) {
+        slotLanes[enemy.slot] = lane;
+        insert(Entry{depth, enemy}, lane);
+    }
+}
+
+void LaneIndex::remove(EnemyHandle enemy) {
+    int* lane = findSlotLane(enemy);
+    if (!lane || *lane < 0) {
+        return;
+    }
+    
+    int index = findEntry(enemy, *lane);
+    if (index >= 0) {
+        m_entries[index].enemy.slot = kNoSlot;
+        m_dirty = true;
+        if (--m_liveCount[*lane] == 0) {
+            m_occupancy &= ~(1ULL << *lane);
+        }
+    }
+    *lane = -1;
+}
+
+void LaneIndex::relocate(EnemyHandle enemy, std::uint16_t slot) {
+    int* lane = findSlotLane(enemy);
+    if (!lane || *lane < 0 || slot >= m_slotLanes[enemy.type].size()) {
+        return;
+    }
+    
+    int index = findEntry(enemy, *lane);
+    if (index >= 0) {
+        m_entries[index].enemy.slot = slot;
+    }
+    m_slotLanes[enemy.type][slot] = *lane;
+    *lane = -1;
+}
+
+bool LaneIndex::contains(EnemyHandle enemy) const {
+    return enemy.type < Enemy::kTypeCount && enemy.slot < m_slotLanes[enemy.type].size() &&
+           m_slotLanes[enemy.type][enemy.slot] >= 0;
+}
+
+void LaneIndex::clear() {
+    m_entries.clear();
+    std::fill(m_laneStart.begin(), m_laneStart.end(), 0);
+    std::fill(m_liveCount.begin(), m_liveCount.end(), 0);
+    for (auto& slotLanes : m_slotLanes) {
+        slotLanes.clear();
+    }
+    m_moving.clear();
+    m_movingLanes.clear();
+    m_occupancy = 0;
+    m_dirty = false;
+}
+
+int LaneIndex::getNumLanes() const {
+    return m_numLanes;
+}
+
+std::uint64_t LaneIndex::getOccupancy() const {
+    return m_occupancy;
+}
+
+bool LaneIndex::isOccupied(int lane) const {
+    return lane >= 0 && lane < m_numLanes && (m_occupancy >> lane) & 1ULL;
+}
+
+const LaneIndex::Entry* LaneIndex::findNearest(int lane, float fromDepth) const {
+    if (lane < 0 || lane >= m_numLanes) {
+        return nullptr;
+    }
+    
+    const Entry* end = m_entries.data() + m_laneStart[lane + 1];
+    for (const Entry* entry = lowerBound(lane, fromDepth); entry != end; ++entry) {
+        if (entry->enemy.slot != kNoSlot) {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+int LaneIndex::getCount(int lane) const {
+    return lane >= 0 && lane < m_numLanes ? m_liveCount[lane] : 0;
+}
+
+int LaneIndex::findNearestEmpty(int lane) const {
+    std::uint64_t empty = ~m_occupancy & m_laneMask;
+    if (empty == 0 || lane < 0 || lane >= m_numLanes) {
+        return -1;
+    }
+    
+    // Rotate the mask so the given lane is bit 0; the nearest empty lane
+    // clockwise is then the lowest set bit, counter-clockwise the highest
+    std::uint64_t rotated = lane == 0 ? empty
+        : ((empty >> lane) | (empty << (m_numLanes - lane))) & m_laneMask;
+    int forward = lowestBit(rotated);
+    int backward = m_numLanes - highestBit(rotated);
+    
+    if (forward == 0) {
+        return lane;
+    }
+    return forward <= backward ? (lane + forward) % m_numLanes
+                               : (lane - backward + m_numLanes) % m_numLanes;
+}
+
+const LaneIndex::Entry* LaneIndex::lowerBound(int lane, float depth) const {
+    const Entry* first = m_entries.data() + m_laneStart[lane];
+    const Entry* last = m_entries.data() + m_laneStart[lane + 1];
+    return std::lower_bound(first, last, depth, [](const Entry& entry, float value) {
+        return entry.depth < value;
+    });
+}
+
+int* LaneIndex::findSlotLane(EnemyHandle enemy) {
+    if (enemy.type >= Enemy::kTypeCount || enemy.slot >= m_slotLanes[enemy.type].size()) {
+        return nullptr;
+    }
+    return &m_slotLanes[enemy.type][enemy.slot];
+}
+
+int LaneIndex::findEntry(EnemyHandle enemy, int lane) const {
+    // A lane holds a handful of enemies
+    for (int i = m_laneStart[lane]; i < m_laneStart[lane + 1]; ++i) {
+        if (m_entries[i].enemy.type == enemy.type && m_entries[i].enemy.slot == enemy.slot) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void LaneIndex::insert(const Entry& entry, int lane) {
+    const Entry* first = m_entries.data() + m_laneStart[lane];
+    const Entry* last = m_entries.data() + m_laneStart[lane + 1];
+    std::ptrdiff_t offset = std::upper_bound(first, last, entry, isCloser) - m_entries.data();
+    m_entries.insert(m_entries.begin() + offset, entry);
+    
+    for (int later = lane + 1; later <= m_numLanes; ++later) {
+        m_laneStart[later]++;
+    }
+    m_liveCount[lane]++;
+    m_occupancy |= 1ULL << lane;
+}
+
+void LaneIndex::leaveLane(int index, int lane, int newLane) {
+    Entry& entry = m_entries[index];
+    int* slotLane = findSlotLane(entry.enemy);
+    if (newLane >= 0 && newLane < m_numLanes) {
+        m_moving.push_back(entry);
+        m_movingLanes.push_back(newLane);
+        *slotLane = newLane;
+    } else {
+        *slotLane = -1;
+    }
+    
+    entry.enemy.slot = kNoSlot;
+    m_dirty = true;
+    if (--m_liveCount[lane] == 0) {
+        m_occupancy &= ~(1ULL << lane);
+    }
+}
+
+void LaneIndex::settle() {
+    // Drop the dead entries, closing up each lane
+    if (m_dirty) {
+        int kept = 0;
+        for (int lane = 0; lane < m_numLanes; ++lane) {
+            int first = m_laneStart[lane];
+            m_laneStart[lane] = kept;
+            for (int i = first; i < m_laneStart[lane + 1]; ++i) {
+                if (m_entries[i].enemy.slot != kNoSlot) {
+                    m_entries[kept++] = m_entries[i];
+                }
+            }
+        }
+        m_laneStart[m_numLanes] = kept;
+        m_entries.resize(kept);
+        m_dirty = false;
+    }
+    
+    // Depths changed a little since the last sort, so insertion sort finds
+    // each lane nearly in order already
+    for (int lane = 0; lane < m_numLanes; ++lane) {
+        Entry* first = m_entries.data() + m_laneStart[lane];
+        Entry* last = m_entries.data() + m_laneStart[lane + 1];
+        for (Entry* i = first + 1; i < last; ++i) {
+            Entry entry = *i;
+            Entry* j = i;
+            while (j > first && isCloser(entry, *(j - 1))) {
+                *j = *(j - 1);
+                --j;
+            }
+            *j = entry;
+        }
+    }
+    
+    for (std::size_t i = 0; i < m_moving.size(); ++i) {
+        insert(m_moving[i], m_movingLanes[i]);
+    }
+    m_moving.clear();
+    m_movingLanes.clear();
+}
+
+} // namespace tempest
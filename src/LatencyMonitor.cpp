@@ -0,0 +1,132 @@
+#include "LatencyMonitor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace tempest {
+
+namespace {
+
+// Inputs awaiting a present; screens that don't redraw can collect many
+const std::size_t kMaxPendingInputs = 64;
+
+double toMilliseconds(LatencyMonitor::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void formatPercentiles(std::ostream& out, const char* name, const LatencyMonitor::Percentiles& p) {
+    out << "\n  " << std::left << std::setw(16) << name << std::right;
+    if (p.samples == 0) {
+        out << "no samples";
+        return;
+    }
+    out << "p50 " << std::setw(7) << p.p50
+        << "  p95 " << std::setw(7) << p.p95
+        << "  p99 " << std::setw(7) << p.p99
+        << "  max " << std::setw(7) << p.max
+        << " ms (" << p.samples << " samples)";
+}
+
+} // namespace
+
+LatencyMonitor::SampleRing::SampleRing(std::size_t capacity)
+    : m_values(capacity > 0 ? capacity : 1, 0.0)
+    , m_next(0)
+    , m_count(0)
+{
+}
+
+void LatencyMonitor::SampleRing::add(double value) {
+    m_values[m_next] = value;
+    m_next = (m_next + 1) % m_values.size();
+    m_count = std::min(m_count + 1, m_values.size());
+}
+
+LatencyMonitor::Percentiles LatencyMonitor::SampleRing::getPercentiles() const {
+    Percentiles result = {m_count, 0.0, 0.0, 0.0, 0.0};
+    if (m_count == 0) {
+        return result;
+    }
+    
+    // Reporting is rare, so sorting a copy is fine
+    std::vector<double> sorted(m_values.begin(), m_values.begin() + m_count);
+    std::sort(sorted.begin(), sorted.end());
+    
+    auto at = [&sorted](double fraction) {
+        std::size_t index = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, index > 0 ? index - 1 : 0)];
+    };
+    result.p50 = at(0.50);
+    result.p95 = at(0.95);
+    result.p99 = at(0.99);
+    result.max = sorted.back();
+    return result;
+}
+
+LatencyMonitor::LatencyMonitor(Clock::duration targetPeriod, std::size_t capacity)
+    : m_targetMilliseconds(toMilliseconds(targetPeriod))
+    , m_hasPresented(false)
+    , m_inputLatency(capacity)
+    , m_frameTime(capacity)
+    , m_jitter(capacity)
+{
+    m_pendingInputs.reserve(kMaxPendingInputs);
+}
+
+void LatencyMonitor::inputReceived(Clock::time_point time) {
+    // Past the cap the oldest are kept; they set the worst latency anyway
+    if (m_pendingInputs.size() < kMaxPendingInputs) {
+        m_pendingInputs.push_back(time);
+    }
+}
+
+void LatencyMonitor::framePresented(Clock::time_point time) {
+    attributeInputs(time);
+    
+    if (m_hasPresented) {
+        double frameTime = toMilliseconds(time - m_lastPresent);
+        m_frameTime.add(frameTime);
+        m_jitter.add(std::abs(frameTime - m_targetMilliseconds));
+    }
+    m_lastPresent = time;
+    m_hasPresented = true;
+}
+
+void LatencyMonitor::idleFramePresented(Clock::time_point time) {
+    // The wait before it is not a frame time
+    attributeInputs(time);
+    m_lastPresent = time;
+    m_hasPresented = false;
+}
+
+void LatencyMonitor::attributeInputs(Clock::time_point time) {
+    for (const auto& input : m_pendingInputs) {
+        m_inputLatency.add(toMilliseconds(time - input));
+    }
+    m_pendingInputs.clear();
+}
+
+LatencyMonitor::Percentiles LatencyMonitor::getInputLatency() const {
+    return m_inputLatency.getPercentiles();
+}
+
+LatencyMonitor::Percentiles LatencyMonitor::getFrameTime() const {
+    return m_frameTime.getPercentiles();
+}
+
+LatencyMonitor::Percentiles LatencyMonitor::getJitter() const {
+    return m_jitter.getPercentiles();
+}
+
+std::string LatencyMonitor::getReport() const {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3)
+       << "Frame timing (target " << m_targetMilliseconds << " ms):";
+    formatPercentiles(ss, "input->present", getInputLatency());
+    formatPercentiles(ss, "frame time", getFrameTime());
+    formatPercentiles(ss, "jitter", getJitter());
+    return ss.str();
+}
+
+} // namespace tempest
@@ -0,0 +1,34 @@
+#include "Layout.hpp"
+
+namespace tempest {
+
+namespace layout {
+
+sf::FloatRect getArea() {
+    return sf::FloatRect(-kWidth / 2.0f, -kHeight / 2.0f, kWidth, kHeight);
+}
+
+sf::Vector2f fromDesign(float x, float y) {
+    return sf::Vector2f((x - 400.0f) * kPixel, (y - 300.0f) * kPixel);
+}
+
+sf::FloatRect getLetterbox(unsigned width, unsigned height) {
+    if (width == 0 || height == 0) {
+        return sf::FloatRect(0.0f, 0.0f, 1.0f, 1.0f);
+    }
+    
+    float outputAspect = static_cast<float>(width) / static_cast<float>(height);
+    if (outputAspect > kAspect) {
+        // Wider than 4:3: bars left and right
+        float fraction = kAspect / outputAspect;
+        return sf::FloatRect((1.0f - fraction) / 2.0f, 0.0f, fraction, 1.0f);
+    }
+    
+    // Taller: bars top and bottom
+    float fraction = outputAspect / kAspect;
+    return sf::FloatRect(0.0f, (1.0f - fraction) / 2.0f, 1.0f, fraction);
+}
+
+} // namespace layout
+
+} // namespace tempest
@@ -10,6 +10,7 @@ Level::Level(int levelNumber, Playfield::Type playfieldType, int numSegments)
     // Calculate enemy spawn rate and speed based on level number
     m_enemySpawnRate = 0.5f + (levelNumber * 0.1f);
     m_enemySpeed = 1.0f + (levelNumber * 0.05f);
+    m_enemyQuota = 8 + (levelNumber * 2);
 }
 
 int Level::getLevelNumber() const {
@@ -32,4 +33,8 @@ float Level::getEnemySpeed() const {
     return m_enemySpeed;
 }
 
+int Level::getEnemyQuota() const {
+    return m_enemyQuota;
+}
+
 } // namespace tempest
@@ -0,0 +1,124 @@
+#include "LevelArena.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace tempest {
+
+const std::size_t LevelArena::kDefaultChunkSize;
+const std::size_t LevelArena::kBlockAlignment;
+const std::size_t LevelArena::kMinBlockSize;
+const std::size_t LevelArena::kSizeClassCount;
+
+LevelArena::LevelArena(std::size_t chunkSize)
+    : m_chunkSize(chunkSize)
+    , m_currentChunk(0)
+    , m_offset(0)
+    , m_stats()
+{
+    std::fill(m_freeLists, m_freeLists + kSizeClassCount, nullptr);
+    addChunk(m_chunkSize);
+}
+
+void* LevelArena::allocate(std::size_t size, std::size_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    // Walk forward through the chunks kept from earlier levels before
+    // reserving a new one
+    while (true) {
+        Chunk& chunk = m_chunks[m_currentChunk];
+        std::uintptr_t base = reinterpret_cast<std::uintptr_t>(chunk.data.get());
+        std::uintptr_t aligned = (base + m_offset + alignment - 1) & ~(alignment - 1);
+        std::size_t start = static_cast<std::size_t>(aligned - base);
+
+        if (start + size <= chunk.size) {
+            m_stats.bytesUsed += (start - m_offset) + size;
+            m_stats.peakBytesUsed = std::max(m_stats.peakBytesUsed, m_stats.bytesUsed);
+            m_offset = start + size;
+            return chunk.data.get() + start;
+        }
+
+        if (m_currentChunk + 1 == m_chunks.size()) {
+            addChunk(size + alignment);
+        }
+        ++m_currentChunk;
+        m_offset = 0;
+    }
+}
+
+void* LevelArena::acquireBlock(std::size_t size) {
+    std::size_t sizeClass = sizeClassFor(size);
+
+    if (sizeClass >= kSizeClassCount) {
+        // Too big to pool; it stays put until the level ends
+        m_stats.unpooledBytes += size;
+        return allocate(size, kBlockAlignment);
+    }
+
+    ++m_stats.liveBlocks;
+    m_stats.peakLiveBlocks = std::max(m_stats.peakLiveBlocks, m_stats.liveBlocks);
+
+    FreeBlock* block = m_freeLists[sizeClass];
+    if (block) {
+        m_freeLists[sizeClass] = block->next;
+        ++m_stats.blocksRecycled;
+        return block;
+    }
+
+    return allocate(kMinBlockSize << sizeClass, kBlockAlignment);
+}
+
+void LevelArena::releaseBlock(void* block, std::size_t size) {
+    if (!block) {
+        return;
+    }
+
+    std::size_t sizeClass = sizeClassFor(size);
+    if (sizeClass >= kSizeClassCount) {
+        return;
+    }
+
+    FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+    freeBlock->next = m_freeLists[sizeClass];
+    m_freeLists[sizeClass] = freeBlock;
+    --m_stats.liveBlocks;
+}
+
+void LevelArena::reset() {
+    m_currentChunk = 0;
+    m_offset = 0;
+    std::fill(m_freeLists, m_freeLists + kSizeClassCount, nullptr);
+
+    m_stats.bytesUsed = 0;
+    m_stats.liveBlocks = 0;
+    m_stats.blocksRecycled = 0;
+    m_stats.unpooledBytes = 0;
+    ++m_stats.resetCount;
+}
+
+const LevelArena::Stats& LevelArena::getStats() const {
+    return m_stats;
+}
+
+std::size_t LevelArena::sizeClassFor(std::size_t size) {
+    std::size_t sizeClass = 0;
+    std::size_t blockSize = kMinBlockSize;
+    while (blockSize < size && sizeClass < kSizeClassCount) {
+        blockSize <<= 1;
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+void LevelArena::addChunk(std::size_t minSize) {
+    Chunk chunk;
+    chunk.size = std::max(m_chunkSize, minSize);
+    chunk.data.reset(new unsigned char[chunk.size]);
+
+    m_stats.bytesReserved += chunk.size;
+    m_chunks.push_back(std::move(chunk));
+    m_stats.chunkCount = m_chunks.size();
+}
+
+} // namespace tempest
@@ -1,4 +1,5 @@
 #include "LevelManager.hpp"
+#include "StateStream.hpp"
 
 namespace tempest {
 
@@ -32,10 +33,23 @@ float LevelManager::getEnemySpeed() const {
     return m_levels[m_currentLevelIndex].getEnemySpeed();
 }
 
+int LevelManager::getEnemyQuota() const {
+    return m_levels[m_currentLevelIndex].getEnemyQuota();
+}
+
 int LevelManager::getNumSegments() const {
     return m_levels[m_currentLevelIndex].getNumSegments();
 }
 
+void LevelManager::saveState(StateWriter& out) const {
+    out.writeInt(m_currentLevelIndex);
+}
+
+void LevelManager::loadState(StateReader& in) {
+    int index = in.readInt();
+    m_currentLevelIndex = index >= 0 && index < static_cast<int>(m_levels.size()) ? index : 0;
+}
+
 void LevelManager::initializeLevels() {
     // Create a variety of levels with different playfield shapes
     m_levels.emplace_back(1, Playfield::Type::CIRCLE, 16);
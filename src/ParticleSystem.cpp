@@ -0,0 +1,201 @@
+#include "ParticleSystem.hpp"
+#include <algorithm>
+#include <cmath>
+#include "EnemyTraits.hpp"
+#include "Layout.hpp"
+#include "SoftwareRasterizer.hpp"
+
+namespace tempest {
+
+namespace {
+
+// Fraction of velocity kept after one second
+const float kDrag = 0.15f;
+
+// Length of a particle's streak, as seconds of travel
+const float kStreakSeconds = 0.03f;
+
+const float kExplosionLifetime = 0.6f;
+
+const int kPlayerDeathParticles = 128;
+const float kPlayerDeathSpeed = 260.0f; // Design pixels per second
+const float kPlayerDeathLifetime = 1.2f;
+
+const int kSuperzapParticles = 40;
+const float kSuperzapSpeed = 200.0f;
+const float kSuperzapLifetime = 0.8f;
+
+} // namespace
+
+ParticleSystem::ParticleSystem(std::uint64_t seed, std::size_t capacity)
+    : m_capacity(capacity)
+    , m_count(0)
+    , m_dropped(0)
+    , m_x(capacity)
+    , m_y(capacity)
+    , m_velocityX(capacity)
+    , m_velocityY(capacity)
+    , m_age(capacity)
+    , m_lifetime(capacity)
+    , m_color(capacity)
+    , m_vertices(capacity * 2)
+    , m_vertexCount(0)
+    , m_random(seed)
+{
+}
+
+void ParticleSystem::onEvents(const GameEventQueue& events) {
+    for (const EnemyKilledEvent& event : events.get<EnemyKilledEvent>()) {
+        emitExplosion(event.type, event.position);
+    }
+    
+    // A cleared tube has no kill events; one burst per lane it emptied
+    for (const SuperzapperFiredEvent& event : events.get<SuperzapperFiredEvent>()) {
+        for (int lane = 0; lane < LaneIndex::kMaxLanes; ++lane) {
+            if ((event.lanes >> lane) & 1ULL) {
+                emitSuperzap(event.nearest[lane]);
+            }
+        }
+    }
+    
+    for (const PlayerHitEvent& event : events.get<PlayerHitEvent>()) {
+        emitPlayerDeath(event.position);
+    }
+}
+
+void ParticleSystem::emit(const sf::Vector2f& position, const sf::Color& color, int count,
+                          float speed, float lifetime) {
+    for (int n = 0; n < count; ++n) {
+        if (m_count == m_capacity) {
+            m_dropped += count - n;
+            return;
+        }
+        
+        // Random direction; speed and lifetime vary so the burst isn't a ring
+        float angle = m_random.nextFloat() * 2.0f * static_cast<float>(M_PI);
+        float particleSpeed = speed * (0.3f + 0.7f * m_random.nextFloat());
+        
+        std::size_t i = m_count++;
+        m_x[i] = position.x;
+        m_y[i] = position.y;
+        m_velocityX[i] = std::cos(angle) * particleSpeed;
+        m_velocityY[i] = std::sin(angle) * particleSpeed;
+        m_age[i] = 0.0f;
+        m_lifetime[i] = lifetime * (0.5f + 0.5f * m_random.nextFloat());
+        m_color[i] = color;
+    }
+}
+
+void ParticleSystem::emitExplosion(Enemy::Type type, const sf::Vector2f& position) {
+    const EnemyTypeInfo& info = getEnemyTypeInfo(type);
+    emit(position, info.pulseColor(false), info.explosionParticles,
+         info.explosionSpeed * layout::kPixel, kExplosionLifetime);
+}
+
+void ParticleSystem::emitPlayerDeath(const sf::Vector2f& position) {
+    // Two colors, like the arcade's player break-up
+    int half = kPlayerDeathParticles / 2;
+    emit(position, sf::Color::Yellow, half, kPlayerDeathSpeed * layout::kPixel, kPlayerDeathLifetime);
+    emit(position, sf::Color::Green, kPlayerDeathParticles - half,
+         kPlayerDeathSpeed * 0.6f * layout::kPixel, kPlayerDeathLifetime);
+}
+
+void ParticleSystem::emitSuperzap(const sf::Vector2f& position) {
+    // Two-tone, brighter than a kill, so it reads as the zap
+    int half = kSuperzapParticles / 2;
+    emit(position, sf::Color::White, half, kSuperzapSpeed * layout::kPixel, kSuperzapLifetime);
+    emit(position, sf::Color::Cyan, kSuperzapParticles - half,
+         kSuperzapSpeed * 0.5f * layout::kPixel, kSuperzapLifetime);
+}
+
+void ParticleSystem::update(float deltaTime) {
+    const float drag = std::pow(kDrag, deltaTime);
+    const std::size_t count = m_count;
+    float* x = m_x.data();
+    float* y = m_y.data();
+    float* velocityX = m_velocityX.data();
+    float* velocityY = m_velocityY.data();
+    float* age = m_age.data();
+    
+    // Straight-line loops over separate arrays, no branches: vectorizable
+    for (std::size_t i = 0; i < count; ++i) {
+        x[i] += velocityX[i] * deltaTime;
+        y[i] += velocityY[i] * deltaTime;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        velocityX[i] *= drag;
+        velocityY[i] *= drag;
+        age[i] += deltaTime;
+    }
+    
+    retireExpired();
+    buildVertices();
+}
+
+void ParticleSystem::retireExpired() {
+    // Order doesn't matter, so the last particle fills each hole
+    std::size_t i = 0;
+    while (i < m_count) {
+        if (m_age[i] < m_lifetime[i]) {
+            ++i;
+            continue;
+        }
+        
+        std::size_t last = --m_count;
+        m_x[i] = m_x[last];
+        m_y[i] = m_y[last];
+        m_velocityX[i] = m_velocityX[last];
+        m_velocityY[i] = m_velocityY[last];
+        m_age[i] = m_age[last];
+        m_lifetime[i] = m_lifetime[last];
+        m_color[i] = m_color[last];
+    }
+}
+
+void ParticleSystem::buildVertices() {
+    for (std::size_t i = 0; i < m_count; ++i) {
+        // Fade out over the particle's life
+        sf::Color color = m_color[i];
+        color.a = static_cast<sf::Uint8>(255.0f * (1.0f - m_age[i] / m_lifetime[i]));
+        
+        sf::Vertex& head = m_vertices[i * 2];
+        sf::Vertex& tail = m_vertices[i * 2 + 1];
+        head.position = sf::Vector2f(m_x[i], m_y[i]);
+        head.color = color;
+        tail.position = sf::Vector2f(m_x[i] - m_velocityX[i] * kStreakSeconds,
+                                     m_y[i] - m_velocityY[i] * kStreakSeconds);
+        tail.color = color;
+    }
+    m_vertexCount = m_count * 2;
+}
+
+void ParticleSystem::clear() {
+    m_count = 0;
+    m_vertexCount = 0;
+}
+
+void ParticleSystem::draw(sf::RenderTarget& target) const {
+    if (m_vertexCount > 0) {
+        target.draw(m_vertices.data(), m_vertexCount, sf::Lines);
+    }
+}
+
+void ParticleSystem::draw(SoftwareRasterizer& rasterizer) const {
+    if (m_vertexCount > 0) {
+        rasterizer.draw(m_vertices.data(), m_vertexCount, sf::Lines);
+    }
+}
+
+std::size_t ParticleSystem::getCount() const {
+    return m_count;
+}
+
+std::size_t ParticleSystem::getCapacity() const {
+    return m_capacity;
+}
+
+std::size_t ParticleSystem::getDropped() const {
+    return m_dropped;
+}
+
+} // namespace tempest
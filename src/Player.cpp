@@ -1,15 +1,23 @@
 #include "Player.hpp"
 #include <cmath>
+#include "Layout.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "StateStream.hpp"
 
 namespace tempest {
 
+const float Player::kShotCooldown = 0.2f;
+const int Player::kSpinUnitsPerLane;
+
 Player::Player()
     : m_playfield(nullptr)
+    , m_arithmetic(Arithmetic::FLOAT)
     , m_position(0)
+    , m_spinOffset(0)
     , m_lives(3)
     , m_score(0)
-    , m_superzapperCharges(1)
-    , m_shootCooldown(0.0f)
+    , m_superzapperCharges(kSuperzapperCharges)
+    , m_shotReady(true)
 {
     m_shape.setPointCount(3);
     m_shape.setFillColor(sf::Color::Green);
@@ -17,16 +25,36 @@ Player::Player()
 
 Player::Player(Playfield& playfield)
     : m_playfield(&playfield)
+    , m_arithmetic(Arithmetic::FLOAT)
     , m_position(0)
+    , m_spinOffset(0)
     , m_lives(3)
     , m_score(0)
-    , m_superzapperCharges(1)
-    , m_shootCooldown(0.0f)
+    , m_superzapperCharges(kSuperzapperCharges)
+    , m_shotReady(true)
 {
     m_shape.setPointCount(3);
     m_shape.setFillColor(sf::Color::Green);
 }
 
+Player::Player(Playfield& playfield, LevelArena& arena, Arithmetic arithmetic)
+    : m_playfield(&playfield)
+    , m_arithmetic(arithmetic)
+    , m_position(0)
+    , m_spinOffset(0)
+    , m_lives(3)
+    , m_score(0)
+    , m_superzapperCharges(kSuperzapperCharges)
+    , m_shotReady(true)
+    , m_shots(ArenaAllocator<Shot>(&arena))
+{
+    m_shape.setPointCount(3);
+    m_shape.setFillColor(sf::Color::Green);
+    
+    // Shots live for well under a second at the fire rate, so this is plenty
+    m_shots.reserve(16);
+}
+
 void Player::moveLeft() {
     if (m_playfield) {
         m_position = (m_position - 1 + m_playfield->getNumSegments()) % m_playfield->getNumSegments();
@@ -39,30 +67,52 @@ void Player::moveRight() {
     }
 }
 
-void Player::shoot() {
-    if (m_playfield && m_shootCooldown <= 0.0f) {
-        sf::Vector2f pos = m_playfield->getPointPosition(m_position, 0.0f);
-        sf::Vector2f dir = m_playfield->getLaneDirection(m_position);
-        
-        m_shots.emplace_back(pos, dir);
-        m_shootCooldown = 0.2f; // 0.2 seconds between shots
+void Player::spin(int units) {
+    const int half = kSpinUnitsPerLane / 2;
+    m_spinOffset += units;
+    while (m_spinOffset > half) {
+        moveRight();
+        m_spinOffset -= kSpinUnitsPerLane;
+    }
+    while (m_spinOffset < -half) {
+        moveLeft();
+        m_spinOffset += kSpinUnitsPerLane;
     }
 }
 
-void Player::useSuperzapper() {
+bool Player::shoot() {
+    if (m_playfield && m_shotReady) {
+        if (m_arithmetic == Arithmetic::FIXED_POINT) {
+            m_shots.emplace_back(m_position, *m_playfield);
+        } else {
+            sf::Vector2f pos = m_playfield->getPointPosition(m_position, 0.0f);
+            sf::Vector2f dir = m_playfield->getLaneDirection(m_position);
+            m_shots.emplace_back(pos, dir, m_position);
+        }
+        m_shotReady = false;
+        return true;
+    }
+    return false;
+}
+
+bool Player::useSuperzapper() {
     if (m_superzapperCharges > 0) {
-        // Signal to game to clear all enemies
-        // This will be handled in Game::checkCollisions
+        // The simulation decides what this charge destroys
         m_superzapperCharges--;
+        return true;
     }
+    return false;
+}
+
+void Player::reload() {
+    m_shotReady = true;
+}
+
+bool Player::isShotReady() const {
+    return m_shotReady;
 }
 
 void Player::update(float deltaTime) {
-    // Update shoot cooldown
-    if (m_shootCooldown > 0.0f) {
-        m_shootCooldown -= deltaTime;
-    }
-    
     // Update shots
     for (auto it = m_shots.begin(); it != m_shots.end();) {
         it->update(deltaTime);
@@ -73,7 +123,10 @@ void Player::update(float deltaTime) {
         }
     }
     
-    // Update player shape
+    updateShape();
+}
+
+void Player::updateShape() {
     if (m_playfield) {
         sf::Vector2f pos = m_playfield->getPointPosition(m_position, 0.0f);
         sf::Vector2f dir = m_playfield->getLaneDirection(m_position);
@@ -82,20 +135,28 @@ void Player::update(float deltaTime) {
         sf::Vector2f perpDir(-dir.y, dir.x);
         
         // Set player shape points
-        float size = 15.0f;
+        float size = 15.0f * layout::kPixel;
         m_shape.setPoint(0, pos);
         m_shape.setPoint(1, pos - dir * size + perpDir * size * 0.5f);
         m_shape.setPoint(2, pos - dir * size - perpDir * size * 0.5f);
     }
 }
 
-void Player::draw(sf::RenderWindow& window) {
+void Player::draw(sf::RenderTarget& target) {
     // Draw player
-    window.draw(m_shape);
+    target.draw(m_shape);
     
     // Draw shots
     for (auto& shot : m_shots) {
-        shot.draw(window);
+        shot.draw(target);
+    }
+}
+
+void Player::draw(SoftwareRasterizer& rasterizer) const {
+    rasterizer.draw(m_shape);
+    
+    for (const auto& shot : m_shots) {
+        shot.draw(rasterizer);
     }
 }
 
@@ -111,8 +172,46 @@ int Player::getScore() const {
     return m_score;
 }
 
-const std::vector<Shot>& Player::getShots() const {
+int Player::getSuperzapperCharges() const {
+    return m_superzapperCharges;
+}
+
+const Player::ShotList& Player::getShots() const {
     return m_shots;
 }
 
+void Player::saveState(StateWriter& out) const {
+    out.writeInt(m_position);
+    out.writeInt(m_spinOffset);
+    out.writeInt(m_lives);
+    out.writeInt(m_score);
+    out.writeInt(m_superzapperCharges);
+    out.writeBool(m_shotReady);
+    out.writeU32(static_cast<std::uint32_t>(m_shots.size()));
+    for (const Shot& shot : m_shots) {
+        shot.saveState(out);
+    }
+}
+
+void Player::loadState(StateReader& in) {
+    m_position = in.readInt();
+    m_spinOffset = in.readInt();
+    m_lives = in.readInt();
+    m_score = in.readInt();
+    m_superzapperCharges = in.readInt();
+    m_shotReady = in.readBool();
+    
+    m_shots.clear();
+    std::size_t count = in.readCount(25);
+    for (std::size_t i = 0; i < count && m_playfield; ++i) {
+        if (m_arithmetic == Arithmetic::FIXED_POINT) {
+            m_shots.emplace_back(0, *m_playfield);
+        } else {
+            m_shots.emplace_back(sf::Vector2f(), sf::Vector2f(), 0);
+        }
+        m_shots.back().loadState(in);
+    }
+    updateShape();
+}
+
 } // namespace tempest
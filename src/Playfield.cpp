@@ -1,14 +1,28 @@
 #include "Playfield.hpp"
+#include <algorithm>
 #include <cmath>
+#include "Layout.hpp"
+#include "SoftwareRasterizer.hpp"
 
 namespace tempest {
 
+Playfield::Projection Playfield::getDefaultProjection() {
+    // Spanning the logical height, this puts the rim (radius 1 at distance
+    // 2) 250 design pixels from the axis and the far end (distance 10) at 50
+    Projection projection;
+    projection.tubeRadius = 1.0f;
+    projection.tubeLength = 8.0f;
+    projection.cameraDistance = 2.0f;
+    projection.fieldOfView = 61.9275f;
+    projection.viewportHeight = layout::kHeight;
+    return projection;
+}
+
 Playfield::Playfield() 
     : m_type(Type::CIRCLE)
     , m_numSegments(16)
-    , m_center(400.0f, 300.0f)
-    , m_outerRadius(250.0f)
-    , m_innerRadius(50.0f)
+    , m_center(0.0f, 0.0f) // The tube axis is the logical origin
+    , m_projection(getDefaultProjection())
 {
     generateShape();
 }
@@ -16,37 +30,72 @@ Playfield::Playfield()
 Playfield::Playfield(Type type, int numSegments)
     : m_type(type)
     , m_numSegments(numSegments)
-    , m_center(400.0f, 300.0f)
-    , m_outerRadius(250.0f)
-    , m_innerRadius(50.0f)
+    , m_center(0.0f, 0.0f) // The tube axis is the logical origin
+    , m_projection(getDefaultProjection())
 {
     generateShape();
 }
 
-void Playfield::draw(sf::RenderWindow& window) {
-    for (const auto& lane : m_lanes) {
-        window.draw(lane);
-    }
+Playfield::Playfield(Type type, int numSegments, LevelArena& arena, const Projection& projection)
+    : m_type(type)
+    , m_numSegments(numSegments)
+    , m_center(0.0f, 0.0f) // The tube axis is the logical origin
+    , m_lines(ArenaAllocator<sf::Vertex>(&arena))
+    , m_laneTable(&arena)
+    , m_projection(projection)
+{
+    generateShape();
+}
+
+void Playfield::draw(sf::RenderTarget& target) {
+    target.draw(m_lines.data(), m_lines.size(), sf::Lines);
+}
+
+void Playfield::draw(SoftwareRasterizer& rasterizer) const {
+    rasterizer.draw(m_lines.data(), m_lines.size(), sf::Lines);
 }
 
 sf::Vector2f Playfield::getPointPosition(int segment, float depth) const {
+    // Clamp depth between 0 (outer edge) and 1 (inner edge)
+    depth = std::max(0.0f, std::min(1.0f, depth));
+    
+    return m_center + getRimOffset(segment) * getProjectedRadius(depth);
+}
+
+sf::Vector2f Playfield::getTablePosition(int segment, Fixed depth) const {
+    // The bucket and lerp weight come straight from the depth's bits
+    depth = std::max<Fixed>(0, std::min(fixed::kOne, depth));
+    
+    std::int64_t scaled = static_cast<std::int64_t>(depth) * LaneTable::kDepthBuckets;
+    int bucket = static_cast<int>(scaled >> fixed::kFractionBits);
+    Fixed fraction = static_cast<Fixed>(scaled - (static_cast<std::int64_t>(bucket) << fixed::kFractionBits));
+    float t = fixed::toFloat(fraction);
+    int index = segment * LaneTable::kStride + bucket;
+    return sf::Vector2f(m_laneTable.x[index] + (m_laneTable.x[index + 1] - m_laneTable.x[index]) * t,
+                        m_laneTable.y[index] + (m_laneTable.y[index + 1] - m_laneTable.y[index]) * t);
+}
+
+float Playfield::getDepthScale(float depth) const {
+    depth = std::max(0.0f, std::min(1.0f, depth));
+    
+    float bucket = depth * LaneTable::kDepthBuckets;
+    int index = static_cast<int>(bucket);
+    float t = bucket - static_cast<float>(index);
+    return m_laneTable.scale[index] + (m_laneTable.scale[index + 1] - m_laneTable.scale[index]) * t;
+}
+
+sf::Vector2f Playfield::getRimOffset(int segment) const {
     // Ensure segment is within bounds
     segment = segment % m_numSegments;
     if (segment < 0) segment += m_numSegments;
     
-    // Clamp depth between 0 (outer edge) and 1 (inner edge)
-    depth = std::max(0.0f, std::min(1.0f, depth));
-    
-    float radius = m_outerRadius - (m_outerRadius - m_innerRadius) * depth;
+    // Cross-section of the tube at unit radius
     float angle = 0.0f;
     
     switch (m_type) {
         case Type::CIRCLE:
             angle = 2.0f * M_PI * segment / m_numSegments;
-            return sf::Vector2f(
-                m_center.x + radius * std::cos(angle),
-                m_center.y + radius * std::sin(angle)
-            );
+            return sf::Vector2f(std::cos(angle), std::sin(angle));
             
         case Type::SQUARE:
             {
@@ -55,76 +104,52 @@ sf::Vector2f Playfield::getPointPosition(int segment, float depth) const {
                 
                 switch (side) {
                     case 0: // Top
-                        return sf::Vector2f(
-                            m_center.x - radius + 2 * radius * sidePos,
-                            m_center.y - radius
-                        );
+                        return sf::Vector2f(-1.0f + 2.0f * sidePos, -1.0f);
                     case 1: // Right
-                        return sf::Vector2f(
-                            m_center.x + radius,
-                            m_center.y - radius + 2 * radius * sidePos
-                        );
+                        return sf::Vector2f(1.0f, -1.0f + 2.0f * sidePos);
                     case 2: // Bottom
-                        return sf::Vector2f(
-                            m_center.x + radius - 2 * radius * sidePos,
-                            m_center.y + radius
-                        );
+                        return sf::Vector2f(1.0f - 2.0f * sidePos, 1.0f);
                     case 3: // Left
-                        return sf::Vector2f(
-                            m_center.x - radius,
-                            m_center.y + radius - 2 * radius * sidePos
-                        );
+                        return sf::Vector2f(-1.0f, 1.0f - 2.0f * sidePos);
                     default:
-                        return m_center;
+                        return sf::Vector2f(0.0f, 0.0f);
                 }
             }
             
         case Type::HEXAGON:
             angle = 2.0f * M_PI * segment / m_numSegments;
-            return sf::Vector2f(
-                m_center.x + radius * std::cos(angle),
-                m_center.y + radius * std::sin(angle)
-            );
+            return sf::Vector2f(std::cos(angle), std::sin(angle));
             
         case Type::OCTAGON:
             angle = 2.0f * M_PI * segment / m_numSegments;
-            return sf::Vector2f(
-                m_center.x + radius * std::cos(angle),
-                m_center.y + radius * std::sin(angle)
-            );
+            return sf::Vector2f(std::cos(angle), std::sin(angle));
             
         case Type::PLUS:
             // Implement plus shape
             angle = 2.0f * M_PI * segment / m_numSegments;
-            return sf::Vector2f(
-                m_center.x + radius * std::cos(angle),
-                m_center.y + radius * std::sin(angle)
-            );
+            return sf::Vector2f(std::cos(angle), std::sin(angle));
             
         case Type::STAR:
             // Implement star shape
             angle = 2.0f * M_PI * segment / m_numSegments;
-            return sf::Vector2f(
-                m_center.x + radius * std::cos(angle),
-                m_center.y + radius * std::sin(angle)
-            );
+            return sf::Vector2f(std::cos(angle), std::sin(angle));
             
         case Type::TRIANGLE:
             angle = 2.0f * M_PI * segment / m_numSegments;
-            return sf::Vector2f(
-                m_center.x + radius * std::cos(angle),
-                m_center.y + radius * std::sin(angle)
-            );
+            return sf::Vector2f(std::cos(angle), std::sin(angle));
             
         default:
             angle = 2.0f * M_PI * segment / m_numSegments;
-            return sf::Vector2f(
-                m_center.x + radius * std::cos(angle),
-                m_center.y + radius * std::sin(angle)
-            );
+            return sf::Vector2f(std::cos(angle), std::sin(angle));
     }
 }
 
+float Playfield::getProjectedRadius(float depth) const {
+    // Pinhole projection: screen size falls off with distance from the camera
+    float distance = m_projection.cameraDistance + depth * m_projection.tubeLength;
+    return m_focalLength * m_projection.tubeRadius / distance;
+}
+
 sf::Vector2f Playfield::getLaneDirection(int segment) const {
     sf::Vector2f outer = getPointPosition(segment, 0.0f);
     sf::Vector2f inner = getPointPosition(segment, 1.0f);
@@ -139,44 +164,71 @@ sf::Vector2f Playfield::getLaneDirection(int segment) const {
     return direction;
 }
 
+Playfield::Type Playfield::getType() const {
+    return m_type;
+}
+
 int Playfield::getNumSegments() const {
     return m_numSegments;
 }
 
+const Playfield::Projection& Playfield::getProjection() const {
+    return m_projection;
+}
+
+const Playfield::LaneTable& Playfield::getLaneTable() const {
+    return m_laneTable;
+}
+
 void Playfield::generateShape() {
-    m_lanes.clear();
+    float halfFieldOfView = m_projection.fieldOfView * 0.5f * static_cast<float>(M_PI) / 180.0f;
+    m_focalLength = m_projection.viewportHeight * 0.5f / std::tan(halfFieldOfView);
+    
+    m_lines.clear();
+    
+    // One lane line plus one outer and one inner edge line per segment
+    m_lines.reserve(m_numSegments * 6);
     
-    // Create lanes connecting outer and inner points
     for (int i = 0; i < m_numSegments; ++i) {
-        sf::VertexArray lane(sf::Lines, 2);
-        
-        sf::Vector2f outerPoint = getPointPosition(i, 0.0f);
-        sf::Vector2f innerPoint = getPointPosition(i, 1.0f);
+        int next = (i + 1) % m_numSegments;
         
-        lane[0].position = outerPoint;
-        lane[0].color = sf::Color::Blue;
+        // Lane connecting outer and inner points
+        m_lines.emplace_back(getPointPosition(i, 0.0f), sf::Color::Blue);
+        m_lines.emplace_back(getPointPosition(i, 1.0f), sf::Color::Blue);
         
-        lane[1].position = innerPoint;
-        lane[1].color = sf::Color::Blue;
+        // Outer edge
+        m_lines.emplace_back(getPointPosition(i, 0.0f), sf::Color::Blue);
+        m_lines.emplace_back(getPointPosition(next, 0.0f), sf::Color::Blue);
         
-        m_lanes.push_back(lane);
+        // Inner edge
+        m_lines.emplace_back(getPointPosition(i, 1.0f), sf::Color::Blue);
+        m_lines.emplace_back(getPointPosition(next, 1.0f), sf::Color::Blue);
     }
     
-    // Create outer edge
-    sf::VertexArray outerEdge(sf::LineStrip, m_numSegments + 1);
-    for (int i = 0; i <= m_numSegments; ++i) {
-        outerEdge[i].position = getPointPosition(i % m_numSegments, 0.0f);
-        outerEdge[i].color = sf::Color::Blue;
+    // Lane table for batch position updates
+    const int buckets = LaneTable::kDepthBuckets;
+    const int stride = LaneTable::kStride;
+    m_laneTable.x.resize(m_numSegments * stride + 1);
+    m_laneTable.y.resize(m_numSegments * stride + 1);
+    m_laneTable.scale.resize(stride + 1);
+    
+    for (int b = 0; b <= buckets; ++b) {
+        float depth = static_cast<float>(b) / buckets;
+        m_laneTable.scale[b] = getProjectedRadius(depth) / getProjectedRadius(0.0f);
     }
-    m_lanes.push_back(outerEdge);
     
-    // Create inner edge
-    sf::VertexArray innerEdge(sf::LineStrip, m_numSegments + 1);
-    for (int i = 0; i <= m_numSegments; ++i) {
-        innerEdge[i].position = getPointPosition(i % m_numSegments, 1.0f);
-        innerEdge[i].color = sf::Color::Blue;
+    for (int i = 0; i < m_numSegments; ++i) {
+        for (int b = 0; b <= buckets; ++b) {
+            sf::Vector2f point = getPointPosition(i, static_cast<float>(b) / buckets);
+            m_laneTable.x[i * stride + b] = point.x;
+            m_laneTable.y[i * stride + b] = point.y;
+        }
     }
-    m_lanes.push_back(innerEdge);
+    
+    // Padding, only ever weighted by zero
+    m_laneTable.x.back() = m_laneTable.x[m_laneTable.x.size() - 2];
+    m_laneTable.y.back() = m_laneTable.y[m_laneTable.y.size() - 2];
+    m_laneTable.scale.back() = m_laneTable.scale[stride - 1];
 }
 
 } // namespace tempest
@@ -0,0 +1,69 @@
+#include "RenderScaler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace tempest {
+
+namespace {
+
+// Above this share of the budget the scale comes down...
+const double kHighWater = 0.9;
+
+// ...to where frames should take this share...
+const double kTarget = 0.75;
+
+// ...and below this share it goes back up
+const double kLowWater = 0.5;
+
+} // namespace
+
+const float RenderScaler::kStep = 0.0625f;
+
+RenderScaler::RenderScaler(Clock::duration budget, float minScale, float maxScale,
+                           unsigned windowFrames)
+    : m_budget(std::chrono::duration<double, std::milli>(budget).count())
+    , m_minScale(minScale)
+    , m_maxScale(maxScale)
+    , m_scale(maxScale)
+    , m_windowFrames(windowFrames > 0 ? windowFrames : 1)
+    , m_frames(0)
+    , m_total(0.0)
+{
+}
+
+bool RenderScaler::frameFinished(Clock::duration workTime) {
+    m_total += std::chrono::duration<double, std::milli>(workTime).count();
+    if (++m_frames < m_windowFrames) {
+        return false;
+    }
+    
+    double average = m_total / m_frames;
+    resetWindow();
+    
+    float scale = m_scale;
+    if (average > m_budget * kHighWater) {
+        float shrink = static_cast<float>(std::sqrt(m_budget * kTarget / average));
+        scale = std::floor(m_scale * shrink / kStep) * kStep;
+    } else if (average < m_budget * kLowWater) {
+        scale = m_scale + kStep;
+    }
+    
+    scale = std::max(m_minScale, std::min(m_maxScale, scale));
+    if (scale == m_scale) {
+        return false;
+    }
+    
+    m_scale = scale;
+    return true;
+}
+
+void RenderScaler::resetWindow() {
+    m_frames = 0;
+    m_total = 0.0;
+}
+
+float RenderScaler::getScale() const {
+    return m_scale;
+}
+
+} // namespace tempest
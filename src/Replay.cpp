@@ -0,0 +1,348 @@
+#include "Replay.hpp"
+#include <algorithm>
+#include <fstream>
+
+namespace tempest {
+
+namespace {
+
+const char kMagic[4] = {'T', 'P', 'R', 'P'};
+// 6: start snapshot; 5: state hashes; 4: arithmetic; 3: checkpoints;
+// 2: analog spin, keys turn at a fixed rate
+const std::uint32_t kVersion = 6;
+const std::uint32_t kFirstCompatibleVersion = 2;
+
+const std::uint64_t kCheckpointSize = 20; // Tick, score, level, lives
+
+enum InputBits : std::uint8_t {
+    INPUT_LEFT = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_FIRE = 1 << 2,
+    INPUT_SUPERZAPPER = 1 << 3,
+    INPUT_CONFIRM = 1 << 4,
+    INPUT_SPIN = 1 << 5
+};
+
+// Fixed little-endian layout, independent of the host
+void writeU32(std::ostream& out, std::uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    out.write(bytes, 4);
+}
+
+void writeU64(std::ostream& out, std::uint64_t value) {
+    writeU32(out, static_cast<std::uint32_t>(value));
+    writeU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+std::uint32_t readU32(std::istream& in) {
+    unsigned char bytes[4] = {0, 0, 0, 0};
+    in.read(reinterpret_cast<char*>(bytes), 4);
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+std::uint64_t readU64(std::istream& in) {
+    std::uint64_t low = readU32(in);
+    std::uint64_t high = readU32(in);
+    return low | (high << 32);
+}
+
+// Bytes from the read position to the end of a file of the given size
+std::uint64_t getRemaining(std::istream& in, std::uint64_t size) {
+    std::streamoff position = in.tellg();
+    return position < 0 || static_cast<std::uint64_t>(position) > size
+               ? 0 : size - static_cast<std::uint64_t>(position);
+}
+
+} // namespace
+
+Replay::Replay()
+    : m_seed(0)
+    , m_arithmetic(Arithmetic::FLOAT)
+    , m_highScore(0)
+    , m_tickRate(Simulation::kTickRate)
+    , m_startTick(0)
+{
+}
+
+Replay::Replay(std::uint64_t seed, int highScore, Arithmetic arithmetic)
+    : m_seed(seed)
+    , m_arithmetic(arithmetic)
+    , m_highScore(highScore)
+    , m_tickRate(Simulation::kTickRate)
+    , m_startTick(0)
+{
+    reserve();
+}
+
+void Replay::start(const Simulation& simulation) {
+    m_seed = simulation.getSeed();
+    m_arithmetic = simulation.getArithmetic();
+    m_highScore = simulation.getHighScore();
+    m_tickRate = Simulation::kTickRate;
+    m_startTick = simulation.getTickCount();
+    m_startState.clear();
+    if (m_startTick != 0) {
+        simulation.saveState(m_startState);
+    }
+    m_inputs.clear();
+    m_spins.clear();
+    m_checkpoints.clear();
+    m_stateHashes.clear();
+    reserve();
+}
+
+void Replay::reserve() {
+    // An hour of play without regrowing
+    m_inputs.reserve(Simulation::kTickRate * 3600);
+    m_spins.reserve(Simulation::kTickRate * 3600);
+    m_checkpoints.reserve(Simulation::kTickRate * 60);
+    m_stateHashes.reserve(Simulation::kTickRate * 3600);
+}
+
+void Replay::record(const PlayerInput& input) {
+    std::uint8_t bits = 0;
+    if (input.left) bits |= INPUT_LEFT;
+    if (input.right) bits |= INPUT_RIGHT;
+    if (input.fire) bits |= INPUT_FIRE;
+    if (input.superzapper) bits |= INPUT_SUPERZAPPER;
+    if (input.confirm) bits |= INPUT_CONFIRM;
+    if (input.spin != 0) bits |= INPUT_SPIN;
+    m_inputs.push_back(bits);
+    m_spins.push_back(static_cast<std::int16_t>(std::max(-32768, std::min(32767, input.spin))));
+}
+
+void Replay::recordOutcome(const Simulation& simulation) {
+    m_stateHashes.push_back(simulation.getStateHash());
+    
+    if (!m_checkpoints.empty()) {
+        const Checkpoint& last = m_checkpoints.back();
+        if (last.score == simulation.getScore() && last.level == simulation.getLevel() &&
+            last.lives == simulation.getLives()) {
+            return;
+        }
+    }
+    
+    Checkpoint checkpoint = {simulation.getTickCount(), simulation.getScore(), simulation.getLevel(),
+                             simulation.getLives()};
+    m_checkpoints.push_back(checkpoint);
+}
+
+std::uint64_t Replay::getSeed() const {
+    return m_seed;
+}
+
+Arithmetic Replay::getArithmetic() const {
+    return m_arithmetic;
+}
+
+int Replay::getHighScore() const {
+    return m_highScore;
+}
+
+int Replay::getTickRate() const {
+    return m_tickRate;
+}
+
+std::size_t Replay::getTickCount() const {
+    return m_inputs.size();
+}
+
+std::uint64_t Replay::getStartTick() const {
+    return m_startTick;
+}
+
+PlayerInput Replay::getInput(std::size_t tick) const {
+    std::uint8_t bits = m_inputs[tick];
+    PlayerInput input;
+    input.left = (bits & INPUT_LEFT) != 0;
+    input.right = (bits & INPUT_RIGHT) != 0;
+    input.fire = (bits & INPUT_FIRE) != 0;
+    input.superzapper = (bits & INPUT_SUPERZAPPER) != 0;
+    input.confirm = (bits & INPUT_CONFIRM) != 0;
+    input.spin = m_spins[tick];
+    return input;
+}
+
+const std::vector<Replay::Checkpoint>& Replay::getCheckpoints() const {
+    return m_checkpoints;
+}
+
+const std::vector<std::uint64_t>& Replay::getStateHashes() const {
+    return m_stateHashes;
+}
+
+bool Replay::restoreStart(Simulation& simulation) const {
+    simulation.setHighScore(m_highScore);
+    return m_startState.empty() || (simulation.loadState(m_startState.data(), m_startState.size()) &&
+                                    simulation.getTickCount() == m_startTick);
+}
+
+bool Replay::saveToFile(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    file.write(kMagic, sizeof(kMagic));
+    writeU32(file, kVersion);
+    writeU32(file, static_cast<std::uint32_t>(m_tickRate));
+    writeU64(file, m_seed);
+    writeU32(file, static_cast<std::uint32_t>(m_highScore));
+    writeU32(file, static_cast<std::uint32_t>(m_arithmetic));
+    writeU64(file, m_inputs.size());
+    writeU64(file, m_startTick);
+    writeU64(file, m_startState.size());
+    file.write(reinterpret_cast<const char*>(m_startState.data()), m_startState.size());
+    file.write(reinterpret_cast<const char*>(m_inputs.data()), m_inputs.size());
+    
+    // Most ticks have no spin, so only those that do are stored
+    for (std::size_t tick = 0; tick < m_inputs.size(); ++tick) {
+        if (m_inputs[tick] & INPUT_SPIN) {
+            std::uint16_t spin = static_cast<std::uint16_t>(m_spins[tick]);
+            char bytes[2] = {static_cast<char>(spin & 0xFF), static_cast<char>(spin >> 8)};
+            file.write(bytes, 2);
+        }
+    }
+    
+    writeU64(file, m_checkpoints.size());
+    for (const Checkpoint& checkpoint : m_checkpoints) {
+        writeU64(file, checkpoint.tick);
+        writeU32(file, static_cast<std::uint32_t>(checkpoint.score));
+        writeU32(file, static_cast<std::uint32_t>(checkpoint.level));
+        writeU32(file, static_cast<std::uint32_t>(checkpoint.lives));
+    }
+    
+    writeU64(file, m_stateHashes.size());
+    for (std::uint64_t hash : m_stateHashes) {
+        writeU64(file, hash);
+    }
+    return file.good();
+}
+
+bool Replay::loadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    // Every count in the file is checked against what is left of it before
+    // anything is allocated for it
+    file.seekg(0, std::ios::end);
+    std::streamoff end = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if (end < 0) {
+        return false;
+    }
+    std::uint64_t fileSize = static_cast<std::uint64_t>(end);
+    
+    char magic[4] = {0, 0, 0, 0};
+    file.read(magic, sizeof(magic));
+    if (!file || !std::equal(magic, magic + 4, kMagic)) {
+        return false;
+    }
+    
+    // Version 2 files replay the same, they just have nothing to check against
+    std::uint32_t version = readU32(file);
+    if (version < kFirstCompatibleVersion || version > kVersion) {
+        return false;
+    }
+    
+    int tickRate = static_cast<int>(readU32(file));
+    std::uint64_t seed = readU64(file);
+    int highScore = static_cast<int>(readU32(file));
+    std::uint32_t arithmetic = version >= 4 ? readU32(file) : 0;
+    std::uint64_t tickCount = readU64(file);
+    
+    // Inputs were recorded at the simulation's fixed rate; anything else
+    // would not replay the same
+    if (!file || tickRate != Simulation::kTickRate ||
+        arithmetic > static_cast<std::uint32_t>(Arithmetic::FIXED_POINT)) {
+        return false;
+    }
+    
+    // Before version 6 every recording began with the simulation
+    std::uint64_t startTick = 0;
+    std::vector<std::uint8_t> startState;
+    if (version >= 6) {
+        startTick = readU64(file);
+        std::uint64_t stateSize = readU64(file);
+        if (!file || (startTick == 0) != (stateSize == 0) || stateSize > getRemaining(file, fileSize)) {
+            return false;
+        }
+        startState.resize(static_cast<std::size_t>(stateSize));
+        file.read(reinterpret_cast<char*>(startState.data()), startState.size());
+        if (static_cast<std::uint64_t>(file.gcount()) != stateSize) {
+            return false;
+        }
+    }
+    
+    // One byte per tick at least
+    if (tickCount > getRemaining(file, fileSize)) {
+        return false;
+    }
+    std::vector<std::uint8_t> inputs(static_cast<std::size_t>(tickCount));
+    file.read(reinterpret_cast<char*>(inputs.data()), inputs.size());
+    if (static_cast<std::uint64_t>(file.gcount()) != tickCount) {
+        return false;
+    }
+    
+    std::vector<std::int16_t> spins(inputs.size(), 0);
+    for (std::size_t tick = 0; tick < inputs.size(); ++tick) {
+        if (inputs[tick] & INPUT_SPIN) {
+            unsigned char bytes[2] = {0, 0};
+            file.read(reinterpret_cast<char*>(bytes), 2);
+            spins[tick] = static_cast<std::int16_t>(bytes[0] | (bytes[1] << 8));
+        }
+    }
+    
+    std::vector<Checkpoint> checkpoints;
+    if (version >= 3) {
+        std::uint64_t checkpointCount = readU64(file);
+        if (!file || checkpointCount > tickCount ||
+            checkpointCount > getRemaining(file, fileSize) / kCheckpointSize) {
+            return false;
+        }
+        checkpoints.resize(static_cast<std::size_t>(checkpointCount));
+        for (Checkpoint& checkpoint : checkpoints) {
+            checkpoint.tick = readU64(file);
+            checkpoint.score = static_cast<int>(readU32(file));
+            checkpoint.level = static_cast<int>(readU32(file));
+            checkpoint.lives = static_cast<int>(readU32(file));
+        }
+    }
+    
+    // One per tick, or none if the outcome wasn't recorded
+    std::vector<std::uint64_t> stateHashes;
+    if (version >= 5) {
+        std::uint64_t hashCount = readU64(file);
+        if (!file || (hashCount != 0 && hashCount != tickCount) ||
+            hashCount > getRemaining(file, fileSize) / 8) {
+            return false;
+        }
+        stateHashes.resize(static_cast<std::size_t>(hashCount));
+        for (std::uint64_t& hash : stateHashes) {
+            hash = readU64(file);
+        }
+    }
+    if (!file) {
+        return false;
+    }
+    
+    m_seed = seed;
+    m_arithmetic = static_cast<Arithmetic>(arithmetic);
+    m_highScore = highScore;
+    m_tickRate = tickRate;
+    m_startTick = startTick;
+    m_startState.swap(startState);
+    m_inputs.swap(inputs);
+    m_spins.swap(spins);
+    m_checkpoints.swap(checkpoints);
+    m_stateHashes.swap(stateHashes);
+    return true;
+}
+
+} // namespace tempest
@@ -0,0 +1,440 @@
+#include "ReplayArchive.hpp"
+#include <algorithm>
+#include <fstream>
+#include "StateStream.hpp"
+
+namespace tempest {
+
+const std::uint32_t ReplayArchive::kDefaultKeyframeInterval;
+const std::uint32_t ReplayArchive::kAnchorInterval;
+
+namespace {
+
+const char kMagic[4] = {'T', 'P', 'R', 'A'};
+const char kIndexMagic[4] = {'T', 'P', 'R', 'X'};
+// 5: start tick, for replays of one game; 4: spawn quota in the snapshots; 3: state hash in them; 2: arithmetic, and in them
+const std::uint32_t kVersion = 5;
+
+const std::size_t kHeaderSize = 48;
+const std::size_t kIndexEntrySize = 40;
+const std::size_t kTrailerSize = 16;
+
+// Far above any real snapshot (a few KB), so a bad index can't make a seek
+// allocate without bound
+const std::uint32_t kMaxSnapshotSize = 1 << 20;
+
+// Keyframe flags
+const std::uint32_t kKeyframeAnchor = 1 << 0; // Stored whole rather than against the previous one
+
+enum InputBits : std::uint8_t {
+    INPUT_LEFT = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_FIRE = 1 << 2,
+    INPUT_SUPERZAPPER = 1 << 3,
+    INPUT_CONFIRM = 1 << 4
+};
+
+void writeVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// False past the end or on more than 64 bits
+bool readVarint(const std::uint8_t*& data, const std::uint8_t* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (data == end) {
+            return false;
+        }
+        std::uint8_t byte = *data++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A snapshot XORed with the one before (zero past the end of the shorter),
+// as pairs of (unchanged byte count, changed byte count, changed bytes).
+// Against an empty base that is simply the snapshot, stored whole.
+void encodeKeyframe(const std::vector<std::uint8_t>& state, const std::vector<std::uint8_t>& base,
+                    std::vector<std::uint8_t>& out) {
+    auto delta = [&](std::size_t i) -> std::uint8_t {
+        return i < base.size() ? state[i] ^ base[i] : state[i];
+    };
+    
+    std::size_t i = 0;
+    while (i < state.size()) {
+        std::size_t zeros = i;
+        while (i < state.size() && delta(i) == 0) {
+            ++i;
+        }
+        // A lone unchanged byte is cheaper inside the literal than as a run
+        std::size_t literal = i;
+        while (i < state.size() && (delta(i) != 0 || (i + 1 < state.size() && delta(i + 1) != 0))) {
+            ++i;
+        }
+        writeVarint(out, literal - zeros);
+        writeVarint(out, i - literal);
+        for (std::size_t j = literal; j < i; ++j) {
+            out.push_back(delta(j));
+        }
+    }
+}
+
+// Applies encodeKeyframe's output to the previous snapshot in place
+bool decodeKeyframe(const std::uint8_t* data, std::size_t size, std::uint32_t rawSize,
+                    std::vector<std::uint8_t>& state) {
+    state.resize(rawSize, 0);
+    const std::uint8_t* end = data + size;
+    std::uint64_t offset = 0;
+    while (offset < rawSize) {
+        std::uint64_t zeros;
+        std::uint64_t literal;
+        if (!readVarint(data, end, zeros) || !readVarint(data, end, literal) ||
+            zeros + literal == 0 || zeros > rawSize - offset ||
+            literal > rawSize - offset - zeros || literal > static_cast<std::uint64_t>(end - data)) {
+            return false;
+        }
+        offset += zeros;
+        for (std::uint64_t i = 0; i < literal; ++i) {
+            state[static_cast<std::size_t>(offset++)] ^= *data++;
+        }
+    }
+    return data == end;
+}
+
+std::uint8_t packInput(const PlayerInput& input) {
+    std::uint8_t bits = 0;
+    if (input.left) bits |= INPUT_LEFT;
+    if (input.right) bits |= INPUT_RIGHT;
+    if (input.fire) bits |= INPUT_FIRE;
+    if (input.superzapper) bits |= INPUT_SUPERZAPPER;
+    if (input.confirm) bits |= INPUT_CONFIRM;
+    return bits;
+}
+
+PlayerInput unpackInput(std::uint8_t bits, int spin) {
+    PlayerInput input;
+    input.left = (bits & INPUT_LEFT) != 0;
+    input.right = (bits & INPUT_RIGHT) != 0;
+    input.fire = (bits & INPUT_FIRE) != 0;
+    input.superzapper = (bits & INPUT_SUPERZAPPER) != 0;
+    input.confirm = (bits & INPUT_CONFIRM) != 0;
+    input.spin = spin;
+    return input;
+}
+
+// Ticks [first, last) as runs of (input bits, spin as 16 bits, tick count)
+void encodeInputs(const Replay& replay, std::size_t first, std::size_t last,
+                  std::vector<std::uint8_t>& out) {
+    std::size_t tick = first;
+    while (tick < last) {
+        PlayerInput input = replay.getInput(tick);
+        std::uint8_t bits = packInput(input);
+        std::size_t runEnd = tick + 1;
+        while (runEnd < last) {
+            PlayerInput next = replay.getInput(runEnd);
+            if (packInput(next) != bits || next.spin != input.spin) {
+                break;
+            }
+            ++runEnd;
+        }
+        std::uint16_t spin = static_cast<std::uint16_t>(input.spin);
+        out.push_back(bits);
+        out.push_back(static_cast<std::uint8_t>(spin & 0xFF));
+        out.push_back(static_cast<std::uint8_t>(spin >> 8));
+        writeVarint(out, runEnd - tick);
+        tick = runEnd;
+    }
+}
+
+} // namespace
+
+bool ReplayArchive::build(const Replay& replay, const std::string& path, std::uint32_t keyframeInterval) {
+    if (keyframeInterval == 0 || replay.getTickRate() != Simulation::kTickRate) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::vector<std::uint8_t> bytes;
+    StateWriter writer(bytes);
+    bytes.insert(bytes.end(), kMagic, kMagic + 4);
+    writer.writeU32(kVersion);
+    writer.writeU32(static_cast<std::uint32_t>(replay.getTickRate()));
+    writer.writeU32(keyframeInterval);
+    writer.writeU64(replay.getSeed());
+    writer.writeInt(replay.getHighScore());
+    writer.writeU32(static_cast<std::uint32_t>(replay.getArithmetic()));
+    writer.writeU64(replay.getTickCount());
+    writer.writeU64(replay.getStartTick());
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    std::uint64_t offset = bytes.size();
+    
+    Simulation simulation(replay.getSeed(), replay.getArithmetic());
+    if (!replay.restoreStart(simulation)) {
+        return false;
+    }
+    simulation.setLogging(false);
+    
+    std::vector<Keyframe> keyframes;
+    const std::vector<std::uint8_t> none;
+    std::vector<std::uint8_t> previous;
+    std::vector<std::uint8_t> state;
+    std::size_t tickCount = replay.getTickCount();
+    for (std::size_t first = 0; first < tickCount || keyframes.empty(); first += keyframeInterval) {
+        std::size_t last = std::min<std::size_t>(first + keyframeInterval, tickCount);
+        
+        Keyframe keyframe = {};
+        keyframe.tick = first;
+        keyframe.flags = keyframes.size() % kAnchorInterval == 0 ? kKeyframeAnchor : 0;
+        
+        state.clear();
+        simulation.saveState(state);
+        bytes.clear();
+        encodeKeyframe(state, keyframe.flags & kKeyframeAnchor ? none : previous, bytes);
+        keyframe.stateOffset = offset;
+        keyframe.stateSize = static_cast<std::uint32_t>(bytes.size());
+        keyframe.rawSize = static_cast<std::uint32_t>(state.size());
+        
+        std::size_t inputStart = bytes.size();
+        encodeInputs(replay, first, last, bytes);
+        keyframe.inputOffset = offset + inputStart;
+        keyframe.inputSize = static_cast<std::uint32_t>(bytes.size() - inputStart);
+        
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        offset += bytes.size();
+        keyframes.push_back(keyframe);
+        previous.swap(state);
+        
+        for (std::size_t tick = first; tick < last; ++tick) {
+            simulation.tick(replay.getInput(tick));
+        }
+    }
+    
+    bytes.clear();
+    for (const Keyframe& keyframe : keyframes) {
+        writer.writeU64(keyframe.tick);
+        writer.writeU64(keyframe.stateOffset);
+        writer.writeU32(keyframe.stateSize);
+        writer.writeU32(keyframe.rawSize);
+        writer.writeU32(keyframe.flags);
+        writer.writeU64(keyframe.inputOffset);
+        writer.writeU32(keyframe.inputSize);
+    }
+    writer.writeU64(offset);
+    writer.writeU32(static_cast<std::uint32_t>(keyframes.size()));
+    bytes.insert(bytes.end(), kIndexMagic, kIndexMagic + 4);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return file.good();
+}
+
+ReplayArchive::ReplayArchive()
+    : m_header()
+    , m_indexOffset(0)
+    , m_keyframeCount(0)
+{
+}
+
+bool ReplayArchive::open(const std::string& path) {
+    close();
+    if (!m_file.open(path) || m_file.getSize() < kHeaderSize + kTrailerSize) {
+        close();
+        return false;
+    }
+    const std::uint8_t* data = m_file.getData();
+    std::size_t size = m_file.getSize();
+    
+    StateReader header(data + 4, kHeaderSize - 4);
+    std::uint32_t version = header.readU32();
+    int tickRate = header.readInt();
+    m_header.keyframeInterval = header.readU32();
+    m_header.seed = header.readU64();
+    m_header.highScore = header.readInt();
+    std::uint32_t arithmetic = header.readU32();
+    m_header.tickCount = header.readU64();
+    m_header.startTick = header.readU64();
+    
+    StateReader trailer(data + size - kTrailerSize, kTrailerSize - 4);
+    m_indexOffset = trailer.readU64();
+    m_keyframeCount = trailer.readU32();
+    
+    // Inputs were recorded at the simulation's fixed rate, as for Replay
+    bool valid = std::equal(kMagic, kMagic + 4, reinterpret_cast<const char*>(data)) &&
+                 std::equal(kIndexMagic, kIndexMagic + 4, reinterpret_cast<const char*>(data + size - 4)) &&
+                 version == kVersion && tickRate == Simulation::kTickRate && m_header.keyframeInterval > 0 &&
+                 arithmetic <= static_cast<std::uint32_t>(Arithmetic::FIXED_POINT) &&
+                 m_keyframeCount > 0 && m_indexOffset >= kHeaderSize &&
+                 m_indexOffset <= size - kTrailerSize &&
+                 (size - kTrailerSize - m_indexOffset) / kIndexEntrySize == m_keyframeCount &&
+                 (size - kTrailerSize - m_indexOffset) % kIndexEntrySize == 0;
+    m_header.arithmetic = static_cast<Arithmetic>(arithmetic);
+    
+    // Every keyframe in order, inside the body and of a plausible size, the
+    // first one whole, so a seek never has to check
+    for (std::size_t i = 0; valid && i < m_keyframeCount; ++i) {
+        Keyframe keyframe = getKeyframe(i);
+        valid = keyframe.stateOffset >= kHeaderSize && keyframe.stateOffset <= m_indexOffset &&
+                keyframe.stateSize <= m_indexOffset - keyframe.stateOffset &&
+                keyframe.inputOffset >= kHeaderSize && keyframe.inputOffset <= m_indexOffset &&
+                keyframe.inputSize <= m_indexOffset - keyframe.inputOffset &&
+                keyframe.rawSize <= kMaxSnapshotSize &&
+                (i == 0 ? keyframe.tick == 0 && (keyframe.flags & kKeyframeAnchor)
+                        : keyframe.tick > getKeyframe(i - 1).tick && keyframe.tick < m_header.tickCount);
+    }
+    if (!valid) {
+        close();
+    }
+    return valid;
+}
+
+void ReplayArchive::close() {
+    m_file.close();
+    m_header = Header();
+    m_indexOffset = 0;
+    m_keyframeCount = 0;
+}
+
+bool ReplayArchive::isOpen() const {
+    return m_file.isOpen();
+}
+
+std::uint64_t ReplayArchive::getSeed() const {
+    return m_header.seed;
+}
+
+Arithmetic ReplayArchive::getArithmetic() const {
+    return m_header.arithmetic;
+}
+
+int ReplayArchive::getHighScore() const {
+    return m_header.highScore;
+}
+
+std::uint64_t ReplayArchive::getTickCount() const {
+    return m_header.tickCount;
+}
+
+std::uint64_t ReplayArchive::getStartTick() const {
+    return m_header.startTick;
+}
+
+std::uint32_t ReplayArchive::getKeyframeInterval() const {
+    return m_header.keyframeInterval;
+}
+
+std::size_t ReplayArchive::getKeyframeCount() const {
+    return m_keyframeCount;
+}
+
+std::size_t ReplayArchive::getFileSize() const {
+    return m_file.getSize();
+}
+
+bool ReplayArchive::seek(std::uint64_t tick, Simulation& simulation) {
+    if (!isOpen() || tick > m_header.tickCount) {
+        return false;
+    }
+    
+    // Back to the last keyframe stored whole, then forward through the deltas
+    std::size_t target = findKeyframe(tick);
+    std::size_t anchor = target;
+    while (!(getKeyframe(anchor).flags & kKeyframeAnchor)) {
+        --anchor;
+    }
+    m_state.clear();
+    for (std::size_t i = anchor; i <= target; ++i) {
+        Keyframe keyframe = getKeyframe(i);
+        if (!decodeKeyframe(m_file.getData() + keyframe.stateOffset, keyframe.stateSize,
+                            keyframe.rawSize, m_state)) {
+            return false;
+        }
+    }
+    
+    return simulation.loadState(m_state.data(), m_state.size()) &&
+           simulation.getTickCount() == m_header.startTick + getKeyframe(target).tick &&
+           advance(tick, simulation);
+}
+
+bool ReplayArchive::advance(std::uint64_t tick, Simulation& simulation) const {
+    if (!isOpen() || simulation.getTickCount() < m_header.startTick) {
+        return false;
+    }
+    std::uint64_t now = simulation.getTickCount() - m_header.startTick;
+    if (tick < now || tick > m_header.tickCount) {
+        return false;
+    }
+    
+    for (std::size_t index = findKeyframe(now); now < tick; ++index) {
+        Keyframe keyframe = getKeyframe(index);
+        std::uint64_t segmentEnd = index + 1 < m_keyframeCount ? getKeyframe(index + 1).tick
+                                                               : m_header.tickCount;
+        const std::uint8_t* data = m_file.getData() + keyframe.inputOffset;
+        const std::uint8_t* end = data + keyframe.inputSize;
+        
+        // Skip the runs already simulated, then play until the tick
+        std::uint64_t runStart = keyframe.tick;
+        while (runStart < segmentEnd && now < tick) {
+            std::uint64_t count;
+            if (end - data < 3) {
+                return false;
+            }
+            std::uint8_t bits = data[0];
+            int spin = static_cast<std::int16_t>(data[1] | (data[2] << 8));
+            data += 3;
+            if (!readVarint(data, end, count) || count == 0 || count > segmentEnd - runStart) {
+                return false;
+            }
+            
+            std::uint64_t runEnd = runStart + count;
+            if (runEnd > now) {
+                PlayerInput input = unpackInput(bits, spin);
+                for (std::uint64_t stop = std::min(runEnd, tick); now < stop; ++now) {
+                    simulation.tick(input);
+                }
+            }
+            runStart = runEnd;
+        }
+        if (now < tick && runStart != segmentEnd) {
+            return false; // Runs short of the next keyframe
+        }
+    }
+    return true;
+}
+
+ReplayArchive::Keyframe ReplayArchive::getKeyframe(std::size_t index) const {
+    StateReader entry(m_file.getData() + m_indexOffset + index * kIndexEntrySize, kIndexEntrySize);
+    Keyframe keyframe;
+    keyframe.tick = entry.readU64();
+    keyframe.stateOffset = entry.readU64();
+    keyframe.stateSize = entry.readU32();
+    keyframe.rawSize = entry.readU32();
+    keyframe.flags = entry.readU32();
+    keyframe.inputOffset = entry.readU64();
+    keyframe.inputSize = entry.readU32();
+    return keyframe;
+}
+
+std::size_t ReplayArchive::findKeyframe(std::uint64_t tick) const {
+    // Binary search of the index in place; the first keyframe is at tick 0
+    std::size_t low = 0;
+    std::size_t high = m_keyframeCount;
+    while (high - low > 1) {
+        std::size_t middle = low + (high - low) / 2;
+        if (getKeyframe(middle).tick <= tick) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+} // namespace tempest
@@ -1,12 +1,35 @@
 #include "Shot.hpp"
+#include "Layout.hpp"
+#include "Playfield.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "StateHash.hpp"
+#include "StateStream.hpp"
 
 namespace tempest {
 
-Shot::Shot(const sf::Vector2f& startPos, const sf::Vector2f& direction)
+const Fixed Shot::kFixedSpeed = 2 * fixed::kOne; // Rim to far end in half a second
+
+Shot::Shot(const sf::Vector2f& startPos, const sf::Vector2f& direction, int lane)
     : m_position(startPos)
-    , m_velocity(direction * 500.0f) // Speed of 500 pixels per second
-    , m_radius(3.0f)
+    , m_velocity(direction * (500.0f * layout::kPixel)) // 500 design pixels per second
+    , m_radius(3.0f * layout::kPixel)
+    , m_lane(lane)
+    , m_active(true)
+    , m_playfield(nullptr)
+    , m_depth(0)
+{
+    m_shape.setRadius(m_radius);
+    m_shape.setFillColor(sf::Color::Yellow);
+    m_shape.setPosition(m_position - sf::Vector2f(m_radius, m_radius));
+}
+
+Shot::Shot(int lane, const Playfield& playfield)
+    : m_position(playfield.getPointPosition(lane, 0.0f))
+    , m_radius(3.0f * layout::kPixel)
+    , m_lane(lane)
     , m_active(true)
+    , m_playfield(&playfield)
+    , m_depth(0)
 {
     m_shape.setRadius(m_radius);
     m_shape.setFillColor(sf::Color::Yellow);
@@ -14,23 +37,37 @@ Shot::Shot(const sf::Vector2f& startPos, const sf::Vector2f& direction)
 }
 
 void Shot::update(float deltaTime) {
-    if (m_active) {
+    if (!m_active) {
+        return;
+    }
+    
+    if (m_playfield) {
+        m_depth += fixed::mul(kFixedSpeed, fixed::fromFloat(deltaTime));
+        m_position = m_playfield->getTablePosition(m_lane, m_depth);
+    } else {
         m_position += m_velocity * deltaTime;
-        m_shape.setPosition(m_position - sf::Vector2f(m_radius, m_radius));
+    }
+    m_shape.setPosition(m_position - sf::Vector2f(m_radius, m_radius));
+}
+
+void Shot::draw(sf::RenderTarget& target) {
+    if (m_active) {
+        target.draw(m_shape);
     }
 }
 
-void Shot::draw(sf::RenderWindow& window) {
+void Shot::draw(SoftwareRasterizer& rasterizer) const {
     if (m_active) {
-        window.draw(m_shape);
+        rasterizer.draw(m_shape);
     }
 }
 
 bool Shot::isOutOfBounds() const {
-    // Check if shot is outside the play area
-    // For simplicity, we'll use a fixed boundary
-    return m_position.x < 0 || m_position.x > 800 || 
-           m_position.y < 0 || m_position.y > 600;
+    // Past the far end of the lane, or outside the logical area
+    if (m_playfield) {
+        return m_depth > fixed::kOne;
+    }
+    return !layout::getArea().contains(m_position.x, m_position.y);
 }
 
 const sf::Vector2f& Shot::getPosition() const {
@@ -41,6 +78,29 @@ float Shot::getRadius() const {
     return m_radius;
 }
 
+int Shot::getLane() const {
+    return m_lane;
+}
+
+Fixed Shot::getDepth() const {
+    return m_depth;
+}
+
+std::uint64_t Shot::getHashTerm() const {
+    // Depth steps in fixed point; float shots only know their screen
+    // position, taken to 1/1024 of the logical height
+    std::uint64_t progress;
+    if (m_playfield) {
+        progress = static_cast<std::uint32_t>(m_depth) >> (fixed::kFractionBits - 8);
+    } else {
+        std::uint16_t x = static_cast<std::uint16_t>(static_cast<std::int32_t>(m_position.x * 1024.0f));
+        std::uint16_t y = static_cast<std::uint16_t>(static_cast<std::int32_t>(m_position.y * 1024.0f));
+        progress = x | (static_cast<std::uint64_t>(y) << 16);
+    }
+    std::uint64_t key = static_cast<std::uint16_t>(m_lane) | (m_active ? 0x10000ULL : 0) | (progress << 32);
+    return statehash::term(statehash::TAG_SHOT, key);
+}
+
 void Shot::destroy() {
     m_active = false;
 }
@@ -49,4 +109,28 @@ bool Shot::isActive() const {
     return m_active;
 }
 
+void Shot::saveState(StateWriter& out) const {
+    out.writeFloat(m_position.x);
+    out.writeFloat(m_position.y);
+    out.writeFloat(m_velocity.x);
+    out.writeFloat(m_velocity.y);
+    out.writeFloat(m_radius);
+    out.writeInt(m_lane);
+    out.writeBool(m_active);
+    out.writeInt(m_depth);
+}
+
+void Shot::loadState(StateReader& in) {
+    m_position.x = in.readFloat();
+    m_position.y = in.readFloat();
+    m_velocity.x = in.readFloat();
+    m_velocity.y = in.readFloat();
+    m_radius = in.readFloat();
+    m_lane = in.readInt();
+    m_active = in.readBool();
+    m_depth = in.readInt();
+    m_shape.setRadius(m_radius);
+    m_shape.setPosition(m_position - sf::Vector2f(m_radius, m_radius));
+}
+
 } // namespace tempest
@@ -0,0 +1,535 @@
+#include "Simulation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "AllocTracker.hpp"
+#include "EnemyTraits.hpp"
+#include "StateHash.hpp"
+#include "StateStream.hpp"
+#include "utils.hpp"
+
+namespace tempest {
+
+const int Simulation::kTickRate;
+const float Simulation::kTickDuration = 1.0f / Simulation::kTickRate;
+const int Simulation::kKeySpin = Player::kSpinUnitsPerLane / 4; // 15 lanes per second
+
+namespace {
+
+// Depth either side of a fixed-point shot that hits
+const Fixed kFixedHitReach = fixed::kOne / 32;
+
+// Whole ticks for a duration in seconds, at least one
+std::uint32_t toTicks(float seconds) {
+    long ticks = std::lround(seconds * Simulation::kTickRate);
+    return static_cast<std::uint32_t>(std::max(1L, ticks));
+}
+
+} // namespace
+
+Simulation::Simulation(std::uint64_t seed, Arithmetic arithmetic)
+    : m_seed(seed)
+    , m_arithmetic(arithmetic)
+    , m_tickCount(0)
+    , m_stateHash(0)
+    , m_random(seed)
+    , m_state(GameState::MENU)
+    , m_score(0)
+    , m_highScore(0)
+    , m_level(1)
+    , m_lives(3)
+    , m_enemiesToSpawn(0)
+    , m_superzapperHeld(false)
+    , m_playerElectrified(false)
+    , m_logging(true)
+    , m_spawnTimer(TimerWheel::kNoTimer)
+    , m_shotTimer(TimerWheel::kNoTimer)
+    , m_playfield(Playfield::Type::CIRCLE, 16, m_levelArena)
+    , m_player(m_playfield, m_levelArena, arithmetic)
+    , m_enemyManager(m_playfield, m_levelArena, m_random.next(), arithmetic)
+{
+    // Pulsing enemies of a type pulse in step, on one timer for the game
+    for (int type = 0; type < Enemy::kTypeCount; ++type) {
+        float period = getEnemyTypeInfo(static_cast<Enemy::Type>(type)).pulsePeriod;
+        if (period > 0.0f) {
+            m_timers.schedule(toTicks(period), static_cast<std::uint32_t>(TimerKind::ENEMY_PULSE),
+                              static_cast<std::uint32_t>(type), toTicks(period));
+        }
+    }
+}
+
+void Simulation::tick(const PlayerInput& input) {
+    AllocScope scope(AllocSubsystem::SIMULATION);
+    m_timers.advance([this](const TimerWheel::Timer& timer) {
+        onTimer(timer);
+    });
+    
+    if (input.confirm) {
+        confirm();
+    }
+    applyInput(input);
+    update(kTickDuration);
+    processEvents();
+    m_tickCount++;
+    m_stateHash = statehash::chain(m_stateHash, hashState());
+}
+
+void Simulation::addListener(GameEventListener* listener) {
+    m_listeners.push_back(listener);
+}
+
+void Simulation::setLogging(bool enabled) {
+    m_logging = enabled;
+}
+
+void Simulation::saveState(std::vector<std::uint8_t>& out) const {
+    StateWriter writer(out);
+    writer.writeU64(m_seed);
+    writer.writeInt(static_cast<int>(m_arithmetic));
+    writer.writeU64(m_tickCount);
+    writer.writeU64(m_stateHash);
+    writer.writeU64(m_random.getState());
+    writer.writeInt(static_cast<int>(m_state));
+    writer.writeInt(m_score);
+    writer.writeInt(m_highScore);
+    writer.writeInt(m_level);
+    writer.writeInt(m_lives);
+    writer.writeInt(m_enemiesToSpawn);
+    writer.writeBool(m_superzapperHeld);
+    writer.writeBool(m_playerElectrified);
+    writer.writeU64(m_spawnTimer);
+    writer.writeU64(m_shotTimer);
+    m_timers.saveState(writer);
+    m_levelManager.saveState(writer);
+    writer.writeInt(static_cast<int>(m_playfield.getType()));
+    writer.writeInt(m_playfield.getNumSegments());
+    m_player.saveState(writer);
+    m_enemyManager.saveState(writer);
+}
+
+bool Simulation::loadState(const std::uint8_t* data, std::size_t size) {
+    StateReader reader(data, size);
+    m_seed = reader.readU64();
+    int arithmetic = reader.readInt();
+    m_tickCount = reader.readU64();
+    m_stateHash = reader.readU64();
+    std::uint64_t random = reader.readU64();
+    int state = reader.readInt();
+    m_score = reader.readInt();
+    m_highScore = reader.readInt();
+    m_level = reader.readInt();
+    m_lives = reader.readInt();
+    m_enemiesToSpawn = reader.readInt();
+    bool superzapperHeld = reader.readBool();
+    bool playerElectrified = reader.readBool();
+    m_spawnTimer = reader.readU64();
+    m_shotTimer = reader.readU64();
+    if (!m_timers.loadState(reader)) {
+        return false;
+    }
+    m_levelManager.loadState(reader);
+    int playfieldType = reader.readInt();
+    int numSegments = reader.readInt();
+    if (!reader.ok() || state < 0 || state > static_cast<int>(GameState::LEVEL_COMPLETE) ||
+        arithmetic < 0 || arithmetic > static_cast<int>(Arithmetic::FIXED_POINT) ||
+        playfieldType < 0 || playfieldType > static_cast<int>(Playfield::Type::TRIANGLE) ||
+        numSegments < 1 || numSegments > LaneIndex::kMaxLanes) {
+        return false;
+    }
+    
+    // A fresh level of the saved shape, then everything in it as saved;
+    // building draws on the game's random stream, so that comes after
+    m_arithmetic = static_cast<Arithmetic>(arithmetic);
+    buildLevel(static_cast<Playfield::Type>(playfieldType), numSegments);
+    m_random.setState(random);
+    m_state = static_cast<GameState>(state);
+    m_superzapperHeld = superzapperHeld;
+    m_playerElectrified = playerElectrified;
+    m_player.loadState(reader);
+    m_enemyManager.loadState(reader);
+    m_events.clear();
+    return reader.ok() && reader.atEnd();
+}
+
+void Simulation::confirm() {
+    switch (m_state) {
+        case GameState::MENU:
+            startGame();
+            break;
+            
+        case GameState::GAME_OVER:
+            m_state = GameState::MENU;
+            break;
+            
+        case GameState::LEVEL_COMPLETE:
+            startNextLevel();
+            break;
+            
+        default:
+            break;
+    }
+}
+
+void Simulation::applyInput(const PlayerInput& input) {
+    // Continuous input handling (only during gameplay)
+    if (m_state == GameState::PLAYING) {
+        // Keys turn at a fixed rate; spinners and sticks add their own motion
+        int spin = input.spin;
+        if (input.left) {
+            spin -= kKeySpin;
+        }
+        if (input.right) {
+            spin += kKeySpin;
+        }
+        m_player.spin(spin);
+        if (input.fire && m_player.shoot()) {
+            m_shotTimer = m_timers.schedule(m_tickCount + toTicks(Player::kShotCooldown),
+                                            static_cast<std::uint32_t>(TimerKind::SHOT_READY));
+            m_events.push(ShotFiredEvent{m_player.getPosition()});
+        }
+        if (input.superzapper && !m_superzapperHeld && m_player.useSuperzapper()) {
+            fireSuperzapper();
+        }
+    }
+    m_superzapperHeld = input.superzapper;
+}
+
+void Simulation::update(float deltaTime) {
+    // State-specific updates
+    switch (m_state) {
+        case GameState::PLAYING:
+            {
+                AllocScope scope(AllocSubsystem::PLAYER);
+                m_player.update(deltaTime);
+            }
+            {
+                AllocScope scope(AllocSubsystem::ENEMIES);
+                m_enemyManager.update(deltaTime, m_player.getPosition());
+            }
+            m_levelManager.update(deltaTime);
+            
+            checkCollisions();
+            
+            // The level is clear once its whole quota has spawned and died
+            if (m_enemiesToSpawn == 0 && m_enemyManager.areEnemiesCleared()) {
+                m_state = GameState::LEVEL_COMPLETE;
+                m_events.push(LevelClearedEvent{m_level});
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+std::uint64_t Simulation::getSeed() const {
+    return m_seed;
+}
+
+Arithmetic Simulation::getArithmetic() const {
+    return m_arithmetic;
+}
+
+std::uint64_t Simulation::getTickCount() const {
+    return m_tickCount;
+}
+
+std::uint64_t Simulation::getStateHash() const {
+    return m_stateHash;
+}
+
+GameState Simulation::getState() const {
+    return m_state;
+}
+
+int Simulation::getScore() const {
+    return m_score;
+}
+
+int Simulation::getHighScore() const {
+    return m_highScore;
+}
+
+void Simulation::setHighScore(int highScore) {
+    m_highScore = highScore;
+}
+
+int Simulation::getLevel() const {
+    return m_level;
+}
+
+int Simulation::getLives() const {
+    return m_lives;
+}
+
+const Playfield& Simulation::getPlayfield() const {
+    return m_playfield;
+}
+
+const Player& Simulation::getPlayer() const {
+    return m_player;
+}
+
+const EnemyManager& Simulation::getEnemyManager() const {
+    return m_enemyManager;
+}
+
+const LevelArena& Simulation::getLevelArena() const {
+    return m_levelArena;
+}
+
+const TimerWheel& Simulation::getTimers() const {
+    return m_timers;
+}
+
+Playfield& Simulation::getPlayfield() {
+    return m_playfield;
+}
+
+Player& Simulation::getPlayer() {
+    return m_player;
+}
+
+EnemyManager& Simulation::getEnemyManager() {
+    return m_enemyManager;
+}
+
+std::uint64_t Simulation::hashState() const {
+    // The enemies' part is kept up to date as they change; the rest is a
+    // handful of terms
+    std::uint64_t player = static_cast<std::uint32_t>(m_player.getPosition()) |
+                           (static_cast<std::uint64_t>(static_cast<std::uint32_t>(m_lives)) << 32) |
+                           (static_cast<std::uint64_t>(m_state) << 56);
+    std::uint64_t score = static_cast<std::uint32_t>(m_score) |
+                          (static_cast<std::uint64_t>(m_level & 0xFFFF) << 32) |
+                          (static_cast<std::uint64_t>(m_enemiesToSpawn & 0xFFFF) << 48);
+    std::uint64_t hash = statehash::term(statehash::TAG_PLAYER, player) +
+                         statehash::term(statehash::TAG_SCORE, score) +
+                         statehash::term(statehash::TAG_RANDOM, m_random.getState()) +
+                         m_enemyManager.getStateHash();
+    for (const auto& shot : m_player.getShots()) {
+        hash += shot.getHashTerm();
+    }
+    return hash;
+}
+
+void Simulation::checkCollisions() {
+    const LaneIndex& lanes = m_enemyManager.getLaneIndex();
+    
+    // Check collisions between player shots and enemies in their lane,
+    // nearest the rim first
+    const auto& shots = m_player.getShots();
+    
+    for (const auto& shot : shots) {
+        auto hit = [&](Enemy& enemy) {
+            m_enemyManager.shootEnemy(enemy);
+            const_cast<Shot&>(shot).destroy();
+            m_events.push(EnemyKilledEvent{
+                enemy.getType(), enemy.getLane(), enemy.getPosition(), false});
+        };
+        
+        if (m_arithmetic == Arithmetic::FIXED_POINT) {
+            // Along the lane, within reach of the shot's depth; the reach
+            // covers a shot and an enemy closing for a tick, so neither can
+            // step over the other
+            float nearest = fixed::toFloat(std::max<Fixed>(0, shot.getDepth() - kFixedHitReach));
+            float farthest = fixed::toFloat(shot.getDepth() + kFixedHitReach);
+            lanes.forEachInRange(shot.getLane(), nearest, farthest, [&](EnemyHandle handle) {
+                if (shot.isActive() && !shot.isOutOfBounds()) {
+                    hit(m_enemyManager.getEnemy(handle));
+                }
+            });
+        } else {
+            lanes.forEachInRange(shot.getLane(), 0.0f, 1.0f, [&](EnemyHandle handle) {
+                Enemy& enemy = m_enemyManager.getEnemy(handle);
+                if (shot.isActive() && !shot.isOutOfBounds()) {
+                    float distance = std::sqrt(
+                        std::pow(shot.getPosition().x - enemy.getPosition().x, 2) +
+                        std::pow(shot.getPosition().y - enemy.getPosition().y, 2)
+                    );
+                    
+                    if (distance < (shot.getRadius() + enemy.getRadius())) {
+                        hit(enemy);
+                    }
+                }
+            });
+        }
+        
+        // Spikes stop shots that get past the enemies, and wear down
+        if (shot.isActive() && m_enemyManager.erodeSpike(shot)) {
+            const_cast<Shot&>(shot).destroy();
+        }
+    }
+    
+    // Check collisions between the player and enemies at the rim of its lane
+    int lane = m_player.getPosition();
+    lanes.forEachInRange(lane, 0.0f, Enemy::kEdgeDepth, [&](EnemyHandle handle) {
+        m_events.push(PlayerHitEvent{
+            m_enemyManager.getEnemy(handle).getType(), lane, m_playfield.getPointPosition(lane, 0.0f)});
+    });
+    
+    // An electrified lane hits once each time the player meets it
+    bool electrified = m_enemyManager.isLaneElectrified(lane);
+    if (electrified && !m_playerElectrified) {
+        m_events.push(PlayerHitEvent{
+            Enemy::Type::PULSAR, lane, m_playfield.getPointPosition(lane, 0.0f)});
+    }
+    m_playerElectrified = electrified;
+}
+
+void Simulation::fireSuperzapper() {
+    SuperzapperFiredEvent event = {m_player.getSuperzapperCharges(), {}, 0, 0, 0, {}};
+    
+    if (event.chargesLeft == Player::kSuperzapperCharges - 1) {
+        // The lanes for the effects, while the index still holds them
+        const LaneIndex& lanes = m_enemyManager.getLaneIndex();
+        event.lanes = lanes.getOccupancy();
+        for (int lane = 0; lane < lanes.getNumLanes(); ++lane) {
+            if (const LaneIndex::Entry* entry = lanes.findNearest(lane)) {
+                event.nearest[lane] = m_enemyManager.getEnemy(entry->enemy).getPosition();
+            }
+        }
+        
+        // First use: everything in the tube, in constant time
+        EnemyManager::KillTally tally = m_enemyManager.destroyAllEnemies();
+        for (int type = 0; type < Enemy::kTypeCount; ++type) {
+            event.kills[type] = tally.kills[type];
+            event.score += tally.kills[type] * getEnemyTypeInfo(static_cast<Enemy::Type>(type)).score;
+        }
+        event.totalKills = tally.total;
+    } else if (const Enemy* enemy = m_enemyManager.destroyRandomEnemy()) {
+        // Later uses: one enemy at random
+        event.kills[static_cast<int>(enemy->getType())] = 1;
+        event.totalKills = 1;
+        event.score = getEnemyTypeInfo(enemy->getType()).score;
+        m_events.push(EnemyKilledEvent{
+            enemy->getType(), enemy->getLane(), enemy->getPosition(), true});
+    }
+    
+    m_events.push(event);
+}
+
+void Simulation::onTimer(const TimerWheel::Timer& timer) {
+    switch (static_cast<TimerKind>(timer.kind)) {
+        case TimerKind::SPAWN_ENEMY:
+            // The timer runs on through the level once the quota is out
+            if (m_state == GameState::PLAYING && m_enemiesToSpawn > 0) {
+                m_enemyManager.spawnRandomEnemy();
+                --m_enemiesToSpawn;
+            }
+            break;
+            
+        case TimerKind::SHOT_READY:
+            m_player.reload();
+            break;
+            
+        case TimerKind::ENEMY_PULSE:
+            // Enemies hold still outside play, and so do their colors
+            if (m_state == GameState::PLAYING) {
+                m_enemyManager.pulse(static_cast<Enemy::Type>(timer.payload));
+            }
+            break;
+    }
+}
+
+void Simulation::scheduleSpawns() {
+    // Restarted with each level's rate and quota, so the first enemy comes
+    // one period in
+    m_enemiesToSpawn = m_levelManager.getEnemyQuota();
+    std::uint32_t period = toTicks(1.0f / m_levelManager.getEnemySpawnRate());
+    m_timers.cancel(m_spawnTimer);
+    m_spawnTimer = m_timers.schedule(m_tickCount + period,
+                                     static_cast<std::uint32_t>(TimerKind::SPAWN_ENEMY), 0, period);
+}
+
+void Simulation::processEvents() {
+    // Scoring; superzapper kills come as one total per zap
+    for (const auto& event : m_events.get<EnemyKilledEvent>()) {
+        if (!event.bySuperzapper) {
+            m_score += getEnemyTypeInfo(event.type).score;
+        }
+    }
+    for (const auto& event : m_events.get<SuperzapperFiredEvent>()) {
+        m_score += event.score;
+    }
+    for (const auto& event : m_events.get<LevelClearedEvent>()) {
+        // Level completion bonus
+        m_score += 1000 * event.level;
+    }
+    if (m_score > m_highScore) {
+        m_highScore = m_score;
+    }
+    
+    // Lives
+    for (std::size_t i = 0; i < m_events.get<PlayerHitEvent>().size(); ++i) {
+        m_lives--;
+        if (m_lives <= 0) {
+            m_state = GameState::GAME_OVER;
+        }
+    }
+    
+    if (!m_events.empty()) {
+        AllocScope scope(AllocSubsystem::EVENTS);
+        for (GameEventListener* listener : m_listeners) {
+            listener->onEvents(m_events);
+        }
+        m_events.clear();
+    }
+}
+
+void Simulation::startGame() {
+    m_state = GameState::PLAYING;
+    m_score = 0;
+    m_level = 1;
+    m_lives = 3;
+    
+    // Reset game elements
+    m_levelManager = LevelManager();
+    resetLevel(Playfield::Type::CIRCLE, 16);
+    
+    // Set initial enemy spawn rate and speed
+    scheduleSpawns();
+    m_enemyManager.setEnemySpeed(m_levelManager.getEnemySpeed());
+}
+
+void Simulation::startNextLevel() {
+    m_level++;
+    m_levelManager.startNextLevel();
+    resetLevel(m_levelManager.getCurrentPlayfieldType(), m_levelManager.getNumSegments());
+    scheduleSpawns();
+    m_enemyManager.setEnemySpeed(m_levelManager.getEnemySpeed());
+    m_state = GameState::PLAYING;
+}
+
+void Simulation::resetLevel(Playfield::Type playfieldType, int numSegments) {
+    if (m_logging) {
+        const LevelArena::Stats& stats = m_levelArena.getStats();
+        std::stringstream ss;
+        ss << "Level arena: " << stats.bytesUsed << " bytes used, "
+           << stats.blocksRecycled << " blocks recycled, peak "
+           << stats.peakBytesUsed << " bytes / " << stats.peakLiveBlocks << " blocks, "
+           << stats.bytesReserved << " bytes reserved";
+        Utils::printMessage(ss.str());
+    }
+    
+    buildLevel(playfieldType, numSegments);
+    
+    // The new player starts ready to fire
+    m_timers.cancel(m_shotTimer);
+    m_playerElectrified = false;
+}
+
+void Simulation::buildLevel(Playfield::Type playfieldType, int numSegments) {
+    // Destroy everything living in the arena before rewinding it
+    m_enemyManager = EnemyManager();
+    m_player = Player();
+    m_playfield = Playfield();
+    m_levelArena.reset();
+    
+    m_playfield = Playfield(playfieldType, numSegments, m_levelArena);
+    m_player = Player(m_playfield, m_levelArena, m_arithmetic);
+    // Each level's enemies draw from their own stream, seeded from the game's
+    m_enemyManager = EnemyManager(m_playfield, m_levelArena, m_random.next(), m_arithmetic);
+}
+
+} // namespace tempest
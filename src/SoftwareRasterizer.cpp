@@ -0,0 +1,604 @@
+#include "SoftwareRasterizer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace tempest {
+
+namespace {
+
+// Stroke font on a 4x6 grid. Each glyph is a list of polylines separated by
+// spaces; each point is two digits (x then y, y pointing down).
+struct Glyph {
+    char character;
+    const char* strokes;
+};
+
+const Glyph kGlyphs[] = {
+    {'0', "0040460600 0640"},
+    {'1', "1120 2026 1636"},
+    {'2', "004043030646"},
+    {'3', "00404606 0343"},
+    {'4', "000343 4046"},
+    {'5', "400003434606"},
+    {'6', "400006464303"},
+    {'7', "004046"},
+    {'8', "0040460600 0343"},
+    {'9', "4640000343"},
+    {'A', "0602204246 0343"},
+    {'B', "06003041423303 3344453606"},
+    {'C', "40000646"},
+    {'D', "00304244360600"},
+    {'E', "40000646 0323"},
+    {'F', "400006 0323"},
+    {'G', "400006464323"},
+    {'H', "0006 4046 0343"},
+    {'I', "0040 2026 0646"},
+    {'J', "4045361605"},
+    {'K', "0006 400346"},
+    {'L', "000646"},
+    {'M', "0600234046"},
+    {'N', "06004640"},
+    {'O', "0040460600"},
+    {'P', "0600404303"},
+    {'Q', "0040460600 2446"},
+    {'R', "0600404303 2346"},
+    {'S', "400003434606"},
+    {'T', "0040 2026"},
+    {'U', "00064640"},
+    {'V', "002640"},
+    {'W', "0006234640"},
+    {'X', "0046 4006"},
+    {'Y', "0023 4023 2326"},
+    {'Z', "00400646"},
+    {':', "2122 2425"},
+    {'!', "2024 2526"},
+    {'-', "0343"},
+    {'.', "2526"},
+    {'/', "0640"}
+};
+
+const float kGlyphAdvance = 6.0f; // Grid units, including spacing
+
+const char* findGlyph(char character) {
+    if (character >= 'a' && character <= 'z') {
+        character = static_cast<char>(character - 'a' + 'A');
+    }
+    for (const Glyph& glyph : kGlyphs) {
+        if (glyph.character == character) {
+            return glyph.strokes;
+        }
+    }
+    return nullptr;
+}
+
+float gridUnit(float characterSize) {
+    // Cap height of about three quarters of the character size, like sf::Text
+    return characterSize / 8.0f;
+}
+
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned width, unsigned height, Format format,
+                                       unsigned threadCount, unsigned tileSize)
+    : m_width(width)
+    , m_height(height)
+    , m_format(format)
+    , m_channels(format == Format::RGBA ? 4 : 1)
+    , m_pixels(static_cast<std::size_t>(width) * height * m_channels, 0)
+    , m_clearColor(sf::Color::Black)
+    , m_nextTile(0)
+    , m_frameId(0)
+    , m_workersBusy(0)
+    , m_stopping(false)
+{
+    setView(sf::FloatRect(0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)));
+
+    tileSize = std::max(8u, tileSize);
+    for (unsigned y = 0; y < height; y += tileSize) {
+        for (unsigned x = 0; x < width; x += tileSize) {
+            Tile tile;
+            tile.x0 = static_cast<int>(x);
+            tile.y0 = static_cast<int>(y);
+            tile.x1 = static_cast<int>(std::min(width, x + tileSize));
+            tile.y1 = static_cast<int>(std::min(height, y + tileSize));
+            m_tiles.push_back(tile);
+        }
+    }
+
+    // Room for a busy frame up front, so steady-state frames reuse the same
+    // buffers instead of growing them
+    m_commands.reserve(4096);
+    m_points.reserve(4096 * 2);
+
+    // The calling thread is one of the rasterizing threads
+    unsigned workerCount = std::min<unsigned>(threadCount, static_cast<unsigned>(m_tiles.size()));
+    m_coverage.resize(std::max(1u, workerCount));
+    for (auto& coverage : m_coverage) {
+        coverage.reserve(tileSize);
+    }
+    for (unsigned i = 1; i < workerCount; ++i) {
+        m_workers.emplace_back(&SoftwareRasterizer::workerLoop, this, i);
+    }
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_startCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void SoftwareRasterizer::setView(const sf::FloatRect& area) {
+    m_view = area;
+    m_scale = sf::Vector2f(m_width / area.width, m_height / area.height);
+}
+
+void SoftwareRasterizer::clear(const sf::Color& color) {
+    m_clearColor = color;
+    m_commands.clear();
+    m_points.clear();
+}
+
+void SoftwareRasterizer::draw(const sf::Shape& shape) {
+    std::size_t pointCount = shape.getPointCount();
+    if (pointCount < 3 || shape.getFillColor().a == 0) {
+        return;
+    }
+
+    const sf::Transform& transform = shape.getTransform();
+    std::size_t firstPoint = m_points.size();
+    for (std::size_t i = 0; i < pointCount; ++i) {
+        m_points.push_back(toPixels(transform.transformPoint(shape.getPoint(i))));
+    }
+    addCommand(CommandType::POLYGON, shape.getFillColor(), firstPoint);
+}
+
+void SoftwareRasterizer::draw(const sf::Vertex* vertices, std::size_t vertexCount, sf::PrimitiveType type) {
+    switch (type) {
+        case sf::Lines:
+            for (std::size_t i = 0; i + 1 < vertexCount; i += 2) {
+                drawLine(vertices[i].position, vertices[i + 1].position, vertices[i].color);
+            }
+            break;
+
+        case sf::LineStrip:
+            for (std::size_t i = 0; i + 1 < vertexCount; ++i) {
+                drawLine(vertices[i].position, vertices[i + 1].position, vertices[i].color);
+            }
+            break;
+
+        case sf::Triangles:
+            for (std::size_t i = 0; i + 2 < vertexCount; i += 3) {
+                sf::Vector2f triangle[3] = {
+                    vertices[i].position, vertices[i + 1].position, vertices[i + 2].position
+                };
+                drawPolygon(triangle, 3, vertices[i].color);
+            }
+            break;
+
+        case sf::TriangleFan:
+            // Same as drawPolygon(), without copying the positions out first
+            if (vertexCount >= 3 && vertices[0].color.a != 0) {
+                std::size_t firstPoint = m_points.size();
+                for (std::size_t i = 0; i < vertexCount; ++i) {
+                    m_points.push_back(toPixels(vertices[i].position));
+                }
+                addCommand(CommandType::POLYGON, vertices[0].color, firstPoint);
+            }
+            break;
+
+        default:
+            // Points, strips and quads are not used by the game
+            break;
+    }
+}
+
+void SoftwareRasterizer::drawLine(const sf::Vector2f& from, const sf::Vector2f& to, const sf::Color& color) {
+    if (color.a == 0) {
+        return;
+    }
+
+    std::size_t firstPoint = m_points.size();
+    m_points.push_back(toPixels(from));
+    m_points.push_back(toPixels(to));
+    addCommand(CommandType::LINE, color, firstPoint);
+}
+
+void SoftwareRasterizer::drawPolygon(const sf::Vector2f* points, std::size_t pointCount, const sf::Color& color) {
+    if (pointCount < 3 || color.a == 0) {
+        return;
+    }
+
+    std::size_t firstPoint = m_points.size();
+    for (std::size_t i = 0; i < pointCount; ++i) {
+        m_points.push_back(toPixels(points[i]));
+    }
+    addCommand(CommandType::POLYGON, color, firstPoint);
+}
+
+void SoftwareRasterizer::drawText(const char* text, const sf::Vector2f& position,
+                                  float characterSize, const sf::Color& color) {
+    const float unit = gridUnit(characterSize);
+    sf::Vector2f origin = position;
+
+    for (const char* c = text; *c; ++c) {
+        char character = *c;
+        if (character == '\n') {
+            origin.x = position.x;
+            origin.y += characterSize * 1.2f;
+            continue;
+        }
+
+        const char* strokes = findGlyph(character);
+        if (strokes) {
+            // Each polyline is a run of digit pairs; spaces split polylines
+            bool hasPrevious = false;
+            sf::Vector2f previous;
+            for (const char* p = strokes; *p; ) {
+                if (*p == ' ') {
+                    hasPrevious = false;
+                    ++p;
+                    continue;
+                }
+
+                sf::Vector2f point(origin.x + (p[0] - '0') * unit, origin.y + (p[1] - '0') * unit);
+                if (hasPrevious) {
+                    drawLine(previous, point, color);
+                } else if (p[2] == '\0' || p[2] == ' ') {
+                    // Single-point stroke: draw a dot
+                    drawLine(point, point + sf::Vector2f(unit * 0.5f, 0.0f), color);
+                }
+                previous = point;
+                hasPrevious = true;
+                p += 2;
+            }
+        }
+
+        origin.x += kGlyphAdvance * unit;
+    }
+}
+
+float SoftwareRasterizer::getTextWidth(const char* text, float characterSize) {
+    std::size_t longestLine = 0;
+    std::size_t lineLength = 0;
+    for (const char* c = text; *c; ++c) {
+        if (*c == '\n') {
+            lineLength = 0;
+        } else {
+            longestLine = std::max(longestLine, ++lineLength);
+        }
+    }
+
+    // The last glyph has no trailing spacing
+    return longestLine == 0 ? 0.0f : (longestLine * kGlyphAdvance - 2.0f) * gridUnit(characterSize);
+}
+
+void SoftwareRasterizer::display() {
+    if (m_workers.empty()) {
+        for (const Tile& tile : m_tiles) {
+            rasterizeTile(tile, m_coverage[0]);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_nextTile = 0;
+        m_workersBusy = static_cast<unsigned>(m_workers.size());
+        ++m_frameId;
+    }
+    m_startCondition.notify_all();
+
+    rasterizeTiles(m_coverage[0]);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] { return m_workersBusy == 0; });
+}
+
+unsigned SoftwareRasterizer::getWidth() const {
+    return m_width;
+}
+
+unsigned SoftwareRasterizer::getHeight() const {
+    return m_height;
+}
+
+SoftwareRasterizer::Format SoftwareRasterizer::getFormat() const {
+    return m_format;
+}
+
+unsigned SoftwareRasterizer::getChannelCount() const {
+    return m_channels;
+}
+
+const std::uint8_t* SoftwareRasterizer::getPixels() const {
+    return m_pixels.data();
+}
+
+bool SoftwareRasterizer::saveToFile(const std::string& path) const {
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+
+    if (extension == "png") {
+        std::vector<std::uint8_t> rgba;
+        const std::uint8_t* pixels = m_pixels.data();
+        if (m_format == Format::GRAYSCALE) {
+            rgba.resize(m_pixels.size() * 4);
+            for (std::size_t i = 0; i < m_pixels.size(); ++i) {
+                rgba[i * 4] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = m_pixels[i];
+                rgba[i * 4 + 3] = 255;
+            }
+            pixels = rgba.data();
+        }
+
+        sf::Image image;
+        image.create(m_width, m_height, pixels);
+        return image.saveToFile(path);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    if (m_format == Format::GRAYSCALE) {
+        file << "P5\n" << m_width << " " << m_height << "\n255\n";
+        file.write(reinterpret_cast<const char*>(m_pixels.data()), m_pixels.size());
+    } else {
+        file << "P6\n" << m_width << " " << m_height << "\n255\n";
+        for (std::size_t i = 0; i < m_pixels.size(); i += 4) {
+            file.write(reinterpret_cast<const char*>(&m_pixels[i]), 3);
+        }
+    }
+    return file.good();
+}
+
+sf::Vector2f SoftwareRasterizer::toPixels(const sf::Vector2f& point) const {
+    return sf::Vector2f((point.x - m_view.left) * m_scale.x, (point.y - m_view.top) * m_scale.y);
+}
+
+void SoftwareRasterizer::addCommand(CommandType type, const sf::Color& color, std::size_t firstPoint) {
+    Command command;
+    command.type = type;
+    command.color = color;
+    command.firstPoint = static_cast<std::uint32_t>(firstPoint);
+    command.pointCount = static_cast<std::uint32_t>(m_points.size() - firstPoint);
+    command.minX = command.maxX = m_points[firstPoint].x;
+    command.minY = command.maxY = m_points[firstPoint].y;
+
+    for (std::size_t i = firstPoint + 1; i < m_points.size(); ++i) {
+        command.minX = std::min(command.minX, m_points[i].x);
+        command.minY = std::min(command.minY, m_points[i].y);
+        command.maxX = std::max(command.maxX, m_points[i].x);
+        command.maxY = std::max(command.maxY, m_points[i].y);
+    }
+
+    // Anti-aliased lines touch one pixel beyond their exact extent
+    command.minX -= 1.0f;
+    command.minY -= 1.0f;
+    command.maxX += 1.0f;
+    command.maxY += 1.0f;
+
+    // Drop anything entirely off screen
+    if (command.maxX < 0.0f || command.maxY < 0.0f ||
+        command.minX >= m_width || command.minY >= m_height) {
+        m_points.resize(firstPoint);
+        return;
+    }
+
+    m_commands.push_back(command);
+}
+
+void SoftwareRasterizer::rasterizeTiles(std::vector<float>& coverage) {
+    while (true) {
+        std::size_t index = m_nextTile.fetch_add(1);
+        if (index >= m_tiles.size()) {
+            break;
+        }
+        rasterizeTile(m_tiles[index], coverage);
+    }
+}
+
+void SoftwareRasterizer::rasterizeTile(const Tile& tile, std::vector<float>& coverage) {
+    // Clear
+    for (int y = tile.y0; y < tile.y1; ++y) {
+        std::uint8_t* row = &m_pixels[(static_cast<std::size_t>(y) * m_width + tile.x0) * m_channels];
+        for (int x = tile.x0; x < tile.x1; ++x) {
+            if (m_format == Format::RGBA) {
+                row[0] = m_clearColor.r;
+                row[1] = m_clearColor.g;
+                row[2] = m_clearColor.b;
+                row[3] = m_clearColor.a;
+                row += 4;
+            } else {
+                *row++ = static_cast<std::uint8_t>(
+                    (m_clearColor.r * 77 + m_clearColor.g * 150 + m_clearColor.b * 29) >> 8);
+            }
+        }
+    }
+
+    // Replay the commands that touch this tile, in order
+    for (const Command& command : m_commands) {
+        if (command.maxX < tile.x0 || command.maxY < tile.y0 ||
+            command.minX >= tile.x1 || command.minY >= tile.y1) {
+            continue;
+        }
+
+        if (command.type == CommandType::LINE) {
+            rasterizeLine(command, tile);
+        } else {
+            rasterizePolygon(command, tile, coverage);
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterizeLine(const Command& command, const Tile& tile) {
+    sf::Vector2f a = m_points[command.firstPoint];
+    sf::Vector2f b = m_points[command.firstPoint + 1];
+
+    // Work in pixel-center coordinates
+    a -= sf::Vector2f(0.5f, 0.5f);
+    b -= sf::Vector2f(0.5f, 0.5f);
+
+    bool steep = std::fabs(b.y - a.y) > std::fabs(b.x - a.x);
+    if (steep) {
+        std::swap(a.x, a.y);
+        std::swap(b.x, b.y);
+    }
+    if (a.x > b.x) {
+        std::swap(a, b);
+    }
+
+    float dx = b.x - a.x;
+    float gradient = dx > 0.0f ? (b.y - a.y) / dx : 0.0f;
+
+    // Walk the major axis, restricted to this tile's span on that axis
+    int majorStart = static_cast<int>(std::floor(a.x + 0.5f));
+    int majorEnd = static_cast<int>(std::floor(b.x + 0.5f));
+    int tileMajor0 = steep ? tile.y0 : tile.x0;
+    int tileMajor1 = steep ? tile.y1 : tile.x1;
+    int tileMinor0 = steep ? tile.x0 : tile.y0;
+    int tileMinor1 = steep ? tile.x1 : tile.y1;
+
+    majorStart = std::max(majorStart, tileMajor0);
+    majorEnd = std::min(majorEnd, tileMajor1 - 1);
+
+    for (int major = majorStart; major <= majorEnd; ++major) {
+        float minor = a.y + gradient * (major - a.x);
+        int minorFloor = static_cast<int>(std::floor(minor));
+        float fraction = minor - minorFloor;
+
+        if (minorFloor >= tileMinor0 && minorFloor < tileMinor1) {
+            if (steep) {
+                blend(minorFloor, major, command.color, 1.0f - fraction);
+            } else {
+                blend(major, minorFloor, command.color, 1.0f - fraction);
+            }
+        }
+        if (minorFloor + 1 >= tileMinor0 && minorFloor + 1 < tileMinor1) {
+            if (steep) {
+                blend(minorFloor + 1, major, command.color, fraction);
+            } else {
+                blend(major, minorFloor + 1, command.color, fraction);
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterizePolygon(const Command& command, const Tile& tile, std::vector<float>& coverage) {
+    const int kSubScanlines = 4;
+    const float kSubWeight = 1.0f / kSubScanlines;
+
+    const sf::Vector2f* points = &m_points[command.firstPoint];
+    const std::size_t count = command.pointCount;
+
+    int rowStart = std::max(tile.y0, static_cast<int>(std::floor(command.minY)));
+    int rowEnd = std::min(tile.y1, static_cast<int>(std::ceil(command.maxY)));
+    int columnStart = std::max(tile.x0, static_cast<int>(std::floor(command.minX)));
+    int columnEnd = std::min(tile.x1, static_cast<int>(std::ceil(command.maxX)));
+    if (rowStart >= rowEnd || columnStart >= columnEnd) {
+        return;
+    }
+
+    coverage.resize(static_cast<std::size_t>(columnEnd - columnStart));
+    float crossings[64];
+
+    for (int y = rowStart; y < rowEnd; ++y) {
+        std::fill(coverage.begin(), coverage.end(), 0.0f);
+        bool touched = false;
+
+        for (int sub = 0; sub < kSubScanlines; ++sub) {
+            float sampleY = y + (sub + 0.5f) * kSubWeight;
+
+            // Even-odd crossings, so concave shapes like the flipper fill correctly
+            int crossingCount = 0;
+            for (std::size_t i = 0; i < count && crossingCount < 64; ++i) {
+                const sf::Vector2f& p0 = points[i];
+                const sf::Vector2f& p1 = points[(i + 1) % count];
+                if ((p0.y <= sampleY && p1.y > sampleY) || (p1.y <= sampleY && p0.y > sampleY)) {
+                    crossings[crossingCount++] = p0.x + (sampleY - p0.y) * (p1.x - p0.x) / (p1.y - p0.y);
+                }
+            }
+            std::sort(crossings, crossings + crossingCount);
+
+            for (int i = 0; i + 1 < crossingCount; i += 2) {
+                float left = std::max(crossings[i], static_cast<float>(columnStart));
+                float right = std::min(crossings[i + 1], static_cast<float>(columnEnd));
+                if (left >= right) {
+                    continue;
+                }
+                touched = true;
+
+                // Exact horizontal coverage: partial end pixels, full pixels between
+                int leftPixel = static_cast<int>(left);
+                int rightPixel = std::min(static_cast<int>(right), columnEnd - 1);
+                if (leftPixel == rightPixel) {
+                    coverage[leftPixel - columnStart] += (right - left) * kSubWeight;
+                    continue;
+                }
+                coverage[leftPixel - columnStart] += (leftPixel + 1 - left) * kSubWeight;
+                for (int x = leftPixel + 1; x < rightPixel; ++x) {
+                    coverage[x - columnStart] += kSubWeight;
+                }
+                coverage[rightPixel - columnStart] += (right - rightPixel) * kSubWeight;
+            }
+        }
+
+        if (touched) {
+            for (int x = columnStart; x < columnEnd; ++x) {
+                float value = coverage[x - columnStart];
+                if (value > 0.0f) {
+                    blend(x, y, command.color, std::min(1.0f, value));
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRasterizer::blend(int x, int y, const sf::Color& color, float coverage) {
+    float alpha = coverage * color.a / 255.0f;
+    if (alpha <= 0.0f) {
+        return;
+    }
+
+    std::uint8_t* pixel = &m_pixels[(static_cast<std::size_t>(y) * m_width + x) * m_channels];
+    if (m_format == Format::RGBA) {
+        pixel[0] = static_cast<std::uint8_t>(pixel[0] + (color.r - pixel[0]) * alpha + 0.5f);
+        pixel[1] = static_cast<std::uint8_t>(pixel[1] + (color.g - pixel[1]) * alpha + 0.5f);
+        pixel[2] = static_cast<std::uint8_t>(pixel[2] + (color.b - pixel[2]) * alpha + 0.5f);
+        pixel[3] = static_cast<std::uint8_t>(pixel[3] + (255 - pixel[3]) * alpha + 0.5f);
+    } else {
+        int luma = (color.r * 77 + color.g * 150 + color.b * 29) >> 8;
+        pixel[0] = static_cast<std::uint8_t>(pixel[0] + (luma - pixel[0]) * alpha + 0.5f);
+    }
+}
+
+void SoftwareRasterizer::workerLoop(unsigned index) {
+    unsigned seenFrame = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [&] { return m_stopping || m_frameId != seenFrame; });
+            if (m_stopping) {
+                return;
+            }
+            seenFrame = m_frameId;
+        }
+
+        rasterizeTiles(m_coverage[index]);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_workersBusy;
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+} // namespace tempest
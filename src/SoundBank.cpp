@@ -0,0 +1,217 @@
+#include "SoundBank.hpp"
+#include <SFML/Audio.hpp>
+#include <algorithm>
+#include <cmath>
+#include "EmbeddedAssets.hpp"
+#include "Random.hpp"
+
+namespace tempest {
+
+const int SoundBank::kSoundCount;
+const unsigned SoundBank::kSampleRate;
+
+namespace {
+
+const float kPi = 3.14159265f;
+
+struct SoundSpec {
+    const char* name;
+    int priority;
+    float volume;
+};
+
+// Indexed by SoundId. The player's own death and the superzapper must always
+// be heard; shots are the most frequent and the first to give way.
+const SoundSpec kSpecs[SoundBank::kSoundCount] = {
+    {"shot", 0, 0.35f},
+    {"explosion", 1, 0.6f},
+    {"player_death", 3, 0.9f},
+    {"superzapper", 3, 0.8f},
+    {"level_clear", 2, 0.6f}
+};
+
+const char* const kExtensions[] = {".wav", ".ogg", ".flac"};
+
+std::size_t frames(float seconds) {
+    return static_cast<std::size_t>(seconds * SoundBank::kSampleRate);
+}
+
+std::int16_t toSample(float value) {
+    value = std::max(-1.0f, std::min(1.0f, value));
+    return static_cast<std::int16_t>(value * 32767.0f);
+}
+
+// Phase-accumulated oscillators, so sweeps don't click
+float square(float phase) {
+    return phase - std::floor(phase) < 0.5f ? 1.0f : -1.0f;
+}
+
+float triangle(float phase) {
+    float t = phase - std::floor(phase);
+    return 4.0f * std::fabs(t - 0.5f) - 1.0f;
+}
+
+} // namespace
+
+SoundBank::SoundBank() {
+    for (int i = 0; i < kSoundCount; ++i) {
+        m_sounds[i].priority = kSpecs[i].priority;
+        m_sounds[i].volume = kSpecs[i].volume;
+    }
+}
+
+int SoundBank::load() {
+    int decoded = 0;
+    for (int i = 0; i < kSoundCount; ++i) {
+        SoundId id = static_cast<SoundId>(i);
+        Sound& sound = m_sounds[i];
+        sound.samples.clear();
+    
+        bool found = false;
+        for (const char* extension : kExtensions) {
+            if (decode(std::string("sounds/") + getName(id) + extension, sound)) {
+                found = true;
+                break;
+            }
+        }
+    
+        if (found) {
+            decoded++;
+        } else {
+            synthesize(id, sound);
+        }
+        sound.samples.shrink_to_fit();
+    }
+    return decoded;
+}
+
+const SoundBank::Sound& SoundBank::get(SoundId id) const {
+    return m_sounds[static_cast<int>(id)];
+}
+
+std::size_t SoundBank::getByteCount() const {
+    std::size_t bytes = 0;
+    for (const Sound& sound : m_sounds) {
+        bytes += sound.samples.size() * sizeof(std::int16_t);
+    }
+    return bytes;
+}
+
+const char* SoundBank::getName(SoundId id) {
+    return kSpecs[static_cast<int>(id)].name;
+}
+
+bool SoundBank::decode(const std::string& asset, Sound& sound) {
+    const EmbeddedAsset* file = findEmbeddedAsset(asset);
+    sf::InputSoundFile input;
+    if (!file || !input.openFromMemory(file->data, file->size)) {
+        return false;
+    }
+    
+    unsigned channels = input.getChannelCount();
+    std::vector<sf::Int16> interleaved(static_cast<std::size_t>(input.getSampleCount()));
+    interleaved.resize(static_cast<std::size_t>(input.read(interleaved.data(), interleaved.size())));
+    std::size_t sourceFrames = channels > 0 ? interleaved.size() / channels : 0;
+    if (sourceFrames == 0) {
+        return false;
+    }
+    
+    // Downmix, then resample linearly to the mixer's rate
+    std::vector<float> mono(sourceFrames);
+    for (std::size_t frame = 0; frame < sourceFrames; ++frame) {
+        float sum = 0.0f;
+        for (unsigned channel = 0; channel < channels; ++channel) {
+            sum += interleaved[frame * channels + channel];
+        }
+        mono[frame] = sum / (channels * 32768.0f);
+    }
+    
+    double step = static_cast<double>(input.getSampleRate()) / kSampleRate;
+    std::size_t count = static_cast<std::size_t>(sourceFrames / step);
+    sound.samples.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        double position = i * step;
+        std::size_t index = static_cast<std::size_t>(position);
+        std::size_t next = std::min(index + 1, sourceFrames - 1);
+        float fraction = static_cast<float>(position - index);
+        sound.samples[i] = toSample(mono[index] + (mono[next] - mono[index]) * fraction);
+    }
+    return true;
+}
+
+void SoundBank::synthesize(SoundId id, Sound& sound) {
+    // Simple vector-arcade style effects: sweeps, filtered noise and
+    // arpeggios, from a fixed seed so every run sounds the same
+    Random random(static_cast<std::uint64_t>(id) + 1);
+    const float dt = 1.0f / kSampleRate;
+    float phase = 0.0f;
+    float filtered = 0.0f;
+    
+    switch (id) {
+        case SoundId::SHOT: {
+            // Fast falling square sweep
+            std::size_t count = frames(0.12f);
+            sound.samples.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                float t = static_cast<float>(i) / count;
+                phase += (1800.0f - 1500.0f * t) * dt;
+                sound.samples[i] = toSample(square(phase) * (1.0f - t) * 0.8f);
+            }
+            break;
+        }
+        case SoundId::EXPLOSION: {
+            // Noise through a low-pass whose cutoff closes as it decays
+            std::size_t count = frames(0.45f);
+            sound.samples.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                float t = static_cast<float>(i) / count;
+                float noise = random.nextFloat() * 2.0f - 1.0f;
+                filtered += (noise - filtered) * (0.6f - 0.5f * t);
+                sound.samples[i] = toSample(filtered * std::exp(-5.0f * t) * 1.6f);
+            }
+            break;
+        }
+        case SoundId::PLAYER_DEATH: {
+            // Long rumble under a slow falling tone
+            std::size_t count = frames(1.2f);
+            sound.samples.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                float t = static_cast<float>(i) / count;
+                float noise = random.nextFloat() * 2.0f - 1.0f;
+                filtered += (noise - filtered) * 0.15f;
+                phase += (440.0f - 360.0f * t) * dt;
+                float envelope = std::exp(-3.0f * t);
+                sound.samples[i] = toSample((filtered * 1.5f + triangle(phase) * 0.5f) * envelope);
+            }
+            break;
+        }
+        case SoundId::SUPERZAPPER: {
+            // Rising sweep with a fast vibrato
+            std::size_t count = frames(0.8f);
+            sound.samples.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                float t = static_cast<float>(i) / count;
+                float vibrato = std::sin(2.0f * kPi * 30.0f * t * 0.8f) * 60.0f;
+                phase += (200.0f + 1400.0f * t + vibrato) * dt;
+                float envelope = std::min(1.0f, t * 20.0f) * (1.0f - t);
+                sound.samples[i] = toSample(square(phase) * envelope * 0.7f);
+            }
+            break;
+        }
+        case SoundId::LEVEL_CLEAR: {
+            // Rising major arpeggio
+            static const float kNotes[] = {523.25f, 659.25f, 783.99f, 1046.5f};
+            const std::size_t noteFrames = frames(0.15f);
+            sound.samples.resize(noteFrames * 4);
+            for (std::size_t i = 0; i < sound.samples.size(); ++i) {
+                std::size_t note = i / noteFrames;
+                float t = static_cast<float>(i % noteFrames) / noteFrames;
+                phase += kNotes[note] * dt;
+                sound.samples[i] = toSample(triangle(phase) * (1.0f - 0.7f * t) * 0.8f);
+            }
+            break;
+        }
+    }
+}
+
+} // namespace tempest
@@ -0,0 +1,50 @@
+#include "SoundEffects.hpp"
+#include <algorithm>
+#include "Layout.hpp"
+
+namespace tempest {
+
+namespace {
+
+// Kills in one tick beyond this add nothing audible, only mixer load
+const int kMaxExplosionsPerTick = 4;
+
+} // namespace
+
+SoundEffects::SoundEffects(AudioMixer& mixer)
+    : m_mixer(mixer)
+{
+}
+
+void SoundEffects::onEvents(const GameEventQueue& events) {
+    if (!events.get<ShotFiredEvent>().empty()) {
+        m_mixer.play(SoundId::SHOT);
+    }
+    
+    int explosions = 0;
+    for (const auto& event : events.get<EnemyKilledEvent>()) {
+        if (explosions++ == kMaxExplosionsPerTick) {
+            break;
+        }
+        m_mixer.play(SoundId::EXPLOSION, 1.0f, panFor(event.position));
+    }
+    
+    if (!events.get<SuperzapperFiredEvent>().empty()) {
+        m_mixer.play(SoundId::SUPERZAPPER);
+    }
+    for (const auto& event : events.get<PlayerHitEvent>()) {
+        m_mixer.play(SoundId::PLAYER_DEATH, 1.0f, panFor(event.position));
+    }
+    if (!events.get<LevelClearedEvent>().empty()) {
+        m_mixer.play(SoundId::LEVEL_CLEAR);
+    }
+}
+
+float SoundEffects::panFor(const sf::Vector2f& position) {
+    // Half the logical width is hard left or right; kept off the extremes
+    // so nothing plays in one ear only
+    float pan = position.x / (layout::kWidth * 0.5f);
+    return std::max(-1.0f, std::min(1.0f, pan)) * 0.7f;
+}
+
+} // namespace tempest
@@ -0,0 +1,331 @@
+#include "SpectatorFeed.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include "Simulation.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tempest {
+
+const int SpectatorRecord::kMaxEnemies;
+const int SpectatorRecord::kMaxShots;
+const std::uint32_t SpectatorFeed::kSlotCount;
+
+namespace {
+
+const std::uint32_t kMagic = 0x46535054; // "TPSF"
+const std::uint32_t kVersion = 1;
+
+std::string getSystemName(const std::string& name) {
+#ifdef _WIN32
+    return "Local\\" + name;
+#else
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+#endif
+}
+
+void fillRecord(const Simulation& simulation, SpectatorRecord& record) {
+    const Player& player = simulation.getPlayer();
+    const Playfield& playfield = simulation.getPlayfield();
+    const EnemyManager& enemies = simulation.getEnemyManager();
+    
+    record.tick = simulation.getTickCount();
+    record.stateHash = simulation.getStateHash();
+    record.score = simulation.getScore();
+    record.highScore = simulation.getHighScore();
+    record.level = simulation.getLevel();
+    record.lives = simulation.getLives();
+    record.state = static_cast<std::uint8_t>(simulation.getState());
+    record.playfieldType = static_cast<std::uint8_t>(playfield.getType());
+    record.laneCount = static_cast<std::uint8_t>(playfield.getNumSegments());
+    record.playerLane = static_cast<std::uint8_t>(player.getPosition());
+    record.superzapperCharges = static_cast<std::uint8_t>(player.getSuperzapperCharges());
+    
+    // The nearest enemies matter most to a viewer, but sorting costs more
+    // than the tick can spare; pools are visited in a fixed order instead
+    int enemyCount = 0;
+    int enemyTotal = 0;
+    enemies.forEachEnemy([&record, &enemyCount, &enemyTotal](const Enemy& enemy) {
+        if (enemy.isDestroyed()) {
+            return;
+        }
+        ++enemyTotal;
+        if (enemyCount == SpectatorRecord::kMaxEnemies) {
+            return;
+        }
+        SpectatorEnemy& entry = record.enemies[enemyCount++];
+        float depth = std::min(std::max(enemy.getDepth(), 0.0f), 1.0f);
+        entry.type = static_cast<std::uint8_t>(enemy.getType());
+        entry.lane = static_cast<std::uint8_t>(enemy.getLane());
+        entry.depth = static_cast<std::uint16_t>(depth * 65535.0f);
+        entry.x = enemy.getPosition().x;
+        entry.y = enemy.getPosition().y;
+    });
+    record.enemyCount = static_cast<std::uint16_t>(enemyCount);
+    record.enemyTotal = static_cast<std::uint16_t>(std::min(enemyTotal, 0xFFFF));
+    
+    int shotCount = 0;
+    for (const Shot& shot : player.getShots()) {
+        if (!shot.isActive() || shotCount == SpectatorRecord::kMaxShots) {
+            continue;
+        }
+        SpectatorShot& entry = record.shots[shotCount++];
+        entry.lane = static_cast<std::uint8_t>(shot.getLane());
+        entry.x = shot.getPosition().x;
+        entry.y = shot.getPosition().y;
+    }
+    record.shotCount = static_cast<std::uint16_t>(shotCount);
+}
+
+} // namespace
+
+// The shared ring. The header has a cache line to itself and each slot
+// starts on its own, so a reader copying one slot never shares a line with
+// the slot being written.
+struct SpectatorFeed::Layout {
+    struct alignas(64) Slot {
+        // 2 * lap + 1 while the lap's record is written, 2 * lap + 2 once
+        // it is; only ever goes up
+        std::atomic<std::uint64_t> sequence;
+        SpectatorRecord record;
+    };
+    
+    alignas(64) std::atomic<std::uint32_t> magic; // Stored last, once the rest is set
+    std::uint32_t version;
+    std::uint32_t slotCount;
+    std::uint32_t recordSize;
+    std::uint32_t tickRate;
+    std::atomic<std::uint32_t> closed;
+    std::atomic<std::uint64_t> published; // Records published so far
+    Slot slots[kSlotCount];
+};
+
+SpectatorFeed::SpectatorFeed()
+    : m_layout(nullptr)
+    , m_published(0)
+#ifdef _WIN32
+    , m_mapping(nullptr)
+#endif
+{
+}
+
+SpectatorFeed::~SpectatorFeed() {
+    close();
+}
+
+bool SpectatorFeed::open(const std::string& name) {
+    close();
+    
+    // Processes share the ring through these, so they mustn't hide a lock
+    std::atomic<std::uint64_t> probe(0);
+    if (!probe.is_lock_free()) {
+        return false;
+    }
+    
+    std::string systemName = getSystemName(name);
+#ifdef _WIN32
+    // A named mapping lives until its last handle closes, so one still held
+    // by readers of an earlier run is taken over rather than replaced
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                        static_cast<DWORD>(sizeof(Layout)), systemName.c_str());
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(Layout)) : nullptr;
+    if (!data) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        return false;
+    }
+    m_mapping = mapping;
+#else
+    // Readers of an earlier run keep their mapping of the old ring
+    shm_unlink(systemName.c_str());
+    int file = shm_open(systemName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (file < 0) {
+        return false;
+    }
+    if (ftruncate(file, static_cast<off_t>(sizeof(Layout))) != 0) {
+        ::close(file);
+        shm_unlink(systemName.c_str());
+        return false;
+    }
+    void* data = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED) {
+        shm_unlink(systemName.c_str());
+        return false;
+    }
+#endif
+    
+    // Touching every page now keeps page faults out of the first publishes
+    std::memset(data, 0, sizeof(Layout));
+    Layout* layout = new (data) Layout;
+    layout->version = kVersion;
+    layout->slotCount = kSlotCount;
+    layout->recordSize = sizeof(SpectatorRecord);
+    layout->tickRate = Simulation::kTickRate;
+    layout->closed.store(0, std::memory_order_relaxed);
+    layout->published.store(0, std::memory_order_relaxed);
+    layout->magic.store(kMagic, std::memory_order_release);
+    
+    m_layout = layout;
+    m_name = systemName;
+    m_published = 0;
+    return true;
+}
+
+void SpectatorFeed::close() {
+    if (!m_layout) {
+        return;
+    }
+    
+    m_layout->closed.store(1, std::memory_order_release);
+#ifdef _WIN32
+    UnmapViewOfFile(m_layout);
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+#else
+    munmap(m_layout, sizeof(Layout));
+    shm_unlink(m_name.c_str());
+#endif
+    m_layout = nullptr;
+    m_name.clear();
+}
+
+bool SpectatorFeed::isOpen() const {
+    return m_layout != nullptr;
+}
+
+void SpectatorFeed::publish(const Simulation& simulation) {
+    if (!m_layout) {
+        return;
+    }
+    
+    Layout::Slot& slot = m_layout->slots[m_published % kSlotCount];
+    std::uint64_t lap = m_published / kSlotCount;
+    
+    // Odd first, so a reader copying the slot's previous record sees it
+    // change; the fence keeps the record's stores after it
+    slot.sequence.store(2 * lap + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    fillRecord(simulation, slot.record);
+    slot.sequence.store(2 * lap + 2, std::memory_order_release);
+    
+    ++m_published;
+    m_layout->published.store(m_published, std::memory_order_release);
+}
+
+SpectatorReader::SpectatorReader()
+    : m_layout(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_mapping(nullptr)
+#endif
+{
+}
+
+SpectatorReader::~SpectatorReader() {
+    close();
+}
+
+bool SpectatorReader::open(const std::string& name) {
+    close();
+    
+    std::string systemName = getSystemName(name);
+    std::size_t size = sizeof(SpectatorFeed::Layout);
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, systemName.c_str());
+    void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size) : nullptr;
+    if (!data) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        return false;
+    }
+    m_mapping = mapping;
+#else
+    int file = shm_open(systemName.c_str(), O_RDONLY, 0);
+    if (file < 0) {
+        return false;
+    }
+    // Not yet sized if the publisher is still setting it up
+    struct stat info;
+    if (fstat(file, &info) != 0 || static_cast<std::size_t>(info.st_size) < size) {
+        ::close(file);
+        return false;
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+#endif
+    m_layout = static_cast<const SpectatorFeed::Layout*>(data);
+    m_size = size;
+    
+    if (m_layout->magic.load(std::memory_order_acquire) != kMagic || m_layout->version != kVersion ||
+        m_layout->slotCount != SpectatorFeed::kSlotCount || m_layout->recordSize != sizeof(SpectatorRecord)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SpectatorReader::close() {
+    if (!m_layout) {
+        return;
+    }
+    
+#ifdef _WIN32
+    UnmapViewOfFile(m_layout);
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+#else
+    munmap(const_cast<SpectatorFeed::Layout*>(m_layout), m_size);
+#endif
+    m_layout = nullptr;
+    m_size = 0;
+}
+
+bool SpectatorReader::isOpen() const {
+    return m_layout != nullptr;
+}
+
+std::uint64_t SpectatorReader::getPublishedCount() const {
+    return m_layout ? m_layout->published.load(std::memory_order_acquire) : 0;
+}
+
+bool SpectatorReader::isClosed() const {
+    return !m_layout || m_layout->closed.load(std::memory_order_acquire) != 0;
+}
+
+SpectatorReader::Result SpectatorReader::read(std::uint64_t index, SpectatorRecord& out) const {
+    if (index >= getPublishedCount()) {
+        return Result::NOT_YET;
+    }
+    
+    // The count is stored after the record, so the slot holds record n or,
+    // if the publisher has lapped the reader since, a later one
+    const SpectatorFeed::Layout::Slot& slot = m_layout->slots[index % SpectatorFeed::kSlotCount];
+    std::uint64_t expected = 2 * (index / SpectatorFeed::kSlotCount) + 2;
+    if (slot.sequence.load(std::memory_order_acquire) != expected) {
+        return Result::OVERWRITTEN;
+    }
+    std::memcpy(&out, &slot.record, sizeof(out));
+    // The copy is good only if no write started during it
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+        return Result::OVERWRITTEN;
+    }
+    return Result::OK;
+}
+
+} // namespace tempest
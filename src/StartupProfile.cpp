@@ -0,0 +1,47 @@
+#include "StartupProfile.hpp"
+#include <iomanip>
+#include <sstream>
+
+namespace tempest {
+
+namespace {
+
+double millisecondsBetween(std::chrono::steady_clock::time_point from,
+                           std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+StartupProfile::StartupProfile()
+    : m_start(Clock::now())
+    , m_last(m_start)
+{
+}
+
+void StartupProfile::mark(const char* phase) {
+    Clock::time_point now = Clock::now();
+    m_phases.emplace_back(phase, millisecondsBetween(m_last, now));
+    m_last = now;
+}
+
+double StartupProfile::getTotalMilliseconds() const {
+    return millisecondsBetween(m_start, m_last);
+}
+
+std::string StartupProfile::getReport(double budgetMilliseconds) const {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << "Startup:";
+    for (const auto& phase : m_phases) {
+        ss << "\n  " << std::left << std::setw(12) << phase.first << std::right
+           << std::setw(9) << phase.second << " ms";
+    }
+    ss << "\n  " << std::left << std::setw(12) << "total" << std::right
+       << std::setw(9) << getTotalMilliseconds() << " ms (budget " << budgetMilliseconds << " ms)";
+    if (getTotalMilliseconds() > budgetMilliseconds) {
+        ss << " OVER BUDGET";
+    }
+    return ss.str();
+}
+
+} // namespace tempest
@@ -0,0 +1,284 @@
+#include "TimerWheel.hpp"
+#include "StateStream.hpp"
+
+namespace tempest {
+
+const TimerWheel::TimerId TimerWheel::kNoTimer;
+
+TimerWheel::TimerWheel(std::uint64_t now)
+    : m_freeHead(kNil)
+    , m_now(now)
+    , m_pendingCount(0)
+{
+    for (auto& list : m_lists) {
+        list.head = kNil;
+        list.tail = kNil;
+    }
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::uint64_t deadline, std::uint32_t kind,
+                                         std::uint32_t payload, std::uint32_t period) {
+    std::uint32_t index;
+    if (m_freeHead != kNil) {
+        index = m_freeHead;
+        m_freeHead = m_nodes[index].next;
+    } else {
+        index = static_cast<std::uint32_t>(m_nodes.size());
+        m_nodes.push_back(Node());
+        m_nodes[index].generation = 1;
+    }
+    
+    Node& node = m_nodes[index];
+    node.deadline = deadline < m_now ? m_now : deadline;
+    node.period = period;
+    node.kind = kind;
+    node.payload = payload;
+    insert(index);
+    m_pendingCount++;
+    return makeId(index);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (!find(id)) {
+        return false;
+    }
+    
+    std::uint32_t index = static_cast<std::uint32_t>(id);
+    unlink(index);
+    release(index);
+    return true;
+}
+
+bool TimerWheel::isPending(TimerId id) const {
+    return find(id) != nullptr;
+}
+
+std::uint64_t TimerWheel::getDeadline(TimerId id) const {
+    const Node* node = find(id);
+    return node ? node->deadline : 0;
+}
+
+void TimerWheel::clear() {
+    for (std::uint32_t index = 0; index < m_nodes.size(); ++index) {
+        if (m_nodes[index].list != kFree) {
+            unlink(index);
+            release(index);
+        }
+    }
+}
+
+std::uint64_t TimerWheel::getNow() const {
+    return m_now;
+}
+
+std::size_t TimerWheel::getPendingCount() const {
+    return m_pendingCount;
+}
+
+void TimerWheel::saveState(StateWriter& out) const {
+    out.writeU64(m_now);
+    out.writeU64(m_pendingCount);
+    out.writeU32(m_freeHead);
+    for (const List& list : m_lists) {
+        out.writeU32(list.head);
+        out.writeU32(list.tail);
+    }
+    out.writeU32(static_cast<std::uint32_t>(m_nodes.size()));
+    for (const Node& node : m_nodes) {
+        out.writeU64(node.deadline);
+        out.writeU32(node.period);
+        out.writeU32(node.kind);
+        out.writeU32(node.payload);
+        out.writeU32(node.generation);
+        out.writeU32(node.list);
+        out.writeU32(node.previous);
+        out.writeU32(node.next);
+    }
+}
+
+bool TimerWheel::loadState(StateReader& in) {
+    TimerWheel wheel;
+    wheel.m_now = in.readU64();
+    wheel.m_pendingCount = static_cast<std::size_t>(in.readU64());
+    wheel.m_freeHead = in.readU32();
+    for (List& list : wheel.m_lists) {
+        list.head = in.readU32();
+        list.tail = in.readU32();
+    }
+    wheel.m_nodes.resize(in.readCount(36));
+    for (Node& node : wheel.m_nodes) {
+        node.deadline = in.readU64();
+        node.period = in.readU32();
+        node.kind = in.readU32();
+        node.payload = in.readU32();
+        node.generation = in.readU32();
+        node.list = in.readU32();
+        node.previous = in.readU32();
+        node.next = in.readU32();
+    }
+    
+    // Links must stay inside the node array, or advance() would run off it
+    std::uint32_t nodeCount = static_cast<std::uint32_t>(wheel.m_nodes.size());
+    bool valid = in.ok() && (wheel.m_freeHead == kNil || wheel.m_freeHead < nodeCount);
+    for (const List& list : wheel.m_lists) {
+        valid = valid && (list.head == kNil || list.head < nodeCount) &&
+                (list.tail == kNil || list.tail < nodeCount);
+    }
+    for (const Node& node : wheel.m_nodes) {
+        valid = valid && node.list <= kFree && (node.previous == kNil || node.previous < nodeCount) &&
+                (node.next == kNil || node.next < nodeCount);
+    }
+    if (!valid) {
+        return false;
+    }
+    
+    *this = wheel;
+    return true;
+}
+
+const TimerWheel::Node* TimerWheel::find(TimerId id) const {
+    std::uint32_t index = static_cast<std::uint32_t>(id);
+    std::uint32_t generation = static_cast<std::uint32_t>(id >> 32);
+    if (index >= m_nodes.size()) {
+        return nullptr;
+    }
+    
+    const Node& node = m_nodes[index];
+    return node.generation == generation && node.list != kFree ? &node : nullptr;
+}
+
+TimerWheel::TimerId TimerWheel::makeId(std::uint32_t index) const {
+    return (static_cast<TimerId>(m_nodes[index].generation) << 32) | index;
+}
+
+void TimerWheel::insert(std::uint32_t index) {
+    // The finest level whose span reaches the deadline; anything beyond the
+    // top level's span waits in its last slot and is placed again when that
+    // slot cascades
+    std::uint64_t deadline = m_nodes[index].deadline;
+    std::uint64_t delta = deadline - m_now;
+    
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (std::uint64_t(1) << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+    
+    const std::uint64_t span = std::uint64_t(1) << (kSlotBits * kLevels);
+    if (delta >= span) {
+        deadline = m_now + span - 1;
+    }
+    
+    std::uint32_t slot = static_cast<std::uint32_t>((deadline >> (kSlotBits * level)) & (kSlots - 1));
+    pushBack(static_cast<std::uint32_t>(level * kSlots) + slot, index);
+}
+
+void TimerWheel::pushBack(std::uint32_t list, std::uint32_t index) {
+    Node& node = m_nodes[index];
+    List& target = m_lists[list];
+    node.list = list;
+    node.previous = target.tail;
+    node.next = kNil;
+    
+    if (target.tail != kNil) {
+        m_nodes[target.tail].next = index;
+    } else {
+        target.head = index;
+    }
+    target.tail = index;
+}
+
+void TimerWheel::unlink(std::uint32_t index) {
+    Node& node = m_nodes[index];
+    List& source = m_lists[node.list];
+    
+    if (node.previous != kNil) {
+        m_nodes[node.previous].next = node.next;
+    } else {
+        source.head = node.next;
+    }
+    if (node.next != kNil) {
+        m_nodes[node.next].previous = node.previous;
+    } else {
+        source.tail = node.previous;
+    }
+}
+
+void TimerWheel::release(std::uint32_t index) {
+    // Bumping the generation turns every handle to this node stale
+    Node& node = m_nodes[index];
+    if (++node.generation == 0) {
+        node.generation = 1;
+    }
+    node.list = kFree;
+    node.next = m_freeHead;
+    m_freeHead = index;
+    m_pendingCount--;
+}
+
+void TimerWheel::cascade(int level) {
+    // Everything in the slot is now within reach of a finer level
+    std::uint32_t slot = static_cast<std::uint32_t>((m_now >> (kSlotBits * level)) & (kSlots - 1));
+    List& source = m_lists[level * kSlots + slot];
+    std::uint32_t index = source.head;
+    source.head = kNil;
+    source.tail = kNil;
+    
+    while (index != kNil) {
+        std::uint32_t next = m_nodes[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+void TimerWheel::collectDue() {
+    // Coarser slots come round when the finer levels wrap
+    for (int level = 1; level < kLevels; ++level) {
+        if ((m_now & ((std::uint64_t(1) << (kSlotBits * level)) - 1)) != 0) {
+            break;
+        }
+        cascade(level);
+    }
+    
+    // The current level 0 slot holds exactly the timers due now
+    List& slot = m_lists[m_now & (kSlots - 1)];
+    std::uint32_t index = slot.head;
+    slot.head = kNil;
+    slot.tail = kNil;
+    
+    while (index != kNil) {
+        std::uint32_t next = m_nodes[index].next;
+        pushBack(kDueList, index);
+        index = next;
+    }
+    
+    m_now++;
+}
+
+bool TimerWheel::popDue(Timer& timer) {
+    // Taken one at a time, so callbacks may cancel timers still waiting here
+    std::uint32_t index = m_lists[kDueList].head;
+    if (index == kNil) {
+        return false;
+    }
+    
+    unlink(index);
+    Node& node = m_nodes[index];
+    timer.id = makeId(index);
+    timer.deadline = node.deadline;
+    timer.kind = node.kind;
+    timer.payload = node.payload;
+    
+    if (node.period != 0) {
+        // Repeating timers keep their handle
+        node.deadline += node.period;
+        if (node.deadline < m_now) {
+            node.deadline = m_now;
+        }
+        insert(index);
+    } else {
+        release(index);
+    }
+    return true;
+}
+
+} // namespace tempest
@@ -0,0 +1,80 @@
+#include "WindowWaiter.hpp"
+#include <algorithm>
+#include "Simulation.hpp"
+#include "utils.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(TEMPEST_X11)
+#include <X11/Xlib.h>
+#include <poll.h>
+#endif
+
+namespace tempest {
+
+WindowWaiter::WindowWaiter()
+#ifdef TEMPEST_X11
+    : m_display(nullptr)
+#endif
+{
+}
+
+WindowWaiter::~WindowWaiter() {
+#ifdef TEMPEST_X11
+    if (m_display) {
+        XCloseDisplay(static_cast<Display*>(m_display));
+    }
+#endif
+}
+
+void WindowWaiter::attach(sf::WindowHandle window) {
+#ifdef TEMPEST_X11
+    // Every client gets its own copy of the events it selects, so this
+    // takes nothing from SFML's connection. Closing the window is a message
+    // to SFML alone and doesn't wake it.
+    Display* display = XOpenDisplay(nullptr);
+    if (!display) {
+        Utils::printMessage("Could not open a display connection; idle screens poll for input");
+        return;
+    }
+    XSelectInput(display, window, KeyPressMask | KeyReleaseMask | FocusChangeMask |
+                                  ExposureMask | StructureNotifyMask);
+    XFlush(display);
+    m_display = display;
+#else
+    (void)window;
+#endif
+}
+
+bool WindowWaiter::wait(sf::Time timeout) {
+    if (timeout <= sf::Time::Zero) {
+        return false;
+    }
+    
+#if defined(_WIN32)
+    // Wakes for messages SFML hasn't peeked at yet, without removing them
+    DWORD milliseconds = static_cast<DWORD>(timeout.asMilliseconds());
+    return MsgWaitForMultipleObjects(0, nullptr, FALSE, milliseconds, QS_ALLINPUT) == WAIT_OBJECT_0;
+#else
+#ifdef TEMPEST_X11
+    if (m_display) {
+        Display* display = static_cast<Display*>(m_display);
+        bool ready = XPending(display) > 0;
+        if (!ready) {
+            pollfd descriptor = {ConnectionNumber(display), POLLIN, 0};
+            ready = poll(&descriptor, 1, std::max(1, timeout.asMilliseconds())) > 0;
+        }
+        // Only the wakeup matters; SFML reads the events themselves
+        while (XPending(display) > 0) {
+            XEvent event;
+            XNextEvent(display, &event);
+        }
+        return ready;
+    }
+#endif
+    sf::sleep(std::min(timeout, sf::seconds(Simulation::kTickDuration)));
+    return false;
+#endif
+}
+
+} // namespace tempest
@@ -1,12 +1,53 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include "Game.hpp"
 #include "utils.hpp"
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
         tempest::Utils::printMessage("Starting Tempest Game");
         
-        tempest::Game game;
+        // --vsync: let the display pace frames instead of the frame pacer
+        // --size WxH, --fullscreen: window size; the layout adapts to any
+        // --dynamic-resolution: lower the scene resolution when frames run long
+        // --spinner DEVICE, --spinner-counts N: evdev rotary spinner, counts per lane
+        // --no-sound: don't open the audio device
+        // --fixed-point: fixed-point simulation, reproducible on any build
+        // --spectator-feed NAME: publish each tick to shared memory for tempest_spectate
+        tempest::GameOptions options;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--vsync") == 0) {
+                options.verticalSync = true;
+            } else if (std::strcmp(argv[i], "--fullscreen") == 0) {
+                options.fullscreen = true;
+            } else if (std::strcmp(argv[i], "--dynamic-resolution") == 0) {
+                options.dynamicResolution = true;
+            } else if (std::strcmp(argv[i], "--no-sound") == 0) {
+                options.sound = false;
+            } else if (std::strcmp(argv[i], "--fixed-point") == 0) {
+                options.arithmetic = tempest::Arithmetic::FIXED_POINT;
+            } else if (std::strcmp(argv[i], "--spectator-feed") == 0 && i + 1 < argc) {
+                options.spectatorFeed = argv[++i];
+            } else if (std::strcmp(argv[i], "--spinner") == 0 && i + 1 < argc) {
+                options.input.spinnerDevice = argv[++i];
+            } else if (std::strcmp(argv[i], "--spinner-counts") == 0 && i + 1 < argc) {
+                options.input.spinnerCountsPerLane = std::max(1, std::atoi(argv[++i]));
+            } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+                unsigned width = 0;
+                unsigned height = 0;
+                if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                    std::cerr << "Invalid --size, expected WxH" << std::endl;
+                    return 1;
+                }
+                options.width = width;
+                options.height = height;
+            }
+        }
+        
+        tempest::Game game(options);
         game.run();
         
         return 0;
@@ -0,0 +1,150 @@
+// Zero-allocation check: plays a seeded session with the autopilot under the
+// allocation hooks and fails if any tick in the middle of a level touches
+// the heap, or takes a block from the level arena too big for its pools
+// (which would stay lost until the level ends). Level changes, game starts
+// and game over may allocate; a tick that starts and ends in the same level
+// may not.
+//
+//   tempest_alloc_check [--seed N] [--ticks N] [--size WxH] [--no-render]
+//
+// Only built with -DTEMPEST_ALLOC_TRACKING=ON. Each offending tick is listed
+// with its allocations per subsystem and the call sites they came from.
+//
+// Only the headless path is covered: the simulation, particles and the
+// software renderer. Game's window, SFML HUD text and audio are not.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "AllocTracker.hpp"
+#include "Autopilot.hpp"
+#include "FrameRenderer.hpp"
+#include "ParticleSystem.hpp"
+#include "Simulation.hpp"
+#include "SoftwareRasterizer.hpp"
+
+namespace {
+
+void printUsage() {
+    std::cerr << "usage: tempest_alloc_check [--seed N] [--ticks N] [--size WxH] [--no-render]\n";
+}
+
+// Offending ticks printed in full; the rest are only counted
+const int kMaxReportedTicks = 10;
+const std::size_t kSitesPerTick = 8;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::uint64_t seed = 1;
+    std::uint64_t ticks = 60 * 60 * 5;
+    unsigned width = 320;
+    unsigned height = 240;
+    bool render = true;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        
+        if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--ticks" && hasValue) {
+            ticks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--no-render") {
+            render = false;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (!tempest::AllocTracker::isEnabled()) {
+        std::cerr << tempest::AllocTracker::getReport() << std::endl;
+        return 1;
+    }
+    
+    tempest::SoftwareRasterizer rasterizer(width, height);
+    rasterizer.setView(tempest::FrameRenderer::kGameArea);
+    tempest::FrameRenderer renderer;
+    tempest::Simulation simulation(seed);
+    tempest::ParticleSystem particles(seed);
+    simulation.addListener(&particles);
+    
+    std::uint64_t midLevelTicks = 0;
+    std::uint64_t failedTicks = 0;
+    tempest::AllocTracker::Site sites[kSitesPerTick];
+    
+    for (std::uint64_t tick = 0; tick < ticks; ++tick) {
+        tempest::PlayerInput input = tempest::getAutopilotInput(simulation, tick);
+        tempest::GameState before = simulation.getState();
+        int level = simulation.getLevel();
+        std::size_t unpooled = simulation.getLevelArena().getStats().unpooledBytes;
+        
+        tempest::AllocTracker::beginFrame();
+        simulation.tick(input);
+        {
+            tempest::AllocScope scope(tempest::AllocSubsystem::PARTICLES);
+            particles.update(tempest::Simulation::kTickDuration);
+        }
+        if (render) {
+            tempest::AllocScope scope(tempest::AllocSubsystem::RENDER);
+            renderer.render(simulation, rasterizer, &particles);
+        }
+        tempest::AllocTracker::Counts frame = tempest::AllocTracker::getFrame();
+        
+        bool midLevel = before == tempest::GameState::PLAYING &&
+                        simulation.getState() == tempest::GameState::PLAYING &&
+                        simulation.getLevel() == level;
+        if (!midLevel) {
+            continue;
+        }
+        midLevelTicks++;
+        std::size_t unpooledGrowth = simulation.getLevelArena().getStats().unpooledBytes - unpooled;
+        if (frame.allocations == 0 && unpooledGrowth == 0) {
+            continue;
+        }
+        
+        if (unpooledGrowth > 0 && failedTicks < kMaxReportedTicks) {
+            std::cout << "Tick " << tick << " (level " << level << ") took " << unpooledGrowth
+                      << " bytes from the level arena that won't be recycled\n";
+        }
+        if (frame.allocations > 0 && failedTicks < kMaxReportedTicks) {
+            std::cout << "Tick " << tick << " (level " << level << ") allocated "
+                      << frame.allocations << " times, " << frame.bytes << " bytes:";
+            for (int i = 0; i < tempest::AllocTracker::kSubsystemCount; ++i) {
+                tempest::AllocSubsystem subsystem = static_cast<tempest::AllocSubsystem>(i);
+                std::uint64_t count = tempest::AllocTracker::getFrame(subsystem).allocations;
+                if (count > 0) {
+                    std::cout << " " << tempest::AllocTracker::getSubsystemName(subsystem) << " " << count;
+                }
+            }
+            std::cout << "\n";
+            
+            std::size_t siteCount = tempest::AllocTracker::getSites(sites, kSitesPerTick, true);
+            for (std::size_t i = 0; i < siteCount; ++i) {
+                std::cout << "    " << sites[i].frameAllocations << "x "
+                          << tempest::AllocTracker::describe(sites[i]) << "\n";
+            }
+        }
+        failedTicks++;
+    }
+    
+    const tempest::LevelArena::Stats& arena = simulation.getLevelArena().getStats();
+    std::cout << "Level arena: peak " << arena.peakBytesUsed << " bytes / " << arena.peakLiveBlocks
+              << " blocks, " << arena.bytesReserved << " bytes reserved, " << arena.resetCount
+              << " resets\n";
+    
+    std::cout << tempest::AllocTracker::getReport() << "\n"
+              << "Seed " << seed << ": " << ticks << " ticks, reached level " << simulation.getLevel()
+              << ", " << midLevelTicks << " mid-level ticks, " << failedTicks << " allocated"
+              << std::endl;
+    return failedTicks == 0 && midLevelTicks > 0 ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+// Seekable replay archives: converts a replay into keyframed form and jumps
+// to any tick of it without simulating from the start.
+//
+//   tempest_archive build REPLAY ARCHIVE [--interval TICKS]
+//   tempest_archive info ARCHIVE
+//   tempest_archive seek ARCHIVE TICK [--out IMAGE] [--size WxH]
+//   tempest_archive bench ARCHIVE [--seeks N] [--seed S]
+//
+// seek prints the game at that tick and can render it as a thumbnail; bench
+// times random seeks and checks each against a straight run of the session.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "FrameRenderer.hpp"
+#include "Random.hpp"
+#include "Replay.hpp"
+#include "ReplayArchive.hpp"
+#include "Simulation.hpp"
+#include "SoftwareRasterizer.hpp"
+
+namespace {
+
+void printUsage() {
+    std::cerr << "usage: tempest_archive build REPLAY ARCHIVE [--interval TICKS]\n"
+                 "       tempest_archive info ARCHIVE\n"
+                 "       tempest_archive seek ARCHIVE TICK [--out IMAGE] [--size WxH]\n"
+                 "       tempest_archive bench ARCHIVE [--seeks N] [--seed S]\n";
+}
+
+double getMilliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int build(const std::string& replayPath, const std::string& archivePath, std::uint32_t interval) {
+    tempest::Replay replay;
+    if (!replay.loadFromFile(replayPath)) {
+        std::cerr << "Failed to load replay from " << replayPath << std::endl;
+        return 1;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    if (!tempest::ReplayArchive::build(replay, archivePath, interval)) {
+        std::cerr << "Failed to write archive to " << archivePath << std::endl;
+        return 1;
+    }
+    double milliseconds = getMilliseconds(start);
+    
+    tempest::ReplayArchive archive;
+    if (!archive.open(archivePath)) {
+        std::cerr << "Failed to read back " << archivePath << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << archive.getKeyframeCount() << " keyframes for " << replay.getTickCount()
+              << " ticks, " << archive.getFileSize() << " bytes, in " << milliseconds << " ms" << std::endl;
+    return 0;
+}
+
+int info(tempest::ReplayArchive& archive) {
+    std::uint64_t ticks = archive.getTickCount();
+    bool fixedPoint = archive.getArithmetic() == tempest::Arithmetic::FIXED_POINT;
+    std::cout << "seed " << archive.getSeed() << ", high score " << archive.getHighScore()
+              << (fixedPoint ? ", fixed-point" : "") << ", from session tick " << archive.getStartTick() << "\n"
+              << ticks << " ticks (" << ticks / tempest::Simulation::kTickRate << " s), "
+              << archive.getKeyframeCount() << " keyframes every " << archive.getKeyframeInterval()
+              << " ticks\n"
+              << archive.getFileSize() << " bytes, "
+              << static_cast<double>(archive.getFileSize()) / std::max<std::uint64_t>(1, ticks)
+              << " per tick" << std::endl;
+    return 0;
+}
+
+int seek(tempest::ReplayArchive& archive, std::uint64_t tick, const std::string& imagePath,
+         unsigned width, unsigned height) {
+    tempest::Simulation simulation;
+    simulation.setLogging(false);
+    
+    auto start = std::chrono::steady_clock::now();
+    if (!archive.seek(tick, simulation)) {
+        std::cerr << "Failed to seek to tick " << tick << " of " << archive.getTickCount() << std::endl;
+        return 1;
+    }
+    double milliseconds = getMilliseconds(start);
+    
+    std::cout << "tick " << tick << ": score " << simulation.getScore() << " level "
+              << simulation.getLevel() << " lives " << simulation.getLives() << " ("
+              << milliseconds << " ms)" << std::endl;
+    
+    if (!imagePath.empty()) {
+        tempest::SoftwareRasterizer rasterizer(width, height);
+        rasterizer.setView(tempest::FrameRenderer::kGameArea);
+        tempest::FrameRenderer renderer;
+        renderer.render(simulation, rasterizer);
+        if (!rasterizer.saveToFile(imagePath)) {
+            std::cerr << "Failed to write " << imagePath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int bench(tempest::ReplayArchive& archive, int seekCount, std::uint64_t seed) {
+    std::uint64_t ticks = archive.getTickCount();
+    tempest::Random random(seed);
+    std::vector<std::uint64_t> targets(static_cast<std::size_t>(seekCount));
+    for (std::uint64_t& target : targets) {
+        target = static_cast<std::uint64_t>(random.nextFloat() * static_cast<float>(ticks + 1));
+        target = std::min(target, ticks);
+    }
+    
+    // The reference: the whole session played straight through
+    std::vector<std::uint64_t> sorted = targets;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::vector<std::uint8_t>> expected(sorted.size());
+    tempest::Simulation linear(archive.getSeed(), archive.getArithmetic());
+    linear.setLogging(false);
+    auto start = std::chrono::steady_clock::now();
+    if (!archive.seek(0, linear)) {
+        std::cerr << "Failed to load the first keyframe" << std::endl;
+        return 1;
+    }
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        if (!archive.advance(sorted[i], linear)) {
+            std::cerr << "Failed to play the archive to tick " << sorted[i] << std::endl;
+            return 1;
+        }
+        linear.saveState(expected[i]);
+    }
+    double linearMilliseconds = getMilliseconds(start);
+    
+    // Seeks in random order, each from a fresh simulation
+    int mismatches = 0;
+    double total = 0.0;
+    double worst = 0.0;
+    std::vector<std::uint8_t> state;
+    for (std::uint64_t target : targets) {
+        tempest::Simulation simulation;
+        simulation.setLogging(false);
+        start = std::chrono::steady_clock::now();
+        bool sought = archive.seek(target, simulation);
+        double milliseconds = getMilliseconds(start);
+        total += milliseconds;
+        worst = std::max(worst, milliseconds);
+        
+        state.clear();
+        simulation.saveState(state);
+        std::size_t index = std::lower_bound(sorted.begin(), sorted.end(), target) - sorted.begin();
+        if (!sought || state != expected[index]) {
+            std::cerr << "Seek to tick " << target << " does not match the straight run" << std::endl;
+            mismatches++;
+        }
+    }
+    
+    std::cout << seekCount << " seeks over " << ticks << " ticks: mean "
+              << total / std::max(1, seekCount) << " ms, worst " << worst << " ms (straight run "
+              << linearMilliseconds << " ms); " << mismatches << " mismatches" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> positional;
+    std::uint32_t interval = tempest::ReplayArchive::kDefaultKeyframeInterval;
+    std::string imagePath;
+    unsigned width = 320;
+    unsigned height = 240;
+    int seekCount = 200;
+    std::uint64_t seed = 1;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        
+        if (arg == "--interval" && hasValue) {
+            interval = static_cast<std::uint32_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--out" && hasValue) {
+            imagePath = argv[++i];
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--seeks" && hasValue) {
+            seekCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg[0] != '-') {
+            positional.push_back(arg);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    std::string command = positional.empty() ? "" : positional[0];
+    if (command == "build" && positional.size() == 3) {
+        return build(positional[1], positional[2], interval);
+    }
+    
+    bool known = (command == "info" && positional.size() == 2) ||
+                 (command == "seek" && positional.size() == 3) ||
+                 (command == "bench" && positional.size() == 2);
+    if (!known) {
+        printUsage();
+        return 1;
+    }
+    
+    tempest::ReplayArchive archive;
+    if (!archive.open(positional[1])) {
+        std::cerr << "Failed to open archive " << positional[1] << std::endl;
+        return 1;
+    }
+    if (command == "info") {
+        return info(archive);
+    }
+    if (command == "seek") {
+        return seek(archive, std::strtoull(positional[2].c_str(), nullptr, 10), imagePath, width, height);
+    }
+    return bench(archive, seekCount, seed);
+}
@@ -0,0 +1,119 @@
+// Offline audio render: re-simulates a recorded session, feeds its events to
+// the mixer exactly as the game does, and mixes the result into a WAV file
+// without an audio device. Reports how fast the mixer ran.
+//
+//   tempest_audio REPLAY [--out FILE.wav] [--voices N]
+//
+// The mix advances by one tick's worth of frames after every tick, so sounds
+// start on the frame of the tick that raised them.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AudioMixer.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include "SoundBank.hpp"
+#include "SoundEffects.hpp"
+
+namespace {
+
+void printUsage() {
+    std::cerr << "usage: tempest_audio REPLAY [--out FILE.wav] [--voices N]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string replayPath;
+    std::string outputPath;
+    int voices = tempest::AudioMixer::kDefaultVoices;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        
+        if (arg == "--out" && hasValue) {
+            outputPath = argv[++i];
+        } else if (arg == "--voices" && hasValue) {
+            voices = std::max(1, std::atoi(argv[++i]));
+        } else if (replayPath.empty() && arg[0] != '-') {
+            replayPath = arg;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (replayPath.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    tempest::Replay replay;
+    if (!replay.loadFromFile(replayPath)) {
+        std::cerr << "Failed to load replay " << replayPath << std::endl;
+        return 1;
+    }
+    
+    tempest::SoundBank bank;
+    int decoded = bank.load();
+    tempest::AudioMixer mixer(bank, voices);
+    tempest::SoundEffects effects(mixer);
+    
+    tempest::Simulation simulation(replay.getSeed(), replay.getArithmetic());
+    if (!replay.restoreStart(simulation)) {
+        std::cerr << "Failed to restore the start of " << replayPath << std::endl;
+        return 1;
+    }
+    simulation.addListener(&effects);
+    
+    const std::uint64_t tickCount = replay.getTickCount();
+    const std::uint64_t tickRate = static_cast<std::uint64_t>(replay.getTickRate());
+    const std::uint64_t sampleRate = tempest::SoundBank::kSampleRate;
+    
+    std::vector<std::int16_t> pcm;
+    pcm.reserve(static_cast<std::size_t>(tickCount * sampleRate / tickRate + 1) *
+                tempest::AudioMixer::kChannels);
+    
+    std::chrono::steady_clock::duration mixTime(0);
+    std::uint64_t framesDone = 0;
+    for (std::uint64_t tick = 0; tick < tickCount; ++tick) {
+        simulation.tick(replay.getInput(static_cast<std::size_t>(tick)));
+        
+        // Frames up to the end of this tick, so rounding never accumulates
+        std::uint64_t framesEnd = (tick + 1) * sampleRate / tickRate;
+        auto start = std::chrono::steady_clock::now();
+        mixer.render(static_cast<std::size_t>(framesEnd - framesDone), pcm);
+        mixTime += std::chrono::steady_clock::now() - start;
+        framesDone = framesEnd;
+    }
+    
+    if (!outputPath.empty()) {
+        std::vector<std::uint8_t> wav = tempest::encodeWav(pcm, tempest::AudioMixer::kChannels,
+                                                           tempest::SoundBank::kSampleRate);
+        std::ofstream file(outputPath, std::ios::binary);
+        if (!file.write(reinterpret_cast<const char*>(wav.data()), wav.size())) {
+            std::cerr << "Failed to write " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    
+    tempest::AudioMixer::Stats stats = mixer.getStats();
+    double audioSeconds = static_cast<double>(framesDone) / sampleRate;
+    double mixSeconds = std::chrono::duration<double>(mixTime).count();
+    std::cout << "Mixed " << audioSeconds << " s of audio (" << framesDone << " frames, "
+              << decoded << " of " << tempest::SoundBank::kSoundCount << " sounds from assets, "
+              << bank.getByteCount() / 1024 << " KB PCM) in " << mixSeconds * 1000.0 << " ms, "
+              << audioSeconds / std::max(mixSeconds, 1e-9) << "x real time, "
+              << mixSeconds * 1e9 / std::max<std::uint64_t>(framesDone, 1) << " ns per frame\n"
+              << stats.played << " sounds played on " << mixer.getVoiceCount() << " voices (peak "
+              << stats.peakVoices << "), " << stats.stolen << " stolen, " << stats.dropped
+              << " dropped, " << stats.commandsLost << " commands lost" << std::endl;
+    return 0;
+}
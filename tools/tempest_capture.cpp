@@ -0,0 +1,126 @@
+// Headless frame capture: plays the game with a simple scripted bot and
+// renders every tick with the software rasterizer, without a window or GPU.
+//
+//   tempest_capture [--frames N] [--size WxH] [--gray] [--threads N]
+//                   [--out DIR] [--format png|pnm] [--seed N] [--record FILE]
+//                   [--fixed-point]
+//
+// --record saves the bot's session as a replay for tempest_export.
+// --fixed-point plays in fixed-point arithmetic (see tempest_determinism).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "Autopilot.hpp"
+#include "FrameRenderer.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include "SoftwareRasterizer.hpp"
+
+namespace {
+
+void printUsage() {
+    std::cerr << "usage: tempest_capture [--frames N] [--size WxH] [--gray] [--threads N]\n"
+                 "                       [--out DIR] [--format png|pnm] [--seed N] [--record FILE]\n"
+                 "                       [--fixed-point]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long frames = 600;
+    unsigned width = 84;
+    unsigned height = 84;
+    unsigned threads = 1;
+    bool grayscale = false;
+    std::string outputDir;
+    std::string format = "png";
+    std::string recordPath;
+    std::uint64_t seed = 1;
+    tempest::Arithmetic arithmetic = tempest::Arithmetic::FLOAT;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        
+        if (arg == "--frames" && hasValue) {
+            frames = std::atol(argv[++i]);
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--threads" && hasValue) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--out" && hasValue) {
+            outputDir = argv[++i];
+        } else if (arg == "--format" && hasValue) {
+            format = argv[++i];
+        } else if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--record" && hasValue) {
+            recordPath = argv[++i];
+        } else if (arg == "--gray") {
+            grayscale = true;
+        } else if (arg == "--fixed-point") {
+            arithmetic = tempest::Arithmetic::FIXED_POINT;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    tempest::SoftwareRasterizer rasterizer(
+        width, height,
+        grayscale ? tempest::SoftwareRasterizer::Format::GRAYSCALE : tempest::SoftwareRasterizer::Format::RGBA,
+        threads);
+    rasterizer.setView(tempest::FrameRenderer::kGameArea);
+    
+    tempest::Simulation simulation(seed, arithmetic);
+    tempest::Replay replay(seed, simulation.getHighScore(), arithmetic);
+    tempest::FrameRenderer renderer;
+    tempest::ParticleSystem particles(seed);
+    simulation.addListener(&particles);
+    
+    std::string extension = format == "png" ? ".png" : (grayscale ? ".pgm" : ".ppm");
+    double renderSeconds = 0.0;
+    
+    for (long tick = 0; tick < frames; ++tick) {
+        // Also starts, continues after a level and restarts after game over
+        tempest::PlayerInput input = tempest::getAutopilotInput(simulation, static_cast<std::uint64_t>(tick));
+        
+        replay.record(input);
+        simulation.tick(input);
+        replay.recordOutcome(simulation);
+        particles.update(tempest::Simulation::kTickDuration);
+        
+        auto start = std::chrono::steady_clock::now();
+        renderer.render(simulation, rasterizer, &particles);
+        renderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        if (!outputDir.empty()) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/frame_%06ld", tick);
+            if (!rasterizer.saveToFile(outputDir + name + extension)) {
+                std::cerr << "Failed to write frame " << tick << " to " << outputDir << std::endl;
+                return 1;
+            }
+        }
+    }
+    
+    if (!recordPath.empty() && !replay.saveToFile(recordPath)) {
+        std::cerr << "Failed to write replay to " << recordPath << std::endl;
+        return 1;
+    }
+    
+    std::cout << "Rendered " << frames << " frames at " << width << "x" << height
+              << " on " << threads << " thread(s): "
+              << renderSeconds * 1000.0 / std::max(1L, frames) << " ms/frame, "
+              << frames / std::max(renderSeconds, 1e-9) << " frames/s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Finds where two recordings of the same session part: the same game
+// recorded on two machines, two builds, or two peers of a networked session.
+//
+//   tempest_desync A.dat B.dat
+//
+// Each replay holds the rolling state hash of every tick, and once two runs
+// differ their hashes never agree again, so the first differing tick is a
+// binary search over the hashes without simulating anything. The tool then
+// says whether the inputs already differed by then (the recordings disagree
+// on what was played) or not (the simulation itself diverged), and replays
+// A on this build up to that tick to show which recording it agrees with.
+// Exits 0 if the recordings agree, 1 if they part, 2 on bad input.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include "StateHash.hpp"
+
+namespace {
+
+void printUsage() {
+    std::cerr << "usage: tempest_desync A.dat B.dat\n";
+}
+
+std::string formatTick(std::uint64_t tick) {
+    // Tick and the time into the session it stands for
+    std::uint64_t seconds = tick / tempest::Simulation::kTickRate;
+    char text[64];
+    std::snprintf(text, sizeof(text), "tick %llu (%llu:%02llu)", static_cast<unsigned long long>(tick),
+                  static_cast<unsigned long long>(seconds / 60),
+                  static_cast<unsigned long long>(seconds % 60));
+    return text;
+}
+
+bool sameInput(const tempest::PlayerInput& a, const tempest::PlayerInput& b) {
+    return a.left == b.left && a.right == b.right && a.fire == b.fire && a.superzapper == b.superzapper &&
+           a.confirm == b.confirm && a.spin == b.spin;
+}
+
+bool loadReplay(const std::string& path, tempest::Replay& replay) {
+    if (!replay.loadFromFile(path)) {
+        std::cerr << path << ": not a replay this build can read" << std::endl;
+        return false;
+    }
+    if (replay.getStateHashes().empty()) {
+        std::cerr << path << ": no state hashes (recorded before replay version 5)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        printUsage();
+        return 2;
+    }
+    
+    tempest::Replay a;
+    tempest::Replay b;
+    if (!loadReplay(argv[1], a) || !loadReplay(argv[2], b)) {
+        return 2;
+    }
+    if (a.getSeed() != b.getSeed() || a.getArithmetic() != b.getArithmetic()) {
+        std::cerr << "Not the same session: the seeds or arithmetic differ" << std::endl;
+        return 2;
+    }
+    
+    const std::vector<std::uint64_t>& hashesA = a.getStateHashes();
+    const std::vector<std::uint64_t>& hashesB = b.getStateHashes();
+    std::size_t common = std::min(hashesA.size(), hashesB.size());
+    std::size_t first = tempest::statehash::findFirstDifference(hashesA, hashesB);
+    if (first == common) {
+        std::cout << "Identical for all " << common << " ticks they share";
+        if (hashesA.size() != hashesB.size()) {
+            std::cout << " (A has " << hashesA.size() << ", B " << hashesB.size() << ")";
+        }
+        std::cout << std::endl;
+        return 0;
+    }
+    
+    // Hashes are taken after each tick, so index i is tick i + 1
+    std::uint64_t tick = first + 1;
+    std::cout << "First differing state after " << formatTick(tick) << "\n";
+    
+    std::size_t inputTick = 0;
+    while (inputTick <= first && sameInput(a.getInput(inputTick), b.getInput(inputTick))) {
+        ++inputTick;
+    }
+    if (inputTick <= first) {
+        std::cout << "The inputs differ from " << formatTick(inputTick + 1)
+                  << ": the recordings disagree on what was played\n";
+    } else {
+        std::cout << "The inputs are identical up to there: the simulation diverged\n";
+    }
+    
+    tempest::Simulation simulation(a.getSeed(), a.getArithmetic());
+    if (!a.restoreStart(simulation)) {
+        std::cerr << argv[1] << ": start snapshot doesn't load in this build" << std::endl;
+        return 2;
+    }
+    simulation.setLogging(false);
+    for (std::size_t i = 0; i <= first; ++i) {
+        simulation.tick(a.getInput(i));
+    }
+    std::uint64_t local = simulation.getStateHash();
+    const char* verdict = local == hashesA[first] ? "agrees with A"
+                          : local == hashesB[first] ? "agrees with B"
+                          : "agrees with neither";
+    std::cout << "This build, replaying A, " << verdict << "; its state there: score "
+              << simulation.getScore() << " level " << simulation.getLevel() << " lives "
+              << simulation.getLives() << " lane " << simulation.getPlayer().getPosition() << ", "
+              << simulation.getEnemyManager().getEnemyCount() << " enemies, "
+              << simulation.getPlayer().getShots().size() << " shots" << std::endl;
+    return 1;
+}
@@ -0,0 +1,143 @@
+// Cross-build determinism check for the fixed-point simulation: plays an
+// autopilot session in Arithmetic::FIXED_POINT and prints a digest of the
+// game state at regular intervals, then times the same session in both
+// arithmetics.
+//
+//   tempest_determinism [--seed N] [--ticks N] [--every N]
+//
+// Build it with different compilers, optimization levels or flags (even
+// -ffast-math) and diff the output: the digests must match line for line.
+// The digest covers what the game plays out from (score, lives, level,
+// player lane, each enemy's type, lane, fixed-point depth and liveness, the
+// shots, spikes and lit lanes), not the screen positions, which are only
+// drawn.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "Autopilot.hpp"
+#include "FixedPoint.hpp"
+#include "Simulation.hpp"
+
+namespace {
+
+// FNV-1a over 32-bit words
+class Digest {
+public:
+    Digest()
+        : m_value(14695981039346656037ULL)
+    {
+    }
+    
+    void add(std::uint32_t word) {
+        for (int i = 0; i < 4; ++i) {
+            m_value ^= (word >> (8 * i)) & 0xFF;
+            m_value *= 1099511628211ULL;
+        }
+    }
+    
+    std::uint64_t getValue() const {
+        return m_value;
+    }
+    
+private:
+    std::uint64_t m_value;
+};
+
+void printUsage() {
+    std::cerr << "usage: tempest_determinism [--seed N] [--ticks N] [--every N]\n";
+}
+
+std::uint64_t digestState(const tempest::Simulation& simulation) {
+    Digest digest;
+    digest.add(static_cast<std::uint32_t>(simulation.getState()));
+    digest.add(static_cast<std::uint32_t>(simulation.getScore()));
+    digest.add(static_cast<std::uint32_t>(simulation.getLevel()));
+    digest.add(static_cast<std::uint32_t>(simulation.getLives()));
+    
+    const tempest::Player& player = simulation.getPlayer();
+    digest.add(static_cast<std::uint32_t>(player.getPosition()));
+    for (const tempest::Shot& shot : player.getShots()) {
+        digest.add(static_cast<std::uint32_t>(shot.getLane()));
+        digest.add(static_cast<std::uint32_t>(shot.getDepth()));
+        digest.add(shot.isActive() ? 1 : 0);
+    }
+    
+    // Depths and spike heights are exact fixed-point values held in floats
+    const tempest::EnemyManager& enemies = simulation.getEnemyManager();
+    enemies.forEachEnemy([&digest](const tempest::Enemy& enemy) {
+        digest.add(static_cast<std::uint32_t>(enemy.getType()));
+        digest.add(static_cast<std::uint32_t>(enemy.getLane()));
+        digest.add(static_cast<std::uint32_t>(tempest::fixed::fromFloat(enemy.getDepth())));
+        digest.add(enemy.isDestroyed() ? 1 : 0);
+    });
+    int lanes = simulation.getPlayfield().getNumSegments();
+    for (int lane = 0; lane < lanes; ++lane) {
+        digest.add(static_cast<std::uint32_t>(tempest::fixed::fromFloat(enemies.getSpikeHeight(lane))));
+    }
+    std::uint64_t electrified = enemies.getElectrifiedLanes();
+    digest.add(static_cast<std::uint32_t>(electrified));
+    digest.add(static_cast<std::uint32_t>(electrified >> 32));
+    return digest.getValue();
+}
+
+// Mean microseconds per tick over a whole session
+double timeSession(std::uint64_t seed, tempest::Arithmetic arithmetic, long ticks) {
+    tempest::Simulation simulation(seed, arithmetic);
+    simulation.setLogging(false);
+    
+    auto start = std::chrono::steady_clock::now();
+    for (long tick = 0; tick < ticks; ++tick) {
+        simulation.tick(tempest::getAutopilotInput(simulation, static_cast<std::uint64_t>(tick)));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e6 / static_cast<double>(ticks);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::uint64_t seed = 1;
+    long ticks = 60L * 60 * tempest::Simulation::kTickRate; // An hour of play
+    long every = 60L * tempest::Simulation::kTickRate;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+    
+        if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--ticks" && hasValue) {
+            ticks = std::atol(argv[++i]);
+        } else if (arg == "--every" && hasValue) {
+            every = std::atol(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (ticks <= 0 || every <= 0) {
+        printUsage();
+        return 1;
+    }
+    
+    tempest::Simulation simulation(seed, tempest::Arithmetic::FIXED_POINT);
+    simulation.setLogging(false);
+    for (long tick = 0; tick < ticks; ++tick) {
+        simulation.tick(tempest::getAutopilotInput(simulation, static_cast<std::uint64_t>(tick)));
+        if ((tick + 1) % every == 0 || tick + 1 == ticks) {
+            std::printf("tick %ld  score %d  level %d  digest %016llx\n", tick + 1, simulation.getScore(),
+                        simulation.getLevel(), static_cast<unsigned long long>(digestState(simulation)));
+        }
+    }
+    
+    // To stderr, so timings don't get in the way of diffing the digests
+    double floatCost = timeSession(seed, tempest::Arithmetic::FLOAT, ticks);
+    double fixedCost = timeSession(seed, tempest::Arithmetic::FIXED_POINT, ticks);
+    std::fprintf(stderr, "per tick: float %.2f us, fixed-point %.2f us\n", floatCost, fixedCost);
+    return 0;
+}
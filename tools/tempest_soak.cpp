@@ -0,0 +1,404 @@
+// Soak test: plays autopilot sessions back to back (menu, game, game over,
+// menu again) as fast as the machine allows, for days of simulated play, and
+// watches for the failures that only show after a long uptime: memory that
+// keeps growing, timers and float accumulators that drift, and ticks that
+// get slower. Each game is recorded into a replay the way Game does it, and
+// the first one is played back from its start snapshot to check it.
+//
+//   tempest_soak [--seed N] [--hours H] [--sample-minutes M] [--render]
+//                [--size WxH] [--csv FILE]
+//
+// Every M simulated minutes it samples resident memory, heap in use, arena
+// size, entity counts, tick time and the accumulators. After a warm-up, the
+// run is split into thirds: a series whose lowest value in the last third is
+// above its highest in the first has grown for the whole run, and is flagged.
+// So are accumulators out of range, timers off their schedule and a tick
+// cost that rose by more than a quarter. Exits 1 if anything was flagged.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AllocTracker.hpp"
+#include "Autopilot.hpp"
+#include "FrameRenderer.hpp"
+#include "ParticleSystem.hpp"
+#include "Replay.hpp"
+#include "Simulation.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "TimerWheel.hpp"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define TEMPEST_HAVE_MALLINFO2
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// The game's menu blink, run on its own wheel as Game does
+const std::uint32_t kBlinkTicks = tempest::Simulation::kTickRate / 2;
+
+// Growth smaller than this is noise (page granularity, allocator slack)
+const double kResidentAllowanceKilobytes = 1024.0;
+const double kHeapAllowanceBytes = 256.0 * 1024.0;
+const double kCountAllowance = 4.0;
+const double kTickCostAllowance = 1.25; // Last third over first
+
+struct Sample {
+    double hours;                  // Simulated
+    std::uint64_t games;
+    std::size_t residentKilobytes; // 0 where unknown
+    std::size_t heapBytes;         // 0 where unknown
+    std::uint64_t liveAllocations; // Allocation tracking builds only
+    std::size_t arenaBytes;        // Reserved by the level arena
+    std::size_t enemies;
+    std::size_t shots;
+    std::size_t particles;
+    std::size_t timers;            // Pending on the simulation's wheel
+    double meanTickMicroseconds;
+    double maxTickMicroseconds;
+    float maxRotation;             // Largest enemy rotation angle
+    std::int64_t clockSkew;        // Timer wheel tick minus simulation tick
+    std::int64_t blinkDrift;       // Blinks fired minus blinks due by now
+    std::size_t replayTicks;       // Recorded so far in the game in progress
+};
+
+void printUsage() {
+    std::cerr << "usage: tempest_soak [--seed N] [--hours H] [--sample-minutes M] [--render]\n"
+              << "                    [--size WxH] [--csv FILE]\n";
+}
+
+std::size_t getResidentKilobytes() {
+#ifdef __linux__
+    // Second field of statm: resident pages
+    std::ifstream statm("/proc/self/statm");
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    if (statm >> size >> resident) {
+        return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+    }
+#endif
+    return 0;
+}
+
+std::size_t getHeapBytes() {
+#ifdef TEMPEST_HAVE_MALLINFO2
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// Lowest value in the last third above the highest in the first, by more
+// than the allowance; series that were never measured (all zero) never grow
+template <typename Field>
+bool hasGrown(const std::vector<Sample>& samples, std::size_t first, Field field, double allowance) {
+    std::size_t third = (samples.size() - first) / 3;
+    double early = 0.0;
+    double late = static_cast<double>(field(samples[samples.size() - third]));
+    bool measured = false;
+    for (std::size_t i = first; i < first + third; ++i) {
+        early = std::max(early, static_cast<double>(field(samples[i])));
+    }
+    for (std::size_t i = samples.size() - third; i < samples.size(); ++i) {
+        late = std::min(late, static_cast<double>(field(samples[i])));
+    }
+    for (const Sample& sample : samples) {
+        measured = measured || field(sample) != 0;
+    }
+    return measured && late > early + allowance;
+}
+
+template <typename Field>
+double median(const std::vector<Sample>& samples, std::size_t begin, std::size_t end, Field field) {
+    std::vector<double> values;
+    for (std::size_t i = begin; i < end; ++i) {
+        values.push_back(field(samples[i]));
+    }
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+void printSample(const Sample& sample) {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%7.1fh  games %6llu  rss %7zu KB  heap %7zu KB  arena %5zu KB  "
+                  "enemies %3zu  shots %2zu  particles %4zu  timers %3zu  "
+                  "tick %6.2f/%7.2f us  rotation %5.1f",
+                  sample.hours, static_cast<unsigned long long>(sample.games),
+                  sample.residentKilobytes, sample.heapBytes / 1024, sample.arenaBytes / 1024,
+                  sample.enemies, sample.shots, sample.particles, sample.timers,
+                  sample.meanTickMicroseconds, sample.maxTickMicroseconds, sample.maxRotation);
+    std::cout << line << std::endl;
+}
+
+void writeCsv(const std::vector<Sample>& samples, const std::string& path) {
+    std::ofstream file(path);
+    file << "hours,games,rss_kb,heap_bytes,live_allocations,arena_bytes,enemies,shots,particles,"
+            "timers,mean_tick_us,max_tick_us,max_rotation,clock_skew,blink_drift,replay_ticks\n";
+    for (const Sample& sample : samples) {
+        file << sample.hours << "," << sample.games << "," << sample.residentKilobytes << ","
+             << sample.heapBytes << "," << sample.liveAllocations << "," << sample.arenaBytes << ","
+             << sample.enemies << "," << sample.shots << "," << sample.particles << ","
+             << sample.timers << "," << sample.meanTickMicroseconds << ","
+             << sample.maxTickMicroseconds << "," << sample.maxRotation << ","
+             << sample.clockSkew << "," << sample.blinkDrift << "," << sample.replayTicks << "\n";
+    }
+}
+
+// A finished game's replay, played from its start snapshot, ends where the
+// game did
+bool replaysTo(const tempest::Replay& replay, std::uint64_t stateHash) {
+    tempest::Simulation simulation(replay.getSeed(), replay.getArithmetic());
+    if (!replay.restoreStart(simulation)) {
+        return false;
+    }
+    simulation.setLogging(false);
+    for (std::size_t tick = 0; tick < replay.getTickCount(); ++tick) {
+        simulation.tick(replay.getInput(tick));
+    }
+    return simulation.getStateHash() == stateHash;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::uint64_t seed = 1;
+    double hours = 24.0;
+    double sampleMinutes = 10.0;
+    bool render = false;
+    unsigned width = 320;
+    unsigned height = 240;
+    std::string csvPath;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+    
+        if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--hours" && hasValue) {
+            hours = std::atof(argv[++i]);
+        } else if (arg == "--sample-minutes" && hasValue) {
+            sampleMinutes = std::atof(argv[++i]);
+        } else if (arg == "--render") {
+            render = true;
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) != 2 || width == 0 || height == 0) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--csv" && hasValue) {
+            csvPath = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    const std::uint64_t ticksPerHour = tempest::Simulation::kTickRate * 60 * 60;
+    const std::uint64_t totalTicks = static_cast<std::uint64_t>(hours * ticksPerHour);
+    const std::uint64_t sampleTicks = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(sampleMinutes * tempest::Simulation::kTickRate * 60));
+    if (totalTicks == 0 || sampleMinutes <= 0.0) {
+        printUsage();
+        return 1;
+    }
+    
+    tempest::SoftwareRasterizer rasterizer(width, height);
+    rasterizer.setView(tempest::FrameRenderer::kGameArea);
+    tempest::FrameRenderer renderer;
+    tempest::Simulation simulation(seed);
+    tempest::ParticleSystem particles(seed);
+    simulation.addListener(&particles);
+    
+    tempest::TimerWheel uiTimers;
+    uiTimers.schedule(kBlinkTicks, 0, 0, kBlinkTicks);
+    std::uint64_t blinks = 0;
+    
+    tempest::Replay replay(seed, simulation.getHighScore(), simulation.getArithmetic());
+    bool recording = false;
+    std::size_t longestReplay = 0;
+    int replayChecked = -1; // Until the first game ends, then whether it replayed
+    
+    std::cout << "Soak: seed " << seed << ", " << hours << " simulated hours (" << totalTicks
+              << " ticks), sampling every " << sampleMinutes << " minutes"
+              << (render ? ", rendering" : "") << std::endl;
+    
+    std::vector<Sample> samples;
+    std::uint64_t games = 0;
+    int highestLevel = 0;
+    Clock::duration windowTime = Clock::duration::zero();
+    Clock::duration windowMax = Clock::duration::zero();
+    std::uint64_t windowTicks = 0;
+    Clock::time_point start = Clock::now();
+    
+    for (std::uint64_t tick = 0; tick < totalTicks; ++tick) {
+        tempest::PlayerInput input = tempest::getAutopilotInput(simulation, tick);
+        tempest::GameState before = simulation.getState();
+    
+        Clock::time_point tickStart = Clock::now();
+        if (before == tempest::GameState::MENU && input.confirm) {
+            replay.start(simulation);
+            recording = true;
+        }
+        if (recording) {
+            replay.record(input);
+        }
+        simulation.tick(input);
+        if (recording) {
+            replay.recordOutcome(simulation);
+        }
+        particles.update(tempest::Simulation::kTickDuration);
+        if (render) {
+            renderer.render(simulation, rasterizer, &particles);
+        }
+        Clock::duration elapsed = Clock::now() - tickStart;
+        windowTime += elapsed;
+        windowMax = std::max(windowMax, elapsed);
+        windowTicks++;
+    
+        uiTimers.advance([&blinks](const tempest::TimerWheel::Timer&) {
+            blinks++;
+        });
+    
+        if (before == tempest::GameState::MENU && simulation.getState() == tempest::GameState::PLAYING) {
+            games++;
+        }
+        highestLevel = std::max(highestLevel, simulation.getLevel());
+        if (recording && simulation.getState() == tempest::GameState::GAME_OVER) {
+            recording = false;
+            longestReplay = std::max(longestReplay, replay.getTickCount());
+            if (replayChecked < 0) {
+                replayChecked = replaysTo(replay, simulation.getStateHash()) ? 1 : 0;
+            }
+        }
+    
+        if ((tick + 1) % sampleTicks != 0 && tick + 1 != totalTicks) {
+            continue;
+        }
+    
+        Sample sample = Sample();
+        sample.hours = static_cast<double>(tick + 1) / ticksPerHour;
+        sample.games = games;
+        sample.residentKilobytes = getResidentKilobytes();
+        sample.heapBytes = getHeapBytes();
+        tempest::AllocTracker::Counts heap = tempest::AllocTracker::getTotal();
+        sample.liveAllocations = heap.allocations - heap.frees;
+        sample.arenaBytes = simulation.getLevelArena().getStats().bytesReserved;
+        sample.enemies = simulation.getEnemyManager().getEnemyCount();
+        sample.shots = simulation.getPlayer().getShots().size();
+        sample.particles = particles.getCount();
+        sample.timers = simulation.getTimers().getPendingCount();
+        sample.meanTickMicroseconds =
+            std::chrono::duration<double, std::micro>(windowTime).count() / windowTicks;
+        sample.maxTickMicroseconds = std::chrono::duration<double, std::micro>(windowMax).count();
+        simulation.getEnemyManager().forEachEnemy([&sample](const tempest::Enemy& enemy) {
+            sample.maxRotation = std::max(sample.maxRotation, enemy.getRotation());
+        });
+        sample.clockSkew = static_cast<std::int64_t>(simulation.getTimers().getNow() - simulation.getTickCount());
+        sample.blinkDrift = static_cast<std::int64_t>(blinks - tick / kBlinkTicks);
+        sample.replayTicks = recording ? replay.getTickCount() : 0;
+    
+        samples.push_back(sample);
+        printSample(sample);
+        windowTime = Clock::duration::zero();
+        windowMax = Clock::duration::zero();
+        windowTicks = 0;
+    }
+    
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "\n" << games << " games, highest level " << highestLevel << ", "
+              << static_cast<int>(hours * 3600.0 / std::max(seconds, 1e-9)) << "x real time ("
+              << seconds << " s), longest game replay " << longestReplay << " ticks\n";
+    if (!csvPath.empty()) {
+        writeCsv(samples, csvPath);
+    }
+    
+    // Accumulators and clocks are checked at every sample
+    std::vector<std::string> problems;
+    for (const Sample& sample : samples) {
+        if (sample.maxRotation < 0.0f || sample.maxRotation >= 360.0f) {
+            problems.push_back("enemy rotation angle left [0, 360) at " + std::to_string(sample.hours) + " h");
+            break;
+        }
+    }
+    for (const Sample& sample : samples) {
+        if (sample.clockSkew != samples.front().clockSkew) {
+            problems.push_back("simulation timers drifted from the tick count at " +
+                               std::to_string(sample.hours) + " h");
+            break;
+        }
+    }
+    for (const Sample& sample : samples) {
+        if (sample.blinkDrift != 0) {
+            problems.push_back("blink timer off its period by " + std::to_string(sample.blinkDrift) +
+                               " at " + std::to_string(sample.hours) + " h");
+            break;
+        }
+    }
+    if (replayChecked == 0) {
+        problems.push_back("the first game's replay does not play back to where the game ended");
+    }
+    if (games < 2) {
+        problems.push_back("the bot never got past its first game; nothing was cycled");
+    }
+    
+    // Trends need the warm-up (first tenth) out of the way and enough left
+    std::size_t warmUp = std::max<std::size_t>(1, samples.size() / 10);
+    if (samples.size() < warmUp + 6) {
+        std::cout << "Too few samples for trends; run longer or sample more often\n";
+    } else {
+        struct Trend {
+            const char* name;
+            double (*field)(const Sample&);
+            double allowance;
+        };
+        const Trend trends[] = {
+            {"resident memory", [](const Sample& s) { return static_cast<double>(s.residentKilobytes); },
+             kResidentAllowanceKilobytes},
+            {"heap in use", [](const Sample& s) { return static_cast<double>(s.heapBytes); },
+             kHeapAllowanceBytes},
+            {"live allocations", [](const Sample& s) { return static_cast<double>(s.liveAllocations); },
+             kCountAllowance},
+            {"arena size", [](const Sample& s) { return static_cast<double>(s.arenaBytes); }, 0.0},
+            {"enemy count", [](const Sample& s) { return static_cast<double>(s.enemies); }, kCountAllowance},
+            {"particle count", [](const Sample& s) { return static_cast<double>(s.particles); },
+             kCountAllowance},
+            {"pending timers", [](const Sample& s) { return static_cast<double>(s.timers); },
+             kCountAllowance}
+        };
+        for (const Trend& trend : trends) {
+            if (hasGrown(samples, warmUp, trend.field, trend.allowance)) {
+                problems.push_back(std::string(trend.name) + " grew throughout the run");
+            }
+        }
+    
+        std::size_t third = (samples.size() - warmUp) / 3;
+        auto tickCost = [](const Sample& s) { return s.meanTickMicroseconds; };
+        double early = median(samples, warmUp, warmUp + third, tickCost);
+        double late = median(samples, samples.size() - third, samples.size(), tickCost);
+        std::cout << "Median tick: " << early << " us early, " << late << " us late\n";
+        if (late > early * kTickCostAllowance) {
+            problems.push_back("tick cost rose from " + std::to_string(early) + " to " +
+                               std::to_string(late) + " us");
+        }
+    }
+    
+    for (const std::string& problem : problems) {
+        std::cout << "FLAGGED: " << problem << "\n";
+    }
+    std::cout << (problems.empty() ? "No drift or growth found" : "Soak test failed") << std::endl;
+    return problems.empty() ? 0 : 1;
+}
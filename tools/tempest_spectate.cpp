@@ -0,0 +1,190 @@
+// Both ends of a spectator feed (see SpectatorFeed.hpp), for trying out
+// overlays and checking what publishing costs.
+//
+//   tempest_spectate host NAME [--seed N] [--ticks N] [--realtime]
+//   tempest_spectate watch NAME [--every N]
+//
+// host plays an autopilot session, publishing every tick under NAME, and
+// reports what each publish cost; it runs flat out unless --realtime paces
+// it like the game. watch follows the feed the game (--spectator-feed NAME)
+// or a host publishes, printing every Nth tick and counting the records it
+// fell too far behind to read. It waits for a feed to appear, and attaches
+// to the next one when the publisher closes it or stops publishing.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Autopilot.hpp"
+#include "Simulation.hpp"
+#include "SpectatorFeed.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// A feed that hasn't moved for this long is taken for abandoned
+const std::chrono::seconds kStallTimeout(2);
+const std::chrono::milliseconds kPollInterval(1);
+const std::chrono::milliseconds kAttachInterval(100);
+
+void printUsage() {
+    std::cerr << "usage: tempest_spectate host NAME [--seed N] [--ticks N] [--realtime]\n"
+              << "       tempest_spectate watch NAME [--every N]\n";
+}
+
+double getPercentile(std::vector<double>& values, double fraction) {
+    std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+int host(const std::string& name, std::uint64_t seed, long ticks, bool realtime) {
+    tempest::SpectatorFeed feed;
+    if (!feed.open(name)) {
+        std::cerr << "Failed to open spectator feed " << name << std::endl;
+        return 1;
+    }
+    
+    tempest::Simulation simulation(seed);
+    simulation.setLogging(false);
+    std::vector<double> publishCosts;
+    publishCosts.reserve(static_cast<std::size_t>(ticks));
+    double tickSeconds = 0.0;
+    
+    Clock::duration tickPeriod = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / tempest::Simulation::kTickRate));
+    Clock::time_point nextTick = Clock::now();
+    for (long tick = 0; tick < ticks; ++tick) {
+        Clock::time_point start = Clock::now();
+        simulation.tick(tempest::getAutopilotInput(simulation, static_cast<std::uint64_t>(tick)));
+        Clock::time_point ticked = Clock::now();
+        feed.publish(simulation);
+        Clock::time_point published = Clock::now();
+    
+        tickSeconds += std::chrono::duration<double>(ticked - start).count();
+        publishCosts.push_back(std::chrono::duration<double, std::micro>(published - ticked).count());
+        if (realtime) {
+            nextTick += tickPeriod;
+            std::this_thread::sleep_until(nextTick);
+        }
+    }
+    feed.close();
+    
+    double meanCost = 0.0;
+    for (double cost : publishCosts) {
+        meanCost += cost;
+    }
+    meanCost /= static_cast<double>(publishCosts.size());
+    std::printf("%ld ticks published as %s, final score %d level %d\n", ticks, name.c_str(),
+                simulation.getScore(), simulation.getLevel());
+    std::printf("publish: mean %.3f us, median %.3f us, 99th %.3f us, 99.9th %.3f us, max %.3f us\n",
+                meanCost, getPercentile(publishCosts, 0.5), getPercentile(publishCosts, 0.99),
+                getPercentile(publishCosts, 0.999), getPercentile(publishCosts, 1.0));
+    std::printf("tick: mean %.3f us\n", tickSeconds * 1e6 / static_cast<double>(ticks));
+    return 0;
+}
+
+void printRecord(const tempest::SpectatorRecord& record) {
+    std::printf("tick %llu  state %d  score %d  level %d  lives %d  lane %d/%d  enemies %d/%d  shots %d"
+                "  hash %016llx\n",
+                static_cast<unsigned long long>(record.tick), record.state, record.score, record.level,
+                record.lives, record.playerLane, record.laneCount, record.enemyCount, record.enemyTotal,
+                record.shotCount, static_cast<unsigned long long>(record.stateHash));
+    std::fflush(stdout);
+}
+
+int watch(const std::string& name, long every) {
+    tempest::SpectatorReader reader;
+    tempest::SpectatorRecord record;
+    
+    for (;;) {
+        if (!reader.open(name)) {
+            std::this_thread::sleep_for(kAttachInterval);
+            continue;
+        }
+        // Join at the newest record rather than replaying the ring
+        std::uint64_t next = reader.getPublishedCount();
+        next = next > 0 ? next - 1 : 0;
+        std::uint64_t read = 0;
+        std::uint64_t dropped = 0;
+        std::printf("attached to %s at record %llu\n", name.c_str(), static_cast<unsigned long long>(next));
+        std::fflush(stdout);
+    
+        Clock::time_point lastProgress = Clock::now();
+        for (;;) {
+            tempest::SpectatorReader::Result result = reader.read(next, record);
+            if (result == tempest::SpectatorReader::Result::OK) {
+                if (record.tick % static_cast<std::uint64_t>(every) == 0) {
+                    printRecord(record);
+                }
+                ++read;
+                ++next;
+                lastProgress = Clock::now();
+            } else if (result == tempest::SpectatorReader::Result::OVERWRITTEN &&
+                       reader.getPublishedCount() > next) {
+                // Lapped: skip to the newest record
+                std::uint64_t newest = reader.getPublishedCount() - 1;
+                dropped += newest - next;
+                next = newest;
+            } else if (reader.isClosed() || Clock::now() - lastProgress > kStallTimeout) {
+                break;
+            } else {
+                std::this_thread::sleep_for(kPollInterval);
+            }
+        }
+        std::printf("%s %s: %llu records read, %llu dropped\n", name.c_str(),
+                    reader.isClosed() ? "closed" : "stalled", static_cast<unsigned long long>(read),
+                    static_cast<unsigned long long>(dropped));
+        std::fflush(stdout);
+        reader.close();
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    std::string command = argv[1];
+    std::string name = argv[2];
+    
+    std::uint64_t seed = 1;
+    long ticks = 60L * 60 * tempest::Simulation::kTickRate; // An hour of play
+    bool realtime = false;
+    long every = tempest::Simulation::kTickRate;
+    
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+    
+        if (command == "host" && arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (command == "host" && arg == "--ticks" && hasValue) {
+            ticks = std::atol(argv[++i]);
+        } else if (command == "host" && arg == "--realtime") {
+            realtime = true;
+        } else if (command == "watch" && arg == "--every" && hasValue) {
+            every = std::atol(argv[++i]);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (command == "host" && ticks > 0) {
+        return host(name, seed, ticks, realtime);
+    }
+    if (command == "watch" && every > 0) {
+        return watch(name, every);
+    }
+    printUsage();
+    return 1;
+}
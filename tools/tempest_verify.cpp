@@ -0,0 +1,331 @@
+// Replay verification for tournament results: re-simulates recorded
+// sessions headless and checks each one's final score, level and length
+// against its claim, spreading the files over a pool of threads.
+//
+//   tempest_verify PATH... [--claims FILE] [--threads N]
+//
+// PATH is a replay or a directory of them (every *.dat inside). A replay's
+// own last checkpoint is its claim unless --claims gives one, as lines of
+// "NAME SCORE LEVEL TICKS" keyed by file name. Along the way the re-run is
+// compared with every recorded checkpoint and state hash, so a mismatch comes
+// with the first tick where the two runs differ, even one that never reached
+// the score. Exits 1 unless every replay passed.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Replay.hpp"
+#include "Simulation.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace {
+
+struct Claim {
+    int score;
+    int level;
+    std::uint64_t ticks;
+};
+
+enum class Verdict {
+    PASSED,
+    FAILED,     // Re-run disagrees with the claim or the checkpoints
+    UNCLAIMED,  // Nothing to check against (version 2 file, no claims entry)
+    UNREADABLE
+};
+
+struct Job {
+    std::string path;
+    std::string name;
+    bool claimed;
+    Claim claim;
+    
+    // Filled in by the worker
+    Verdict verdict;
+    Claim result;
+    std::int64_t divergedAt; // First tick off the checkpoints, -1 if none
+    std::string detail;
+};
+
+void printUsage() {
+    std::cerr << "usage: tempest_verify PATH... [--claims FILE] [--threads N]\n";
+}
+
+std::string getFileName(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool hasReplayExtension(const std::string& name) {
+    return name.size() > 4 && name.compare(name.size() - 4, 4, ".dat") == 0;
+}
+
+// Replays directly inside a directory; false if it can't be listed
+bool listReplays(const std::string& directory, std::vector<std::string>& paths) {
+#ifdef _WIN32
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA((directory + "\\*.dat").c_str(), &entry);
+    if (find == INVALID_HANDLE_VALUE) {
+        return GetLastError() == ERROR_FILE_NOT_FOUND;
+    }
+    do {
+        if (!(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            paths.push_back(directory + "\\" + entry.cFileName);
+        }
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+    return true;
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return false;
+    }
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (hasReplayExtension(name)) {
+            paths.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+    return true;
+#endif
+}
+
+bool isDirectory(const std::string& path) {
+#ifdef _WIN32
+    DWORD attributes = GetFileAttributesA(path.c_str());
+    return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    DIR* dir = opendir(path.c_str());
+    if (dir) {
+        closedir(dir);
+    }
+    return dir != nullptr;
+#endif
+}
+
+bool loadClaims(const std::string& path, std::map<std::string, Claim>& claims) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string name;
+        Claim claim;
+        if (!(fields >> name >> claim.score >> claim.level >> claim.ticks)) {
+            return false;
+        }
+        claims[name] = claim;
+    }
+    return true;
+}
+
+std::string formatTick(std::int64_t tick) {
+    // Tick and the time into the session it stands for
+    std::int64_t seconds = tick / tempest::Simulation::kTickRate;
+    char text[64];
+    std::snprintf(text, sizeof(text), "tick %lld (%lld:%02lld)", static_cast<long long>(tick),
+                  static_cast<long long>(seconds / 60), static_cast<long long>(seconds % 60));
+    return text;
+}
+
+void verify(Job& job) {
+    job.divergedAt = -1;
+    
+    tempest::Replay replay;
+    if (!replay.loadFromFile(job.path)) {
+        job.verdict = Verdict::UNREADABLE;
+        job.detail = "not a replay this build can read";
+        return;
+    }
+    
+    const std::vector<tempest::Replay::Checkpoint>& checkpoints = replay.getCheckpoints();
+    const std::vector<std::uint64_t>& hashes = replay.getStateHashes();
+    if (!job.claimed && !checkpoints.empty()) {
+        job.claimed = true;
+        job.claim.score = checkpoints.back().score;
+        job.claim.level = checkpoints.back().level;
+        job.claim.ticks = replay.getTickCount();
+    }
+    
+    tempest::Simulation simulation(replay.getSeed(), replay.getArithmetic());
+    if (!replay.restoreStart(simulation)) {
+        job.verdict = Verdict::UNREADABLE;
+        job.detail = "start snapshot doesn't load in this build";
+        return;
+    }
+    simulation.setLogging(false);
+    
+    // The checkpoint in force after each tick is the last one taken by then
+    const tempest::Replay::Checkpoint* expected = nullptr;
+    std::size_t next = 0;
+    for (std::size_t tick = 0; tick < replay.getTickCount(); ++tick) {
+        simulation.tick(replay.getInput(tick));
+    
+        // Checkpoints count the session's ticks; divergence is told within the replay
+        std::uint64_t done = simulation.getTickCount();
+        while (next < checkpoints.size() && checkpoints[next].tick <= done) {
+            expected = &checkpoints[next++];
+        }
+        if (job.divergedAt < 0 && tick < hashes.size() && hashes[tick] != simulation.getStateHash()) {
+            job.divergedAt = static_cast<std::int64_t>(tick + 1);
+            job.detail = "state diverged at " + formatTick(job.divergedAt);
+        }
+        if (job.divergedAt < 0 && expected &&
+            (expected->score != simulation.getScore() || expected->level != simulation.getLevel() ||
+             expected->lives != simulation.getLives())) {
+            job.divergedAt = static_cast<std::int64_t>(tick + 1);
+            std::ostringstream detail;
+            detail << "diverged at " << formatTick(job.divergedAt) << ": recorded score "
+                   << expected->score << " level " << expected->level << " lives " << expected->lives
+                   << ", re-run score " << simulation.getScore() << " level " << simulation.getLevel()
+                   << " lives " << simulation.getLives();
+            job.detail = detail.str();
+        }
+    }
+    
+    job.result.score = simulation.getScore();
+    job.result.level = simulation.getLevel();
+    job.result.ticks = replay.getTickCount();
+    
+    if (!job.claimed) {
+        job.verdict = Verdict::UNCLAIMED;
+        job.detail = "no claim to check (no checkpoints and no claims entry)";
+    } else if (job.claim.score != job.result.score || job.claim.level != job.result.level ||
+               job.claim.ticks != job.result.ticks) {
+        job.verdict = Verdict::FAILED;
+        std::ostringstream detail;
+        detail << "claimed score " << job.claim.score << " level " << job.claim.level << " in "
+               << job.claim.ticks << " ticks";
+        if (!job.detail.empty()) {
+            detail << "; " << job.detail;
+        }
+        job.detail = detail.str();
+    } else {
+        job.verdict = job.divergedAt < 0 ? Verdict::PASSED : Verdict::FAILED;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> inputs;
+    std::string claimsPath;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+    
+        if (arg == "--claims" && hasValue) {
+            claimsPath = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg[0] != '-') {
+            inputs.push_back(arg);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (inputs.empty()) {
+        printUsage();
+        return 1;
+    }
+    
+    std::map<std::string, Claim> claims;
+    if (!claimsPath.empty() && !loadClaims(claimsPath, claims)) {
+        std::cerr << "Failed to read claims from " << claimsPath << std::endl;
+        return 1;
+    }
+    
+    std::vector<std::string> paths;
+    for (const std::string& input : inputs) {
+        if (!isDirectory(input)) {
+            paths.push_back(input);
+            continue;
+        }
+        std::vector<std::string> found;
+        if (!listReplays(input, found)) {
+            std::cerr << "Failed to list " << input << std::endl;
+            return 1;
+        }
+        std::sort(found.begin(), found.end());
+        paths.insert(paths.end(), found.begin(), found.end());
+    }
+    
+    std::vector<Job> jobs(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        Job& job = jobs[i];
+        job.path = paths[i];
+        job.name = getFileName(paths[i]);
+        std::map<std::string, Claim>::const_iterator claim = claims.find(job.name);
+        job.claimed = claim != claims.end();
+        job.claim = job.claimed ? claim->second : Claim();
+        job.result = Claim();
+    }
+    
+    // Sessions are independent, so each thread just takes the next file
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> nextJob(0);
+    auto worker = [&jobs, &nextJob]() {
+        for (std::size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            verify(jobs[i]);
+        }
+    };
+    
+    threads = std::min<unsigned>(threads, static_cast<unsigned>(std::max<std::size_t>(1, jobs.size())));
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    const char* const kVerdicts[] = {"PASS", "FAIL", "NO CLAIM", "UNREADABLE"};
+    std::size_t passed = 0;
+    std::uint64_t ticks = 0;
+    for (const Job& job : jobs) {
+        std::cout << kVerdicts[static_cast<int>(job.verdict)] << "  " << job.name;
+        if (job.verdict != Verdict::UNREADABLE) {
+            std::cout << ": score " << job.result.score << " level " << job.result.level << " in "
+                      << job.result.ticks << " ticks";
+        }
+        if (!job.detail.empty()) {
+            std::cout << "; " << job.detail;
+        }
+        std::cout << "\n";
+    
+        passed += job.verdict == Verdict::PASSED ? 1 : 0;
+        ticks += job.result.ticks;
+    }
+    
+    std::cout << passed << " of " << jobs.size() << " replays verified, " << ticks << " ticks ("
+              << ticks / (tempest::Simulation::kTickRate * 60) << " minutes of play) in " << seconds
+              << " s on " << threads << " thread(s)" << std::endl;
+    return passed == jobs.size() && !jobs.empty() ? 0 : 1;
+}